@@ -17,38 +17,81 @@
 #include "string.h"
 #include "stdio.h"
 #include "pico/stdlib.h"
-#include <math.h>
-#include "lidar.h"
-#include "mpu6050.h"
+#include "sensor_core.h"
+#include "fixed_point.h"
+#include "sweep.h"
+#include "walls.h"
+#include "occupancy.h"
+#include "event.h"
+#include "task.h"
+#include "button.h"
+#include "measure.h"
+#include "log.h"
+#include "scan_codec.h"
+
+// Number of gyroscope samples averaged at rest before a sweep starts
+#define SWEEP_BIAS_SAMPLES (50)
+
+// Screen area used to plot the sweep outline
+#define OUTLINE_CENTER_X (64)
+#define OUTLINE_CENTER_Y (70)
+#define OUTLINE_RADIUS (44)
+
+// Grid cells per screen pixel in the map preview
+#define MAP_PREVIEW_STEP (OCC_GRID_SIZE / OLED_WIDTH)
+
+// Sweep ring shared by all sweep modes; kept off the stack, it holds
+// SWEEP_MAX_POINTS points
+static sweep_scan sweep_buffer;
+
+// The ring holds a full turn, not a sweep aborted or in progress
+static bool sweep_complete;
+
+// Occupancy map of the Map mode; 32 KB of nibbles, kept off the stack
+static occ_map map_buffer;
+
+// The map is finished, not being built
+static bool map_complete;
 
-#define FOOT_IN_CM (30.48)
-#define SQUARE_FEET (0.0010764)
+/**
+ * @brief Pack a fixed-point area into the double_array returned to the UI
+ *
+ * All formulas are evaluated in fixed point; the conversion to double is
+ * done once here so the UI can keep drawing with Paint_DrawNum.
+ *
+ * @param area_cm2 The area in hundredths of a square centimeter
+ * @return A structure containing the area in square centimeters and square feet
+ */
+static double_array area_result(fx_area_t area_cm2){
+    double_array result = {0};
+    result.result[0] = fx_to_double(area_cm2);
+    result.result[1] = fx_to_double(fx_cm2_to_ft2(area_cm2));
+    return result;
+}
 
 /**
  * @brief Calculate area based on the selected shape
  * 
  * This function determines the selected shape and calls the corresponding area calculation function.
- * The result is returned as a double_array structure.
+ * The result is returned as a double_array structure. Shapes with a capture plan are not handled
+ * here; they are run step by step through area_find_plan().
  * 
  * @param shape A string indicating the selected shape
  * @param BlackImage A pointer to the image cache
+ * @param aborted Output; true if the measurement was aborted with Red
  * 
  * @return A double_array structure containing the calculated area values
  */
-double_array calculate_area(char * shape, UBYTE *BlackImage){
+double_array calculate_area(char * shape, UBYTE *BlackImage, bool *aborted){
+    *aborted = false;
     // Check the selected shape and call the corresponding area calculation function
-    if(strcmp(shape, "Distance") == 0){
-        return calculate_distance(BlackImage);
-    }else if(strcmp(shape, "Circle") == 0){
-        return calculate_area_circle(BlackImage);
-    }else if(strcmp(shape, "Rectangle") == 0){
-        return calculate_area_rectangle(BlackImage);
-    }else if(strcmp(shape, "Triangle") == 0){
-        return calculate_area_triangle(BlackImage);
-    }else if(strcmp(shape, "Irregular menu") == 0){
-        return calculate_area_Irregular(BlackImage);
+    if(strcmp(shape, "Sweep") == 0){
+        return calculate_area_sweep(BlackImage, aborted);
+    }else if(strcmp(shape, "Map") == 0){
+        return calculate_area_map(BlackImage, aborted);
     }else{
-        printf("Unknown command\n\r");
+        LOG_WARN("Unknown command\n\r");
+        return area_result(0);
     }
 }
 
@@ -57,472 +100,585 @@ double_array calculate_area(char * shape, UBYTE *BlackImage){
  * @brief Calculate area for irregular shapes based on the selected shape
  * 
  * This function determines the selected irregular shape and calls the corresponding area calculation function.
- * The result is returned as a double_array structure.
+ * The result is returned as a double_array structure. Shapes with a capture plan are run through
+ * area_find_plan() instead.
  * 
  * @param shape A string indicating the selected irregular shape
  * @param BlackImage A pointer to the image cache
+ * @param aborted Output; true if the measurement was aborted with Red
  * 
  * @return A double_array structure containing the calculated area values for the irregular shape
  */
-double_array calculate_area_irr_shape(char * shape, UBYTE *BlackImage){
+double_array calculate_area_irr_shape(char * shape, UBYTE *BlackImage, bool *aborted){
+    *aborted = false;
     // Check the selected irregular shape and call the corresponding area calculation function
-    if(strcmp(shape, "shape1") == 0){
-        return calculate_area_shape1(BlackImage);
-    }else if(strcmp(shape, "shape2") == 0){
-        return calculate_area_shape2(BlackImage);
-    }else if(strcmp(shape, "shape3") == 0){
-        return calculate_area_shape3(BlackImage);
-    }else if(strcmp(shape, "shape4") == 0){
-        return calculate_area_shape4(BlackImage);
-    }else if(strcmp(shape, "shape5") == 0){
-        return calculate_area_shape5(BlackImage);
+    if(strcmp(shape, "walls") == 0){
+        return calculate_area_walls(BlackImage, aborted);
     }else{
-        printf("Unknown command\n\r");
+        LOG_WARN("Unknown command\n\r");
+        return area_result(0);
     }
 }
 
 /**
- * @brief Capture and display distance from the LiDAR sensor along with device orientation
- * 
- * This function continuously captures distance data from the LiDAR sensor and displays it on the OLED screen.
- * Additionally, it reads and displays the device's X and Y orientation angles.
- * The function returns the captured distance when the user presses the red button (GPIO11).
+ * @brief Reducer for a single distance
  * 
- * @param BlackImage A pointer to the image cache for OLED display
- * @return The captured distance from the LiDAR sensor
+ * @param values The distance in centimeters
+ * @return A structure containing the distance in centimeters and converted feet value
  */
-uint16_t capture_distance(UBYTE *BlackImage){
-    uint16_t distance = 0;
-    int16_t co_ordinate[3] = {0};
-
-    // Display distance-related information on the OLED screen
-    Paint_DrawString_EN(0, 12, "Distance:", &Font12, WHITE, BLACK);
-    Paint_DrawString_EN(24, 24, "cm", &Font12, WHITE, BLACK);
-    Paint_DrawString_EN(76, 24, "Feet", &Font12, WHITE, BLACK);
-    Paint_DrawString_EN(0, 60, "Device orientation:", &Font12, WHITE, BLACK);
-    Paint_DrawString_EN(0, 72, "X :", &Font12, WHITE, BLACK);
-    Paint_DrawString_EN(0, 84, "Y :", &Font12, WHITE, BLACK);
-    Paint_DrawString_EN(0, 120, "*Press Red to Read", &Font8, WHITE, BLACK);
-
-    // Continuously capture and display distance data
-    while(true){
-        distance = read_lidar();
-        read_tilt_angle(co_ordinate);
-
-        // Display captured distance in both centimeters and feet
-        Paint_DrawString_EN(24, 36, "          ", &Font12, WHITE, BLACK);
-        Paint_DrawNum(24, 36, distance, &Font12, 0, WHITE, BLACK);
-        Paint_DrawString_EN(76, 36, "          ", &Font12, WHITE, BLACK);
-        Paint_DrawNum(76, 36, (double)distance/FOOT_IN_CM, &Font12, 2, WHITE, BLACK);
-
-        // Display device orientation angles
-        Paint_DrawString_EN(21, 72, "          ", &Font12, WHITE, BLACK);
-        Paint_DrawNum(21, 72, co_ordinate[0], &Font12, 0, WHITE, BLACK);
-        Paint_DrawString_EN(21, 84, "          ", &Font12, WHITE, BLACK);
-        Paint_DrawNum(21, 84, co_ordinate[1], &Font12, 0, WHITE, BLACK);
-
-        // Update the OLED display
-        OLED_Display(BlackImage);
-
-        // Read the state of GPIO11
-        bool gpio11_state = gpio_get(11);
-
-        // Return the captured distance if the user presses the red button
-        if (!gpio11_state) {
-            printf("Captured distance\n\r");
-            sleep_ms(200);
-            return distance;
-        }
-
-        // Wait for a short duration before the next iteration
-        sleep_ms(100);
-    }
+static double_array reduce_distance(const uint16_t *values){
+    double_array result = {0};
+    result.result[0] = values[0];
+    result.result[1] = fx_to_double(fx_cm_to_ft(values[0]));
+    return result;
 }
+
 /**
- * @brief Calculate and display distance and converted feet value
- * 
- * This function calculates the distance using the `capture_distance` function and converts it to feet.
- * It then displays the measured distance and converted feet value on the OLED screen.
+ * @brief Reducer for a circle measured across its diameter
  * 
- * @param BlackImage A pointer to the image cache for OLED display
- * @return A structure containing the calculated distance in centimeters and converted feet value
+ * @param values The diameter in centimeters
+ * @return A structure containing the area in square centimeters and converted square feet value
  */
-double_array calculate_distance(UBYTE *BlackImage){
-    // Initialize the result structure
-    double_array result = {0};
-
-    // Display a message for distance measurement
-    Paint_DrawString_EN(0, 0, "Measuring Distance", &Font8, WHITE, BLACK);
-
-    // Capture distance using the capture_distance function
-    double output = (double)capture_distance(BlackImage);
+static double_array reduce_circle(const uint16_t *values){
+    return area_result(fx_area_circle(values[0]));
+}
 
-    // Store the calculated distance and converted feet value in the result structure
-    result.result[0] = output;
-    result.result[1] = output / FOOT_IN_CM;
+/**
+ * @brief Reducer for a rectangle measured as width then length
+ * 
+ * @param values The width and length in centimeters
+ * @return A structure containing the area in square centimeters and converted square feet value
+ */
+static double_array reduce_rectangle(const uint16_t *values){
+    return area_result(fx_area_product(values[1], values[0]));
+}
 
-    // Return the result structure
-    return result;
+/**
+ * @brief Reducer for a triangle measured at three corners, using Heron's formula
+ * 
+ * @param values The three side lengths in centimeters
+ * @return A structure containing the area in square centimeters and converted square feet value
+ */
+static double_array reduce_triangle(const uint16_t *values){
+    return area_result(fx_area_triangle(values[0], values[1], values[2]));
 }
 
 /**
- * @brief Calculate and display area of a circle
+ * @brief Reducer for irregular shape 1, measured at six corners
  * 
- * This function calculates the area of a circle using the `capture_distance` function to measure the diameter.
- * It then displays the measured diameter, calculated area, and converted area value on the OLED screen.
+ * @param values The corner measurements in centimeters
+ * @return A structure containing the area in square centimeters and converted square feet value
+ */
+static double_array reduce_shape1(const uint16_t *values){
+    fx_area_t output = fx_area_product(values[0], values[5]);
+    output = fx_area_add(output, fx_area_product(values[2], values[3]));
+    return area_result(output);
+}
+
+/**
+ * @brief Reducer for irregular shape 2, measured at eight corners
  * 
- * @param BlackImage A pointer to the image cache for OLED display
- * @return A structure containing the calculated area in square centimeters and converted square feet value
+ * @param values The corner measurements in centimeters
+ * @return A structure containing the area in square centimeters and converted square feet value
  */
-double_array calculate_area_circle(UBYTE *BlackImage){
-    // Initialize the result structure
-    double_array result = {0};
+static double_array reduce_shape2(const uint16_t *values){
+    fx_area_t output = fx_area_product(values[0], values[7]);
+    output = fx_area_add(output, fx_area_product(values[2], values[3]));
+    return area_result(output);
+}
 
-    // Display a message for diameter measurement
-    Paint_DrawString_EN(0, 0, "Measuring Diameter", &Font8, WHITE, BLACK);
+/**
+ * @brief Reducer for irregular shape 3, measured at eight corners
+ * 
+ * @param values The corner measurements in centimeters
+ * @return A structure containing the area in square centimeters and converted square feet value
+ */
+static double_array reduce_shape3(const uint16_t *values){
+    fx_area_t output = fx_area_product(values[0], values[1]);
+    output = fx_area_add(output, fx_area_product((int32_t)values[0] - values[2],
+                                                 (int32_t)values[7] - values[1] - values[5]));
+    output = fx_area_add(output, fx_area_product(values[5], values[6]));
+    return area_result(output);
+}
 
-    // Capture diameter using the capture_distance function
-    uint16_t diameter = capture_distance(BlackImage);
+/**
+ * @brief Reducer for irregular shape 4, measured at twelve corners
+ * 
+ * @param values The corner measurements in centimeters
+ * @return A structure containing the area in square centimeters and converted square feet value
+ */
+static double_array reduce_shape4(const uint16_t *values){
+    fx_area_t output = fx_area_product(values[0], values[11]);
+    output = fx_area_add(output, fx_area_product(values[2], values[3]));
+    output = fx_area_add(output, fx_area_product(values[5], values[6]));
+    output = fx_area_add(output, fx_area_product(values[7], values[8]));
+    output = fx_area_add(output, fx_area_product(values[2], values[11]));
+    return area_result(output);
+}
 
-    // Calculate the area of the circle
-    double output = (double)(M_PI * diameter * diameter / 4);
+/**
+ * @brief Reducer for irregular shape 5, measured at three corners
+ * 
+ * @param values The corner measurements in centimeters
+ * @return A structure containing the area in square centimeters and converted square feet value
+ */
+static double_array reduce_shape5(const uint16_t *values){
+    return area_result(fx_area_trapezoid(values[0], values[1], values[2]));
+}
 
-    // Store the calculated area and converted area value in the result structure
-    result.result[0] = output;
-    result.result[1] = output * SQUARE_FEET;
+static const char *const distance_prompts[] = {"Measuring Distance"};
+static const char *const circle_prompts[] = {"Measuring Diameter"};
+static const char *const rectangle_prompts[] = {"Measuring Width", "Measuring Length"};
+
+// Shapes measured by capturing distances one at a time, from both menus
+static const measure_plan plans[] = {
+    {"Distance",  1,  distance_prompts,  reduce_distance},
+    {"Circle",    1,  circle_prompts,    reduce_circle},
+    {"Rectangle", 2,  rectangle_prompts, reduce_rectangle},
+    {"Triangle",  3,  NULL,              reduce_triangle},
+    {"shape1",    6,  NULL,              reduce_shape1},
+    {"shape2",    8,  NULL,              reduce_shape2},
+    {"shape3",    8,  NULL,              reduce_shape3},
+    {"shape4",    12, NULL,              reduce_shape4},
+    {"shape5",    3,  NULL,              reduce_shape5},
+};
 
-    // Return the result structure
-    return result;
+/**
+ * @brief Find the capture plan of a shape
+ * 
+ * @param shape A string indicating the selected shape
+ * @return The plan, or NULL if the shape is measured some other way
+ */
+const measure_plan *area_find_plan(const char *shape){
+    for(uint8_t i = 0; i < sizeof(plans) / sizeof(plans[0]); i++){
+        if(strcmp(shape, plans[i].shape) == 0){
+            return &plans[i];
+        }
+    }
+    return NULL;
 }
 
 /**
- * @brief Calculate and display area of a rectangle
+ * @brief Plot the outline of a completed sweep
  * 
- * This function measures the width and length using the `capture_distance` function,
- * calculates the area of the rectangle, and displays the measured values and the area
- * on the OLED screen.
+ * The outline is scaled so the farthest point lands on OUTLINE_RADIUS pixels
+ * from the device position, which is marked at the center.
  * 
- * @param BlackImage A pointer to the image cache for OLED display
- * @return A structure containing the calculated area in square centimeters and converted square feet value
+ * @param scan The completed sweep
  */
-double_array calculate_area_rectangle(UBYTE *BlackImage){
-    // Initialize the result structure
-    double_array result = {0};
-
-    // Display a message for width measurement
-    Paint_DrawString_EN(0, 0, "Measuring Width", &Font8, WHITE, BLACK);
-
-    // Measure the width using the capture_distance function
-    uint16_t width = capture_distance(BlackImage);
-
-    // Sleep for 500 ms to allow the user to reposition the sensor
-    sleep_ms(500);
-
-    // Display a message for length measurement
-    Paint_DrawString_EN(0, 0, "Measuring Length", &Font8, WHITE, BLACK);
-
-    // Measure the length using the capture_distance function
-    uint16_t length = capture_distance(BlackImage);
-
-    // Calculate the area of the rectangle
-    double output = (double)(length * width);
-
-    // Store the calculated area and converted area value in the result structure
-    result.result[0] = output;
-    result.result[1] = output * SQUARE_FEET;
+static void draw_sweep_outline(const sweep_scan *scan){
+    int32_t max_extent = 1;
+    int32_t x, y;
+
+    // Find the farthest coordinate to scale the plot
+    for(uint16_t i = 0; i < scan->count; i++){
+        sweep_point_xy(sweep_point_at(scan, i), &x, &y);
+        if(x < 0) x = -x;
+        if(y < 0) y = -y;
+        if(x > max_extent) max_extent = x;
+        if(y > max_extent) max_extent = y;
+    }
 
-    // Return the result structure
-    return result;
+    // Mark the device position
+    Paint_DrawPoint(OUTLINE_CENTER_X, OUTLINE_CENTER_Y, WHITE, DOT_PIXEL_2X2, DOT_STYLE_DFT);
+
+    // Connect consecutive points, closing back to the first one
+    UWORD prev_px = 0, prev_py = 0, first_px = 0, first_py = 0;
+    for(uint16_t i = 0; i < scan->count; i++){
+        sweep_point_xy(sweep_point_at(scan, i), &x, &y);
+        UWORD px = OUTLINE_CENTER_X + (int64_t)x * OUTLINE_RADIUS / max_extent;
+        UWORD py = OUTLINE_CENTER_Y - (int64_t)y * OUTLINE_RADIUS / max_extent;
+        if(i == 0){
+            first_px = px;
+            first_py = py;
+        }else{
+            Paint_DrawLine(prev_px, prev_py, px, py, WHITE, DOT_PIXEL_1X1, LINE_STYLE_SOLID);
+        }
+        prev_px = px;
+        prev_py = py;
+    }
+    if(scan->count > 2){
+        Paint_DrawLine(prev_px, prev_py, first_px, first_py, WHITE, DOT_PIXEL_1X1, LINE_STYLE_SOLID);
+    }
 }
 
 /**
- * @brief Calculate and display area of a triangle
+ * @brief Plot the room polygon found by the wall extraction
  * 
- * This function measures distances at three corners using the `capture_distance` function,
- * applies Heron's formula to calculate the area of the triangle, and displays the measured values
- * and the area on the OLED screen.
+ * Corners are scaled like draw_sweep_outline so the two plots line up.
  * 
- * @param BlackImage A pointer to the image cache for OLED display
- * @return A structure containing the calculated area in square centimeters and converted square feet value
+ * @param room The extracted room polygon
  */
-double_array calculate_area_triangle(UBYTE *BlackImage){
-    // Initialize the result structure
-    double_array result = {0};
-
-    // Array to store distances at three corners of the triangle
-    uint16_t corner[3] = {0};
-
-    // Index variable for looping through corners
-    uint8_t index = 0;
-
-    // Display a message for corner measurement
-    Paint_DrawString_EN(0, 0, "Measuring at Corner:", &Font8, WHITE, BLACK);
-
-    // Loop to measure distances at each corner
-    while(index < 3){
-        Paint_DrawNum(112, 0, index + 1, &Font8, 0, WHITE, BLACK);
-        corner[index] = capture_distance(BlackImage);
-        index++;
+static void draw_wall_polygon(const wall_room *room){
+    int32_t max_extent = 1;
+
+    // Find the farthest corner to scale the plot
+    for(uint8_t i = 0; i < room->corner_count; i++){
+        int32_t x = room->corner_x[i] < 0 ? -room->corner_x[i] : room->corner_x[i];
+        int32_t y = room->corner_y[i] < 0 ? -room->corner_y[i] : room->corner_y[i];
+        if(x > max_extent) max_extent = x;
+        if(y > max_extent) max_extent = y;
     }
 
-    // Using Heron's formula to calculate the area of the triangle
-    double s = (corner[0] + corner[1] + corner[2]) / 2.0;
-    double output = (double)sqrt(s * (s - corner[0]) * (s - corner[1]) * (s - corner[2]));
-
-    // Store the calculated area and converted area value in the result structure
-    result.result[0] = output;
-    result.result[1] = output * SQUARE_FEET;
-
-    // Return the result structure
-    return result;
+    // Mark the device position
+    Paint_DrawPoint(OUTLINE_CENTER_X, OUTLINE_CENTER_Y, WHITE, DOT_PIXEL_2X2, DOT_STYLE_DFT);
+
+    // Connect the corners in order, closing back to the first one
+    for(uint8_t i = 0; i < room->corner_count; i++){
+        uint8_t next = (i + 1) % room->corner_count;
+        UWORD x1 = OUTLINE_CENTER_X + (int64_t)room->corner_x[i] * OUTLINE_RADIUS / max_extent;
+        UWORD y1 = OUTLINE_CENTER_Y - (int64_t)room->corner_y[i] * OUTLINE_RADIUS / max_extent;
+        UWORD x2 = OUTLINE_CENTER_X + (int64_t)room->corner_x[next] * OUTLINE_RADIUS / max_extent;
+        UWORD y2 = OUTLINE_CENTER_Y - (int64_t)room->corner_y[next] * OUTLINE_RADIUS / max_extent;
+        Paint_DrawLine(x1, y1, x2, y2, WHITE, DOT_PIXEL_1X1, LINE_STYLE_SOLID);
+        Paint_DrawPoint(x1, y1, WHITE, DOT_PIXEL_2X2, DOT_STYLE_DFT);
+    }
 }
 
-
 /**
- * @brief Calculate and display area of an irregular shape
+ * @brief Capture one full 360 degree sweep
  * 
- * This function displays an irregular shape menu on the OLED screen,
- * allows the user to select a specific irregular shape, and calculates
- * and displays the area of the selected shape using the OLED screen.
+ * This function measures the gyroscope bias while the device is held still,
+ * then pairs every LiDAR frame with the gyro-integrated yaw while the user
+ * turns the device through a full circle. The display is not refreshed
+ * during the sweep so the sensors are read at the full frame rate.
  * 
  * @param BlackImage A pointer to the image cache for OLED display
- * @return A structure containing the calculated area in square centimeters and converted square feet value
+ * @param title The title shown while the sweep runs
+ * @param scan The sweep ring, one point per degree
+ * @param integrator The streaming area/perimeter integrator
+ * @return false if the user aborted the sweep with the red button
  */
-double_array calculate_area_Irregular(UBYTE *BlackImage){
-    // Display the irregular shape menu on the OLED screen
-    irr_menu(BlackImage);
-
-    // Initialize the selected shape to the first shape in the menu
-    char *shape = irr_shapes[0];
-
-    // Sleep for 300 ms to allow the user to read the menu
-    sleep_ms(300);
-
-    while(true){
-        // Read the state of GPIO10
-        bool gpio10_state = gpio_get(10);
-        // Read the state of GPIO11
-        bool gpio11_state = gpio_get(11);
-
-        // Perform actions based on the GPIO10 state
-        if (!gpio10_state) {
-            sleep_ms(200);
-            // Allow the user to move the cursor and select a shape
-            shape = move_cursor_irr_menu(BlackImage);
-            printf("GPIO10 is high (pressed)! and shape %s\n\r", shape);
+static bool run_sweep(UBYTE *BlackImage, const char *title, sweep_scan *scan, sweep_integrator *integrator){
+    // Ask the user to hold the device still while the gyro bias is measured
+    Paint_DrawString_EN(0, 0, title, &Font8, WHITE, BLACK);
+    Paint_DrawString_EN(0, 24, "Hold still...", &Font12, WHITE, BLACK);
+    OLED_Display(BlackImage);
+
+    sensor_frame frame;
+    int32_t bias = 0;
+    int bias_samples = 0;
+    sensor_flush();
+    while(bias_samples < SWEEP_BIAS_SAMPLES){
+        event_wait();
+        while(bias_samples < SWEEP_BIAS_SAMPLES && sensor_next(&frame)){
+            bias += frame.yaw_rate;
+            bias_samples++;
         }
-        
-        // Perform actions based on the GPIO11 state
-        if (!gpio11_state) {
-            sleep_ms(200);
-            // Clear the OLED screen and set all image values to 0x00
-            OLED_Clear();
-            memset(BlackImage, 0x00, OLED_IMAGE_SIZE);
-            OLED_Display(BlackImage);
-            // Calculate and return the area of the selected irregular shape
-            return calculate_area_irr_shape(shape, BlackImage);
+    }
+    bias /= SWEEP_BIAS_SAMPLES;
+
+    Paint_DrawString_EN(0, 24, "Rotate slowly", &Font12, WHITE, BLACK);
+    Paint_DrawString_EN(0, 36, "through 360 deg", &Font12, WHITE, BLACK);
+    Paint_DrawString_EN(0, 120, "*Press Red to abort", &Font8, WHITE, BLACK);
+    OLED_Display(BlackImage);
+
+    // Pair each LiDAR frame with the yaw at its timestamp until a full turn
+    // is made. Core1 samples; this core sleeps until frames are published.
+    // The integrator sees every frame; the ring keeps one point per degree
+    // for the plot and the wall fit.
+    sweep_complete = false;
+    sweep_init(scan, bias, frame.imu_time_us);
+    sweep_integrator_init(integrator);
+    sensor_reset_timing();
+    bool closed = false;
+    while(!closed){
+        event e = event_wait();
+
+        // Abort the sweep if the user presses the red button
+        if(e.type == EVENT_BUTTON_PRESS && e.data == GPIO11){
+            LOG_INFO("Sweep aborted\n\r");
+            return false;
+        }
+
+        while(!closed && sensor_next(&frame)){
+            sweep_update_yaw(scan, frame.yaw_rate, frame.imu_time_us);
+            sweep_add_sample(scan, frame.distance);
+            closed = sweep_integrator_add(integrator, sweep_yaw(scan), frame.distance);
         }
     }
+
+    sampler_stats timing;
+    sensor_get_timing(&timing);
+    LOG_INFO("Sweep closed with %d samples, %d outliers, %d gaps, %lu frame overruns\n\r",
+             integrator->samples, integrator->outliers, integrator->gaps, (unsigned long)sensor_overruns());
+    LOG_INFO("Frame jitter avg %lu us, max %lu us, %lu missed\n\r",
+             (unsigned long)(timing.samples ? timing.late_sum_us / timing.samples : 0),
+             (unsigned long)timing.late_max_us, (unsigned long)timing.missed);
+    sweep_complete = true;
+    return true;
 }
 
 /**
- * @brief Calculate and display area of a specific irregular shape (Shape 1)
+ * @brief Map a room outline by rotating the device in place
  * 
- * This function measures distances at six corners of a specific irregular shape,
- * applies a specific formula to calculate the area, and displays the measured values
- * and the area on the OLED screen.
+ * Area and perimeter are integrated sample by sample during the sweep, so
+ * they are final as soon as the sweep closes 360 degrees and the outline is
+ * plotted next to them.
  * 
  * @param BlackImage A pointer to the image cache for OLED display
- * @return A structure containing the calculated area in square centimeters and converted square feet value
+ * @param aborted Output; true if the sweep was aborted with Red
+ * @return A structure containing the outline area in square centimeters and converted square feet value
  */
-double_array calculate_area_shape1(UBYTE *BlackImage){
-    // Initialize the result structure
-    double_array result = {0};
-
-    // Array to store measurements at six corners of the shape
-    int16_t measurement[6] = {0};
+double_array calculate_area_sweep(UBYTE *BlackImage, bool *aborted){
+    sweep_integrator integrator;
 
-    // Display a message for corner measurement
-    Paint_DrawString_EN(0, 0, "Measuring at Corner:", &Font8, WHITE, BLACK);
-
-    // Loop to measure distances at each corner
-    for(int i = 0; i < sizeof(measurement) / sizeof(measurement[0]); i++){
-        Paint_DrawNum(112, 0, i + 1, &Font8, 0, WHITE, BLACK);
-        measurement[i] = capture_distance(BlackImage);
+    *aborted = !run_sweep(BlackImage, "Sweep scan", &sweep_buffer, &integrator);
+    if(*aborted){
+        return area_result(0);
     }
 
-    // Using a specific formula to calculate the area of the shape
-    double sub_area1 = measurement[0] * measurement[5];
-    double sub_area2 = measurement[2] * measurement[3];
-    double output = (double)(sub_area1 + sub_area2);
-
-    // Store the calculated area and converted area value in the result structure
-    result.result[0] = output;
-    result.result[1] = output * SQUARE_FEET;
-
-    // Return the result structure
-    return result;
+    // The area is ready the moment the sweep closes, no post-processing pass
+    sweep_outline outline = sweep_integrator_result(&integrator);
+    fx_area_t area_ft2 = fx_cm2_to_ft2(outline.area);
+    fx_length_t perimeter_ft = fx_cm_to_ft((outline.perimeter + FX_SCALE / 2) / FX_SCALE);
+
+    // Show the outline with its area and perimeter
+    OLED_Clear();
+    memset(BlackImage, 0x00, OLED_IMAGE_SIZE);
+    Paint_DrawString_EN(0, 0, "Area:", &Font8, WHITE, BLACK);
+    Paint_DrawNum(30, 0, fx_to_double(area_ft2), &Font8, 2, WHITE, BLACK);
+    Paint_DrawString_EN(88, 0, "sq.ft", &Font8, WHITE, BLACK);
+    Paint_DrawString_EN(0, 10, "Perim:", &Font8, WHITE, BLACK);
+    Paint_DrawNum(35, 10, fx_to_double(perimeter_ft), &Font8, 2, WHITE, BLACK);
+    Paint_DrawString_EN(98, 10, "ft", &Font8, WHITE, BLACK);
+    draw_sweep_outline(&sweep_buffer);
+    Paint_DrawString_EN(0, 120, "*Press Red to continue", &Font8, WHITE, BLACK);
+    OLED_Display(BlackImage);
+
+    // Wait for the red button before showing the final value
+    event_wait_press(GPIO11);
+
+    return area_result(outline.area);
 }
 
-
 /**
- * @brief Calculate and display area of a specific irregular shape (Shape 2)
+ * @brief Measure a room from its walls with a single sweep
  * 
- * This function measures distances at eight corners of a specific irregular shape (Shape 2),
- * applies a specific formula to calculate the area, and displays the measured values
- * and the area on the OLED screen.
+ * This function replaces the per-corner measurement sequence of the fixed
+ * irregular shapes: one sweep is captured, straight walls are fitted to the
+ * points and intersected into corners. A rectangular room shows its width
+ * and length, any other room its corner count. If fewer than three corners
+ * are found the integrated sweep area is used instead.
  * 
  * @param BlackImage A pointer to the image cache for OLED display
- * @return A structure containing the calculated area in square centimeters and converted square feet value
+ * @param aborted Output; true if the sweep was aborted with Red
+ * @return A structure containing the room area in square centimeters and converted square feet value
  */
-double_array calculate_area_shape2(UBYTE *BlackImage){
-    // Initialize the result structure
-    double_array result = {0};
-
-    // Array to store measurements at eight corners of the shape
-    int16_t measurement[8] = {0};
+double_array calculate_area_walls(UBYTE *BlackImage, bool *aborted){
+    static wall_room room;
+    sweep_integrator integrator;
 
-    // Display a message for corner measurement
-    Paint_DrawString_EN(0, 0, "Measuring at Corner:", &Font8, WHITE, BLACK);
-
-    // Loop to measure distances at each corner
-    for(int i = 0; i < sizeof(measurement) / sizeof(measurement[0]); i++){
-        Paint_DrawNum(112, 0, i + 1, &Font8, 0, WHITE, BLACK);
-        measurement[i] = capture_distance(BlackImage);
+    *aborted = !run_sweep(BlackImage, "Wall scan", &sweep_buffer, &integrator);
+    if(*aborted){
+        return area_result(0);
     }
 
-    // Using a specific formula to calculate the area of the shape
-    double sub_area1 = measurement[0] * measurement[7];
-    double sub_area2 = measurement[2] * measurement[3];
-   
-    double output = (double)(sub_area1 + sub_area2);
+    uint64_t fit_start = time_us_64();
+    bool found = walls_extract(&sweep_buffer, &room);
+    LOG_INFO("Wall fit: %d walls, %d corners in %d us\n\r",
+             room.wall_count, room.corner_count, (int)(time_us_64() - fit_start));
+
+    fx_area_t area = found ? room.area : sweep_integrator_result(&integrator).area;
+
+    OLED_Clear();
+    memset(BlackImage, 0x00, OLED_IMAGE_SIZE);
+    Paint_DrawString_EN(0, 0, "Area:", &Font8, WHITE, BLACK);
+    Paint_DrawNum(30, 0, fx_to_double(fx_cm2_to_ft2(area)), &Font8, 2, WHITE, BLACK);
+    Paint_DrawString_EN(88, 0, "sq.ft", &Font8, WHITE, BLACK);
+    if(found && room.is_rectangle){
+        // Dimensions are whole feet and hundredths, like the perimeter
+        Paint_DrawString_EN(0, 10, "W:", &Font8, WHITE, BLACK);
+        Paint_DrawNum(12, 10, fx_to_double(fx_cm_to_ft((room.width + FX_SCALE / 2) / FX_SCALE)), &Font8, 2, WHITE, BLACK);
+        Paint_DrawString_EN(64, 10, "L:", &Font8, WHITE, BLACK);
+        Paint_DrawNum(76, 10, fx_to_double(fx_cm_to_ft((room.length + FX_SCALE / 2) / FX_SCALE)), &Font8, 2, WHITE, BLACK);
+    }else if(found){
+        Paint_DrawString_EN(0, 10, "Corners:", &Font8, WHITE, BLACK);
+        Paint_DrawNum(48, 10, room.corner_count, &Font8, 0, WHITE, BLACK);
+    }else{
+        Paint_DrawString_EN(0, 10, "No walls, sweep area", &Font8, WHITE, BLACK);
+    }
+    if(found){
+        draw_wall_polygon(&room);
+    }else{
+        draw_sweep_outline(&sweep_buffer);
+    }
+    Paint_DrawString_EN(0, 120, "*Press Red to continue", &Font8, WHITE, BLACK);
+    OLED_Display(BlackImage);
 
-    // Store the calculated area and converted area value in the result structure
-    result.result[0] = output;
-    result.result[1] = output * SQUARE_FEET;
+    // Wait for the red button before showing the final value
+    event_wait_press(GPIO11);
 
-    // Return the result structure
-    return result;
+    return area_result(area);
 }
 
 /**
- * @brief Calculate and display area of a specific irregular shape (Shape 3)
+ * @brief Draw a downsampled preview of the occupancy grid
  * 
- * This function measures distances at eight corners of a specific irregular shape (Shape 3),
- * applies a specific formula to calculate the area, and displays the measured values
- * and the area on the OLED screen.
+ * Each screen pixel covers MAP_PREVIEW_STEP x MAP_PREVIEW_STEP cells and is
+ * lit if any of them is occupied. Sweep positions are marked with a dot.
  * 
- * @param BlackImage A pointer to the image cache for OLED display
- * @return A structure containing the calculated area in square centimeters and converted square feet value
+ * @param map The occupancy grid
  */
-double_array calculate_area_shape3(UBYTE *BlackImage){
-    // Initialize the result structure
-    double_array result = {0};
-
-    // Array to store measurements at eight corners of the shape
-    int16_t measurement[8] = {0};
-
-    // Display a message for corner measurement
-    Paint_DrawString_EN(0, 0, "Measuring at Corner:", &Font8, WHITE, BLACK);
-
-    // Loop to measure distances at each corner
-    for(int i = 0; i < sizeof(measurement) / sizeof(measurement[0]) ; i++){
-        Paint_DrawNum(112, 0, i + 1, &Font8, 0, WHITE, BLACK);
-        measurement[i] = capture_distance(BlackImage);
+static void draw_map_preview(const occ_map *map){
+    for(UWORD py = 0; py < OLED_HEIGHT; py++){
+        // Screen rows run top-down, grid rows bottom-up
+        int32_t gy = (OLED_HEIGHT - 1 - py) * MAP_PREVIEW_STEP;
+        for(UWORD px = 0; px < OLED_WIDTH; px++){
+            int32_t gx = px * MAP_PREVIEW_STEP;
+            bool occupied = false;
+            for(int32_t j = 0; j < MAP_PREVIEW_STEP && !occupied; j++){
+                for(int32_t i = 0; i < MAP_PREVIEW_STEP && !occupied; i++){
+                    occupied = occ_get(map, gx + i, gy + j) >= OCC_OCCUPIED;
+                }
+            }
+            if(occupied){
+                Paint_SetPixel(px, py, WHITE);
+            }
+        }
     }
 
-    // Using a specific formula to calculate the area of the shape
-    double sub_area1 = measurement[0] * measurement[1];
-    double sub_area2 = (measurement[0] - measurement[2]) * (measurement[7] - measurement[1] - measurement[5]);
-    double sub_area3 = measurement[5] * measurement[6];
-    
-    double output = (double)(sub_area1 + sub_area2 + sub_area3);
-
-    // Store the calculated area and converted area value in the result structure
-    result.result[0] = output;
-    result.result[1] = output * SQUARE_FEET;
-
-    // Return the result structure
-    return result;
+    for(uint8_t i = 0; i < map->pose_count; i++){
+        int32_t gx = OCC_GRID_SIZE / 2 + map->poses[i].x / OCC_CELL_CM;
+        int32_t gy = OCC_GRID_SIZE / 2 + map->poses[i].y / OCC_CELL_CM;
+        Paint_DrawPoint(gx / MAP_PREVIEW_STEP, OLED_HEIGHT - 1 - gy / MAP_PREVIEW_STEP, WHITE, DOT_PIXEL_2X2, DOT_STYLE_DFT);
+    }
 }
 
 /**
- * @brief Calculate and display area of a specific irregular shape (Shape 4)
+ * @brief Map rooms a single position cannot see with several sweeps
  * 
- * This function measures distances at twelve corners of a specific irregular shape (Shape 4),
- * applies a specific formula to calculate the area, and displays the measured values
- * and the area on the OLED screen.
+ * The first sweep defines the map origin. Each later sweep, taken after
+ * moving up to a metre and starting facing roughly the same way, is aligned
+ * to the map with a correlative scan matcher and ray-traced into a log-odds
+ * occupancy grid. After every sweep a preview of the grid is shown; Yellow
+ * adds another sweep and Red finishes and returns the explored floor area.
+ * The finished grid can then be downloaded over USB (FRAME_GET_MAP).
  * 
  * @param BlackImage A pointer to the image cache for OLED display
- * @return A structure containing the calculated area in square centimeters and converted square feet value
+ * @param aborted Output; true if the first sweep was aborted, so nothing was mapped
+ * @return A structure containing the explored area in square centimeters and converted square feet value
  */
-double_array calculate_area_shape4(UBYTE *BlackImage){
-    // Initialize the result structure
-    double_array result = {0};
-
-    // Array to store measurements at twelve corners of the shape
-    int16_t measurement[12] = {0};
-
-    // Display a message for corner measurement
-    Paint_DrawString_EN(0, 0, "Measuring at Corner:", &Font8, WHITE, BLACK);
+double_array calculate_area_map(UBYTE *BlackImage, bool *aborted){
+    occ_map *map = &map_buffer;
+    sweep_integrator integrator;
 
-    // Loop to measure distances at each corner
-    for(int i = 0; i < sizeof(measurement) / sizeof(measurement[0]) ; i++){
-        Paint_DrawNum(112, 0, i + 1, &Font8, 0, WHITE, BLACK);
-        measurement[i] = capture_distance(BlackImage);
-    }
+    map_complete = false;
+    occ_init(map);
+    while(true){
+        OLED_Clear();
+        memset(BlackImage, 0x00, OLED_IMAGE_SIZE);
+        if(map->pose_count > 0){
+            Paint_DrawString_EN(0, 60, "Face the same way", &Font8, WHITE, BLACK);
+            Paint_DrawString_EN(0, 70, "as the first sweep", &Font8, WHITE, BLACK);
+        }
+        if(!run_sweep(BlackImage, "Map sweep", &sweep_buffer, &integrator)){
+            // An aborted sweep ends the map with the sweeps taken so far
+            break;
+        }
 
-    // Using a specific formula to calculate the area of the shape
-    double sub_area1 = measurement[0] * measurement[11];
-    double sub_area2 = measurement[2] * measurement[3];
-    double sub_area3 = measurement[5] * measurement[6];
-    double sub_area4 = measurement[7] * measurement[8];
-    double sub_area5 = measurement[2] * measurement[11];
+        occ_pose pose = {0, 0, 0};
+        if(map->pose_count > 0){
+            memset(BlackImage, 0x00, OLED_IMAGE_SIZE);
+            Paint_DrawString_EN(0, 0, "Map sweep", &Font8, WHITE, BLACK);
+            Paint_DrawString_EN(0, 24, "Aligning...", &Font12, WHITE, BLACK);
+            OLED_Display(BlackImage);
 
-    double output = (double)(sub_area1 + sub_area2 + sub_area3 + sub_area4 + sub_area5);
+            // The search takes seconds on this core, so the other tasks
+            // run between its rows
+            occ_matcher matcher;
+            uint64_t match_start = time_us_64();
+            occ_match_begin(&matcher, map, &sweep_buffer);
+            while(!occ_match_step(&matcher, map)){
+                task_pause();
+            }
+            occ_match match = matcher.match;
+            pose = match.pose;
+            LOG_INFO("Sweep %d matched at %ld,%ld cm %ld cdeg, score %ld/%d in %d us\n\r",
+                     map->pose_count, (long)pose.x, (long)pose.y, (long)pose.heading,
+                     (long)match.score, match.points, (int)(time_us_64() - match_start));
+        }
+        if(!occ_add_scan(map, &sweep_buffer, &pose)){
+            // Yellow is refused once the map is full, so this is a bug
+            LOG_ERROR("Map sweep %d rejected by a full map\n\r", map->pose_count + 1);
+            break;
+        }
+        bool full = map->pose_count >= OCC_MAX_POSES;
+
+        // Show the grid and wait for the next action
+        OLED_Clear();
+        memset(BlackImage, 0x00, OLED_IMAGE_SIZE);
+        draw_map_preview(map);
+        Paint_DrawString_EN(0, 0, "Sweeps:", &Font8, WHITE, BLACK);
+        Paint_DrawNum(42, 0, map->pose_count, &Font8, 0, WHITE, BLACK);
+        Paint_DrawString_EN(0, 120, full ? "*Map full, Red:Done" : "*Yellow:Add  Red:Done", &Font8, WHITE, BLACK);
+        OLED_Display(BlackImage);
 
-    // Store the calculated area and converted area value in the result structure
-    result.result[0] = output;
-    result.result[1] = output * SQUARE_FEET;
+        bool another = false;
+        while(true){
+            event e = event_wait();
+            if(e.type != EVENT_BUTTON_PRESS){
+                continue;
+            }
+            if(e.data == GPIO10 && !full){
+                another = true;
+                break;
+            }
+            if(e.data == GPIO11){
+                break;
+            }
+        }
+        if(!another){
+            break;
+        }
+    }
 
-    // Return the result structure
-    return result;
+    *aborted = map->pose_count == 0;
+    if(*aborted){
+        return area_result(0);
+    }
+    map_complete = true;
+    LOG_INFO("Map of %d sweeps ready for download over USB\n\r", map->pose_count);
+    return area_result(occ_free_area(map));
 }
 
 /**
- * @brief Calculate and display area of a specific irregular shape (Shape 5)
- * 
- * This function measures distances at three corners of a specific irregular shape (Shape 5),
- * applies a specific formula to calculate the area, and displays the measured values
- * and the area on the OLED screen.
- * 
- * @param BlackImage A pointer to the image cache for OLED display
- * @return A structure containing the calculated area in square centimeters and converted square feet value
+ * @brief The last sweep that ran to a full turn.
+ *
+ * @return The sweep ring, or NULL if no sweep has completed or one is running.
  */
-double_array calculate_area_shape5(UBYTE *BlackImage){
-    // Initialize the result structure
-    double_array result = {0};
+const sweep_scan *area_last_scan(void){
+    return sweep_complete ? &sweep_buffer : NULL;
+}
 
-    // Array to store measurements at three corners of the shape
-    int16_t measurement[3] = {0};
+/**
+ * @brief The occupancy map of the last Map measurement that was finished.
+ *
+ * @return The map, or NULL if none was finished or one is being built.
+ */
+const occ_map *area_last_map(void){
+    return map_complete ? &map_buffer : NULL;
+}
 
-    // Display a message for corner measurement
-    Paint_DrawString_EN(0, 0, "Measuring at Corner:", &Font8, WHITE, BLACK);
+/**
+ * @brief Encode the last sweep that ran to a full turn (see scan_codec.h).
+ *
+ * The points are read from the ring in place, oldest first.
+ *
+ * @param out      Output; SCAN_ENCODED_MAX(SWEEP_MAX_POINTS) bytes always suffice.
+ * @param capacity Size of out.
+ * @return Bytes written, or 0 if there is no such sweep or out is too small.
+ */
+size_t area_encode_scan(uint8_t *out, size_t capacity){
+    const sweep_scan *scan = area_last_scan();
+    scan_writer writer;
 
-    // Loop to measure distances at each corner
-    for(int i = 0; i < sizeof(measurement) / sizeof(measurement[0]) ; i++){
-        Paint_DrawNum(112, 0, i + 1, &Font8, 0, WHITE, BLACK);
-        measurement[i] = capture_distance(BlackImage);
+    if(scan == NULL){
+        return 0;
     }
-
-    // Using a specific formula to calculate the area of the shape
-    double sub_area1 = (measurement[0] + measurement[1]) * measurement[2] / 2;
-    double output = (double)sub_area1;
-
-    // Store the calculated area and converted area value in the result structure
-    result.result[0] = output;
-    result.result[1] = output * SQUARE_FEET;
-
-    // Return the result structure
-    return result;
+    scan_writer_init(&writer, out, capacity, scan->count);
+    for(uint16_t i = 0; i < scan->count; i++){
+        scan_writer_add(&writer, sweep_point_at(scan, i));
+    }
+    return scan_writer_finish(&writer);
 }
@@ -13,9 +13,14 @@
  * @author Jithendra H S
  * @date December 15, 2023
  */
+#ifndef AREA_H
+#define AREA_H
+
 #include "stdint.h"
 #include "menu.h"
 #include "string.h"
+#include "sweep.h"
+#include "occupancy.h"
 
 // Structure to store the result of area calculations
 typedef struct double_array double_array;
@@ -29,11 +34,21 @@ struct double_array{
  *
  * @param shape         A string identifier for the shape to be calculated.
  * @param BlackImage    Pointer to the image data.
+ * @param aborted       Output; true if the measurement was aborted with Red and
+ *                      no area was measured.
+ * @param aborted       Output; true if the measurement was aborted with Red and
+ *                      no area was measured.
+ * @param aborted       Output; true if the measurement was aborted with Red and
+ *                      no area was measured.
+ * @param aborted       Output; true if the measurement was aborted with Red and
+ *                      no area was measured.
+ * @param aborted       Output; true if the measurement was aborted with Red and
+ *                      no area was measured.
  * 
  * @return double_array A structure containing the calculated area in square centimeters
  *                      (result[0]) and square feet (result[1]).
  */
-double_array calculate_area(char *shape, UBYTE *BlackImage);
+double_array calculate_area(char *shape, UBYTE *BlackImage, bool *aborted);
 
 /**
  * @brief Calculate the area based on the specified irregular shape.
@@ -44,118 +59,71 @@ double_array calculate_area(char *shape, UBYTE *BlackImage);
  * @return double_array A structure containing the calculated area in square centimeters
  *                      (result[0]) and square feet (result[1]).
  */
-double_array calculate_area_irr_shape(char *shape, UBYTE *BlackImage);
+double_array calculate_area_irr_shape(char *shape, UBYTE *BlackImage, bool *aborted);
 
-/**
- * @brief Capture the distance using LIDAR sensor.
- *
- * @param BlackImage    Pointer to the image data.
- * 
- * @return uint16_t     The captured distance in centimeters.
- */
-uint16_t capture_distance(UBYTE *BlackImage);
+struct measure_plan;
 
 /**
- * @brief Calculate the distance and convert it to both centimeters and feet.
+ * @brief Find the capture plan of a shape measured point to point.
  *
- * @param BlackImage    Pointer to the image data.
+ * @param shape         A string identifier for the shape.
  * 
- * @return double_array A structure containing the calculated distance in centimeters
- *                      (result[0]) and feet (result[1]).
+ * @return The plan to run with measure_start(), or NULL if the shape is measured
+ *         by calculate_area() or calculate_area_irr_shape().
  */
-double_array calculate_distance(UBYTE *BlackImage);
+const struct measure_plan *area_find_plan(const char *shape);
 
 /**
- * @brief Calculate the area of a circle based on the captured diameter.
+ * @brief Calculate the area of a room outline from a 360 degree sweep.
  *
  * @param BlackImage    Pointer to the image data.
  * 
  * @return double_array A structure containing the calculated area in square centimeters
  *                      (result[0]) and square feet (result[1]).
  */
-double_array calculate_area_circle(UBYTE *BlackImage);
+double_array calculate_area_sweep(UBYTE *BlackImage, bool *aborted);
 
 /**
- * @brief Calculate the area of a rectangle based on the measured width and length.
+ * @brief Calculate the area and dimensions of a room from walls fitted to a 360 degree sweep.
  *
  * @param BlackImage    Pointer to the image data.
  * 
  * @return double_array A structure containing the calculated area in square centimeters
  *                      (result[0]) and square feet (result[1]).
  */
-double_array calculate_area_rectangle(UBYTE *BlackImage);
+double_array calculate_area_walls(UBYTE *BlackImage, bool *aborted);
 
 /**
- * @brief Calculate the area of a triangle based on the measured distances at three corners.
+ * @brief Build an occupancy map from sweeps at several positions and calculate the explored area.
  *
  * @param BlackImage    Pointer to the image data.
  * 
- * @return double_array A structure containing the calculated area in square centimeters
+ * @return double_array A structure containing the explored area in square centimeters
  *                      (result[0]) and square feet (result[1]).
  */
-double_array calculate_area_triangle(UBYTE *BlackImage);
+double_array calculate_area_map(UBYTE *BlackImage, bool *aborted);
 
 /**
- * @brief Calculate the area of an irregular shape based on the user's selection.
+ * @brief The last sweep that ran to a full turn.
  *
- * @param BlackImage    Pointer to the image data.
- * 
- * @return double_array A structure containing the calculated area in square centimeters
- *                      (result[0]) and square feet (result[1]).
+ * @return The sweep ring, or NULL if no sweep has completed or one is running.
  */
-double_array calculate_area_Irregular(UBYTE *BlackImage);
+const sweep_scan *area_last_scan(void);
 
 /**
- * @brief Calculate the area of a specific irregular shape (Shape 1) based on the measured
- *        distances at six corners.
+ * @brief The occupancy map of the last Map measurement that was finished.
  *
- * @param BlackImage    Pointer to the image data.
- * 
- * @return double_array A structure containing the calculated area in square centimeters
- *                      (result[0]) and square feet (result[1]).
+ * @return The map, or NULL if none was finished or one is being built.
  */
-double_array calculate_area_shape1(UBYTE *BlackImage);
+const occ_map *area_last_map(void);
 
 /**
- * @brief Calculate the area of a specific irregular shape (Shape 2) based on the measured
- *        distances at eight corners.
+ * @brief Encode the last sweep that ran to a full turn (see scan_codec.h).
  *
- * @param BlackImage    Pointer to the image data.
- * 
- * @return double_array A structure containing the calculated area in square centimeters
- *                      (result[0]) and square feet (result[1]).
+ * @param out      Output; SCAN_ENCODED_MAX(SWEEP_MAX_POINTS) bytes always suffice.
+ * @param capacity Size of out.
+ * @return Bytes written, or 0 if there is no such sweep or out is too small.
  */
-double_array calculate_area_shape2(UBYTE *BlackImage);
+size_t area_encode_scan(uint8_t *out, size_t capacity);
 
-/**
- * @brief Calculate the area of a specific irregular shape (Shape 3) based on the measured
- *        distances at eight corners.
- *
- * @param BlackImage    Pointer to the image data.
- * 
- * @return double_array A structure containing the calculated area in square centimeters
- *                      (result[0]) and square feet (result[1]).
- */
-double_array calculate_area_shape3(UBYTE *BlackImage);
-
-/**
- * @brief Calculate the area of a specific irregular shape (Shape 4) based on the measured
- *        distances at twelve corners.
- *
- * @param BlackImage    Pointer to the image data.
- * 
- * @return double_array A structure containing the calculated area in square centimeters
- *                      (result[0]) and square feet (result[1]).
- */
-double_array calculate_area_shape4(UBYTE *BlackImage);
-
-/**
- * @brief Calculate the area of a specific irregular shape (Shape 5) based on the measured
- *        distances at three corners.
- *
- * @param BlackImage    Pointer to the image data.
- * 
- * @return double_array A structure containing the calculated area in square centimeters
- *                      (result[0]) and square feet (result[1]).
- */
-double_array calculate_area_shape5(UBYTE *BlackImage);
+#endif // AREA_H
@@ -15,9 +15,112 @@
 */
 #include "button.h"
 #include "pico/stdlib.h"
+#include "event.h"
 
 #define bool_to_bit(x) ((uint)!!(x))
 
+/**
+ * @brief Debounce and gesture state of one button.
+ */
+typedef struct {
+    uint gpio;
+    volatile bool down;         // Debounced level, true while pressed
+    volatile bool settling;     // A debounce alarm is pending
+    uint32_t edge_us;           // First edge of the current bounce burst
+    uint32_t last_press_us;     // Accepted time of the previous press
+    volatile alarm_id_t long_alarm;  // Pending long-press alarm, 0 if none
+} button_state;
+
+static button_state buttons[2] = {
+    {.gpio = GPIO10},
+    {.gpio = GPIO11},
+};
+
+/**
+ * @brief Long-press alarm: the button has been held for BUTTON_LONG_US.
+ *
+ * If the other button is held as well, one long press for both is posted
+ * and the other button's alarm is cancelled.
+ */
+static int64_t long_press_alarm(alarm_id_t id, void *user_data) {
+    button_state *button = &buttons[(uintptr_t)user_data];
+    button_state *other = &buttons[1 - (uintptr_t)user_data];
+
+    button->long_alarm = 0;
+    if (!button->down) {
+        return 0;
+    }
+    if (other->down) {
+        if (other->long_alarm > 0) {
+            cancel_alarm(other->long_alarm);
+            other->long_alarm = 0;
+        }
+        event_post(EVENT_BUTTON_LONG, BUTTON_BOTH);
+    } else {
+        event_post(EVENT_BUTTON_LONG, button->gpio);
+    }
+    return 0;
+}
+
+/**
+ * @brief Debounce alarm: accept the level the pin settled to.
+ *
+ * Events carry the time of the first edge, so their timestamps reflect
+ * when the button moved rather than when the bouncing stopped.
+ */
+static int64_t debounce_alarm(alarm_id_t id, void *user_data) {
+    uintptr_t index = (uintptr_t)user_data;
+    button_state *button = &buttons[index];
+    bool down = !gpio_get(button->gpio);
+
+    button->settling = false;
+    if (down == button->down) {
+        // The burst ended where it started: a glitch, not a press
+        return 0;
+    }
+    button->down = down;
+
+    if (down) {
+        event_post_at(EVENT_BUTTON_PRESS, button->gpio, button->edge_us);
+        if (button->edge_us - button->last_press_us < BUTTON_DOUBLE_US) {
+            event_post_at(EVENT_BUTTON_DOUBLE, button->gpio, button->edge_us);
+        }
+        button->last_press_us = button->edge_us;
+        button->long_alarm = add_alarm_in_us(BUTTON_LONG_US - BUTTON_DEBOUNCE_US, long_press_alarm, user_data, true);
+    } else {
+        if (button->long_alarm > 0) {
+            cancel_alarm(button->long_alarm);
+            button->long_alarm = 0;
+        }
+        event_post_at(EVENT_BUTTON_RELEASE, button->gpio, button->edge_us);
+    }
+    return 0;
+}
+
+/**
+ * @brief Edge interrupt for both buttons.
+ *
+ * The first edge of a burst starts the debounce alarm; edges while it is
+ * pending are bounces and only the final level matters.
+ */
+static void button_irq(uint gpio, uint32_t events) {
+    uintptr_t index = gpio - GPIO10;
+    if (index > 1) {
+        return;
+    }
+
+    button_state *button = &buttons[index];
+    if (!button->settling) {
+        button->settling = true;
+        button->edge_us = time_us_32();
+        if (add_alarm_in_us(BUTTON_DEBOUNCE_US, debounce_alarm, (void *)index, true) < 0) {
+            // No alarm free: take the level as it is now, undebounced,
+            // rather than leave settling set and ignore the button for good
+            debounce_alarm(0, (void *)index);
+        }
+    }
+}
+
 void Button_Init(){
     // Set GPIO10 as input
     sio_hw->gpio_oe_clr = (1ul << GPIO10);
@@ -39,4 +142,11 @@ void Button_Init(){
      | (bool_to_bit(false) << PADS_BANK0_GPIO0_PDE_LSB))) 
      & (PADS_BANK0_GPIO0_PUE_BITS | PADS_BANK0_GPIO0_PDE_BITS);
 
-}
\ No newline at end of file
+    // Start from the current levels, then interrupt on every edge
+    for (int i = 0; i < 2; i++) {
+        buttons[i].down = !gpio_get(buttons[i].gpio);
+        buttons[i].last_press_us = time_us_32() - BUTTON_DOUBLE_US;
+    }
+    gpio_set_irq_enabled_with_callback(GPIO10, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, button_irq);
+    gpio_set_irq_enabled(GPIO11, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true);
+}
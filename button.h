@@ -21,5 +21,17 @@
 #define GPIO_OUT 1
 #define GPIO_IN  0
 
-// Function prototype for initializing buttons
+// Time an edge must settle before its level is accepted
+#define BUTTON_DEBOUNCE_US (10000)
+
+// Hold time that turns a press into a long press
+#define BUTTON_LONG_US (800000)
+
+// Maximum time between two presses of a double press
+#define BUTTON_DOUBLE_US (350000)
+
+// Event data of a long press made with both buttons held
+#define BUTTON_BOTH (0xFF)
+
+// Function prototype for initializing buttons and their edge interrupts
 void Button_Init();
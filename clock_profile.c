@@ -0,0 +1,60 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file clock_profile.c
+ * @brief System clock profile: clk_sys frequency and core voltage.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#include "clock_profile.h"
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/vreg.h"
+
+// Core voltage for the profile; the RP2040 meets 133 MHz at the default 1.10 V
+#if SSM_CLOCK_KHZ <= 133000
+#define CLOCK_VOLTAGE VREG_VOLTAGE_DEFAULT
+#elif SSM_CLOCK_KHZ <= 200000
+#define CLOCK_VOLTAGE VREG_VOLTAGE_1_15
+#elif SSM_CLOCK_KHZ <= 250000
+#define CLOCK_VOLTAGE VREG_VOLTAGE_1_20
+#else
+#define CLOCK_VOLTAGE VREG_VOLTAGE_1_25
+#endif
+
+// Time for the regulator to reach a new voltage
+#define CLOCK_VREG_SETTLE_US (1000)
+
+/**
+ * @brief Switch clk_sys to SSM_CLOCK_KHZ.
+ *
+ * The voltage goes up before the clock does. set_sys_clock_khz() stops
+ * with a panic if the PLL cannot make the frequency exactly, so a bad
+ * profile shows at the first boot rather than as drifting baud rates.
+ */
+void clock_profile_apply(void) {
+    if (SSM_CLOCK_KHZ == clock_get_hz(clk_sys) / 1000) {
+        return;
+    }
+    vreg_set_voltage(CLOCK_VOLTAGE);
+    busy_wait_us(CLOCK_VREG_SETTLE_US);
+    set_sys_clock_khz(SSM_CLOCK_KHZ, true);
+}
+
+/**
+ * @brief Processor cycles that last at least the given time.
+ *
+ * @param ns Time in nanoseconds.
+ * @return Cycles of clk_sys at its current frequency, rounded up.
+ */
+uint32_t clock_ns_to_cycles(uint32_t ns) {
+    uint64_t hz = clock_get_hz(clk_sys);
+    return (uint32_t)(((uint64_t)ns * hz + 999999999u) / 1000000000u);
+}
@@ -0,0 +1,56 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file clock_profile.h
+ * @brief System clock profile: clk_sys frequency and core voltage.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * SSM_CLOCK_KHZ sets clk_sys; above the stock 125 MHz the core voltage is
+ * raised first to keep the logic inside its timing. clk_peri follows
+ * clk_sys, so the UARTs, I2C and SPI must be set up after
+ * clock_profile_apply(); each derives its dividers and bit-bang delays
+ * from clock_get_hz() rather than from fixed counts, and keeps its bus
+ * timing at any profile.
+ */
+#ifndef CLOCK_PROFILE_H
+#define CLOCK_PROFILE_H
+
+#include <stdint.h>
+
+#ifndef SSM_CLOCK_KHZ
+#define SSM_CLOCK_KHZ (125000)
+#endif
+
+// Boot2 runs the flash at clk_sys / 2, and the Pico's W25Q16JV is rated to 133 MHz
+#define CLOCK_FLASH_DIVIDER (2)
+#define CLOCK_FLASH_MAX_KHZ (133000)
+
+#if SSM_CLOCK_KHZ / CLOCK_FLASH_DIVIDER > CLOCK_FLASH_MAX_KHZ
+#error "SSM_CLOCK_KHZ would run the flash past its rating"
+#endif
+
+/**
+ * @brief Switch clk_sys to SSM_CLOCK_KHZ.
+ *
+ * Call first in main(), before anything sets a baud rate. Does nothing
+ * at the stock frequency.
+ */
+void clock_profile_apply(void);
+
+/**
+ * @brief Processor cycles that last at least the given time.
+ *
+ * @param ns Time in nanoseconds.
+ * @return Cycles of clk_sys at its current frequency, rounded up.
+ */
+uint32_t clock_ns_to_cycles(uint32_t ns);
+
+#endif // CLOCK_PROFILE_H
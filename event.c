@@ -0,0 +1,213 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file event.c
+ * @brief Event queue that drives the user interface.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#include "event.h"
+#include "pico/stdlib.h"
+#include "pico/sync.h"
+#include "trace.h"
+
+static event queue[EVENT_QUEUE_SIZE];
+static volatile uint8_t queue_head;     // Next slot to write
+static volatile uint8_t queue_count;    // Number of queued events
+static critical_section_t queue_lock;
+
+// Event types of which at most one is queued at a time
+#define EVENT_COALESCE_MASK ((1u << EVENT_TICK) | (1u << EVENT_SENSOR_FRAME))
+
+static repeating_timer_t tick_timer;
+static volatile uint32_t tick_count;
+static volatile uint32_t pending_types; // Coalesced types queued and not yet taken
+
+static event_stats stats;
+static uint64_t stats_start_us;
+
+static void (*idle_hook)(void);         // Runs instead of sleeping in event_wait()
+
+/**
+ * @brief Timer tick: queue a tick.
+ */
+static bool tick_callback(repeating_timer_t *timer) {
+    (void)timer;
+    tick_count++;
+    event_post(EVENT_TICK, tick_count);
+    return true;
+}
+
+/**
+ * @brief Reset the queue and start the tick timer.
+ */
+void event_init(void) {
+    critical_section_init(&queue_lock);
+    queue_head = 0;
+    queue_count = 0;
+    tick_count = 0;
+    pending_types = 0;
+    event_reset_stats();
+
+    // A negative period keeps ticks evenly spaced regardless of callback time
+    add_repeating_timer_ms(-EVENT_TICK_MS, tick_callback, NULL, &tick_timer);
+}
+
+/**
+ * @brief Queue an event.
+ *
+ * @param type The event type.
+ * @param data Type-specific payload.
+ * @return false if the queue was full and the event was dropped.
+ */
+bool event_post(event_type type, uint32_t data) {
+    return event_post_at(type, data, time_us_32());
+}
+
+/**
+ * @brief Queue an event that happened earlier.
+ *
+ * @param type    The event type.
+ * @param data    Type-specific payload.
+ * @param time_us When the event happened, low 32 bits of time_us_64().
+ * @return false if the queue was full and the event was dropped.
+ */
+bool event_post_at(event_type type, uint32_t data, uint32_t time_us) {
+    bool posted = false;
+
+    critical_section_enter_blocking(&queue_lock);
+    if (pending_types & (1u << type)) {
+        // Coalesce: a consumer that falls behind sees one event, not a backlog
+        posted = true;
+    } else if (queue_count < EVENT_QUEUE_SIZE) {
+        event *slot = &queue[queue_head];
+        slot->type = type;
+        slot->data = data;
+        slot->time_us = time_us;
+        queue_head = (queue_head + 1) % EVENT_QUEUE_SIZE;
+        queue_count++;
+        pending_types |= (1u << type) & EVENT_COALESCE_MASK;
+        if (queue_count > stats.max_depth) {
+            stats.max_depth = queue_count;
+        }
+        stats.posted++;
+        posted = true;
+    } else {
+        stats.dropped++;
+    }
+    critical_section_exit(&queue_lock);
+    TRACE_INSTANT_EVENT(TRACE_EVENT, (type << 8) | (data & 0xFF));
+
+    // Wake a consumer that is between its empty check and WFE
+    __sev();
+    return posted;
+}
+
+/**
+ * @brief Take the next event without waiting.
+ *
+ * @param e Output event.
+ * @return false if the queue is empty.
+ */
+bool event_poll(event *e) {
+    bool taken = false;
+
+    critical_section_enter_blocking(&queue_lock);
+    if (queue_count > 0) {
+        uint8_t tail = (queue_head + EVENT_QUEUE_SIZE - queue_count) % EVENT_QUEUE_SIZE;
+        *e = queue[tail];
+        queue_count--;
+        pending_types &= ~(1u << e->type);
+        taken = true;
+    }
+    critical_section_exit(&queue_lock);
+    return taken;
+}
+
+/**
+ * @brief Take the next event, sleeping in WFE until there is one.
+ *
+ * @return The event.
+ */
+event event_wait(void) {
+    event e;
+
+    while (!event_poll(&e)) {
+        if (idle_hook != NULL) {
+            idle_hook();
+        } else {
+            event_sleep();
+        }
+    }
+    return e;
+}
+
+/**
+ * @brief Sleep in WFE until the next event or interrupt.
+ */
+void event_sleep(void) {
+    uint64_t sleep_start = time_us_64();
+    __wfe();
+    stats.idle_us += time_us_64() - sleep_start;
+}
+
+/**
+ * @brief Set the function event_wait() calls while the queue is empty.
+ *
+ * @param hook The hook, or NULL to sleep directly.
+ */
+void event_set_idle_hook(void (*hook)(void)) {
+    idle_hook = hook;
+}
+
+/**
+ * @brief Sleep until a given button is pressed.
+ *
+ * @param gpio The button GPIO.
+ */
+void event_wait_press(uint32_t gpio) {
+    while (true) {
+        event e = event_wait();
+        if (e.type == EVENT_BUTTON_PRESS && e.data == gpio) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Discard all queued events.
+ */
+void event_flush(void) {
+    event e;
+    while (event_poll(&e)) {
+    }
+}
+
+/**
+ * @brief Read the queue statistics.
+ *
+ * @param out Output statistics.
+ */
+void event_get_stats(event_stats *out) {
+    critical_section_enter_blocking(&queue_lock);
+    *out = stats;
+    critical_section_exit(&queue_lock);
+    out->elapsed_us = time_us_64() - stats_start_us;
+}
+
+/**
+ * @brief Restart the statistics window.
+ */
+void event_reset_stats(void) {
+    critical_section_enter_blocking(&queue_lock);
+    stats = (event_stats){0};
+    stats_start_us = time_us_64();
+    critical_section_exit(&queue_lock);
+}
@@ -0,0 +1,161 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file event.h
+ * @brief Event queue that drives the user interface.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Interrupt handlers post events; core0 takes them one at a time and sleeps
+ * in WFE while the queue is empty.
+ */
+#ifndef EVENT_H
+#define EVENT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of queued events; posts beyond this are dropped and counted
+#define EVENT_QUEUE_SIZE (32)
+
+// Period of the timer tick that paces the screens
+#define EVENT_TICK_MS (10)
+
+/**
+ * @brief Kinds of event.
+ */
+typedef enum {
+    EVENT_NONE = 0,
+    EVENT_TICK,             // Timer tick; data is the tick count
+    EVENT_BUTTON_PRESS,     // Button pressed; data is the GPIO number
+    EVENT_BUTTON_RELEASE,   // Button released; data is the GPIO number
+    EVENT_BUTTON_LONG,      // Button held BUTTON_LONG_US; data is the GPIO number or BUTTON_BOTH
+    EVENT_BUTTON_DOUBLE,    // Second press within BUTTON_DOUBLE_US; follows its EVENT_BUTTON_PRESS
+    EVENT_MEASURE_DONE,     // A measurement flow returned to the UI
+    EVENT_MEASURE_CANCEL,   // A measurement flow was abandoned
+    EVENT_SENSOR_FRAME,     // Core1 published sensor frames; data is the newest sequence number
+    EVENT_REMOTE_MEASURE,   // Host started a measurement; data is a menu entry, as ui_fsm_step() takes it
+} event_type;
+
+/**
+ * @brief One event.
+ */
+typedef struct {
+    uint8_t type;       // An event_type
+    uint32_t data;      // Type-specific payload
+    uint32_t time_us;   // Time of the event, low 32 bits of time_us_64()
+} event;
+
+/**
+ * @brief Queue statistics since the last reset.
+ */
+typedef struct {
+    uint64_t elapsed_us;    // Wall time covered by the statistics
+    uint64_t idle_us;       // Time core0 spent asleep in event_sleep()
+    uint32_t posted;        // Events accepted
+    uint32_t dropped;       // Events lost to a full queue
+    uint8_t max_depth;      // Deepest the queue has been
+} event_stats;
+
+/**
+ * @brief Reset the queue and start the tick timer.
+ */
+void event_init(void);
+
+/**
+ * @brief Queue an event.
+ *
+ * Safe from interrupt handlers and from either core. Ticks and sensor
+ * frames are coalesced: one is only queued if the previous one of the same
+ * type has been taken, and it keeps the data of the first post.
+ *
+ * @param type The event type.
+ * @param data Type-specific payload.
+ * @return false if the queue was full and the event was dropped.
+ */
+bool event_post(event_type type, uint32_t data);
+
+/**
+ * @brief Queue an event that happened earlier.
+ *
+ * @param type    The event type.
+ * @param data    Type-specific payload.
+ * @param time_us When the event happened, low 32 bits of time_us_64().
+ * @return false if the queue was full and the event was dropped.
+ */
+bool event_post_at(event_type type, uint32_t data, uint32_t time_us);
+
+/**
+ * @brief Take the next event without waiting.
+ *
+ * @param e Output event.
+ * @return false if the queue is empty.
+ */
+bool event_poll(event *e);
+
+/**
+ * @brief Take the next event, sleeping in WFE until there is one.
+ *
+ * @return The event.
+ */
+event event_wait(void);
+
+/**
+ * @brief Sleep in WFE until the next event or interrupt.
+ *
+ * The time asleep is counted as idle time.
+ */
+void event_sleep(void);
+
+/**
+ * @brief Set the function event_wait() calls while the queue is empty.
+ *
+ * The hook may do other work and return, or call event_sleep(); it is
+ * called again until an event arrives.
+ *
+ * @param hook The hook, or NULL to sleep directly.
+ */
+void event_set_idle_hook(void (*hook)(void));
+
+/**
+ * @brief Sleep until a given button is pressed.
+ *
+ * Other events are taken and discarded.
+ *
+ * @param gpio The button GPIO.
+ */
+void event_wait_press(uint32_t gpio);
+
+/**
+ * @brief Discard all queued events.
+ */
+void event_flush(void);
+
+/**
+ * @brief Read the queue statistics.
+ *
+ * @param stats Output statistics.
+ */
+void event_get_stats(event_stats *stats);
+
+/**
+ * @brief Restart the statistics window.
+ */
+void event_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EVENT_H
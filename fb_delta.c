@@ -0,0 +1,134 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file fb_delta.c
+ * @brief Compressed framebuffer updates for the display mirror.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#include "fb_delta.h"
+
+// Longest run of each token
+#define SKIP_MAX (128)
+#define LITERAL_MAX (64)
+#define REPEAT_MIN (3)
+#define REPEAT_MAX (66)
+
+/**
+ * @brief Length of the run of equal XOR bytes starting at i, up to limit.
+ */
+static size_t run_length(const uint8_t *now, const uint8_t *before, size_t i, size_t length, size_t limit) {
+    uint8_t x = now[i] ^ before[i];
+    size_t run = 1;
+
+    while (run < limit && i + run < length && (uint8_t)(now[i + run] ^ before[i + run]) == x) {
+        run++;
+    }
+    return run;
+}
+
+/**
+ * @brief Encode the change from one buffer to another.
+ *
+ * A literal is only cut short by two or more unchanged bytes or a repeat,
+ * which encode in no more bytes than they cover, so the output never
+ * exceeds FB_DELTA_MAX(length).
+ *
+ * @param now    The new bytes.
+ * @param before The bytes the receiver has.
+ * @param length Bytes in each buffer.
+ * @param out    Output of at least FB_DELTA_MAX(length) bytes.
+ * @return Bytes written to out; 0 only if length is 0.
+ */
+size_t fb_delta_encode(const uint8_t *now, const uint8_t *before, size_t length, uint8_t *out) {
+    size_t n = 0;
+    size_t i = 0;
+
+    while (i < length) {
+        uint8_t x = now[i] ^ before[i];
+        size_t run = run_length(now, before, i, length, x ? REPEAT_MAX : SKIP_MAX);
+
+        if (x == 0) {
+            out[n++] = (uint8_t)(run - 1);
+            i += run;
+            continue;
+        }
+        if (run >= REPEAT_MIN) {
+            out[n++] = (uint8_t)(0xC0 | (run - REPEAT_MIN));
+            out[n++] = x;
+            i += run;
+            continue;
+        }
+
+        // Literal bytes, up to the next stretch that encodes more cheaply
+        size_t control = n++;
+        size_t count = 0;
+        while (i < length && count < LITERAL_MAX) {
+            if (count > 0) {
+                uint8_t y = now[i] ^ before[i];
+                size_t ahead = run_length(now, before, i, length, REPEAT_MIN);
+                if ((y == 0 && ahead >= 2) || (y != 0 && ahead >= REPEAT_MIN)) {
+                    break;
+                }
+            }
+            out[n++] = now[i] ^ before[i];
+            count++;
+            i++;
+        }
+        out[control] = (uint8_t)(0x80 | (count - 1));
+    }
+    return n;
+}
+
+/**
+ * @brief Apply an encoded change in place.
+ *
+ * @param image  The bytes the sender encoded against; updated.
+ * @param length Bytes in image.
+ * @param delta  The encoding.
+ * @param size   Bytes in the encoding.
+ * @return false if the encoding is malformed or does not cover exactly
+ *         length bytes; image may then be partly updated.
+ */
+bool fb_delta_apply(uint8_t *image, size_t length, const uint8_t *delta, size_t size) {
+    const uint8_t *end = delta + size;
+    size_t i = 0;
+
+    while (delta < end) {
+        uint8_t c = *delta++;
+        size_t count;
+
+        if (c < 0x80) {
+            count = (size_t)c + 1;
+            if (i + count > length) {
+                return false;
+            }
+        } else if (c < 0xC0) {
+            count = (size_t)(c & 0x3F) + 1;
+            if (i + count > length || (size_t)(end - delta) < count) {
+                return false;
+            }
+            for (size_t k = 0; k < count; k++) {
+                image[i + k] ^= *delta++;
+            }
+        } else {
+            count = (size_t)(c & 0x3F) + REPEAT_MIN;
+            if (i + count > length || delta == end) {
+                return false;
+            }
+            uint8_t x = *delta++;
+            for (size_t k = 0; k < count; k++) {
+                image[i + k] ^= x;
+            }
+        }
+        i += count;
+    }
+    return i == length;
+}
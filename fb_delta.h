@@ -0,0 +1,92 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file fb_delta.h
+ * @brief Compressed framebuffer updates for the display mirror.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * An update is the XOR of the new framebuffer rows with the rows the
+ * receiver already has, run-length encoded. Menu and capture screens change
+ * a few text lines at a time, so the XOR is mostly zero and an update takes
+ * tens of bytes against 2 KB raw. Each token starts with a control byte:
+ *
+ *   0x00-0x7F   skip c + 1 unchanged bytes
+ *   0x80-0xBF   (c & 0x3F) + 1 XOR bytes follow
+ *   0xC0-0xFF   the next XOR byte, (c & 0x3F) + 3 times
+ *
+ * The host tools in tools/ build this file too; keep it free of SDK
+ * includes.
+ */
+#ifndef FB_DELTA_H
+#define FB_DELTA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Largest encoding of length bytes: all literal, one control byte per 64
+#define FB_DELTA_MAX(length) ((length) + ((length) + 63) / 64)
+
+// The delta applies to a blank framebuffer, not to the previous one
+#define FB_DELTA_KEYFRAME (0x01)
+
+/**
+ * @brief Header of one mirror packet; the encoded delta follows it.
+ */
+typedef struct {
+    uint32_t time_us;       // When the newest update in the packet was shown
+    uint16_t updates;       // OLED updates folded into the packet
+    uint8_t row_bytes;      // Bytes per framebuffer row
+    uint8_t height;         // Rows in the framebuffer
+    uint8_t first_row;      // First row the delta covers
+    uint8_t rows;           // Rows the delta covers
+    uint8_t flags;          // FB_DELTA_KEYFRAME
+    uint8_t reserved;
+} fb_delta_header;
+
+#ifdef __cplusplus
+static_assert(sizeof(fb_delta_header) == 12, "fb_delta_header is sent as is");
+#else
+_Static_assert(sizeof(fb_delta_header) == 12, "fb_delta_header is sent as is");
+#endif
+
+/**
+ * @brief Encode the change from one buffer to another.
+ *
+ * @param now    The new bytes.
+ * @param before The bytes the receiver has.
+ * @param length Bytes in each buffer.
+ * @param out    Output of at least FB_DELTA_MAX(length) bytes.
+ * @return Bytes written to out; 0 only if length is 0.
+ */
+size_t fb_delta_encode(const uint8_t *now, const uint8_t *before, size_t length, uint8_t *out);
+
+/**
+ * @brief Apply an encoded change in place.
+ *
+ * @param image  The bytes the sender encoded against; updated.
+ * @param length Bytes in image.
+ * @param delta  The encoding.
+ * @param size   Bytes in the encoding.
+ * @return false if the encoding is malformed or does not cover exactly
+ *         length bytes; image may then be partly updated.
+ */
+bool fb_delta_apply(uint8_t *image, size_t length, const uint8_t *delta, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FB_DELTA_H
@@ -0,0 +1,340 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file fixed_point.c
+ * @brief Integer-only geometry helpers used by the area calculations.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#include "fixed_point.h"
+#include <stdbool.h>
+
+// round(pi * 2^60)
+#define FX_PI_Q60 (3622009729038561421ull)
+
+// sin(0..90 degrees) in Q15, one entry per degree
+static const uint16_t fx_sin_table[91] = {
+    0, 572, 1144, 1715, 2286, 2856, 3425, 3993, 4560, 5126,
+    5690, 6252, 6813, 7371, 7927, 8481, 9032, 9580, 10126, 10668,
+    11207, 11743, 12275, 12803, 13328, 13848, 14365, 14876, 15384, 15886,
+    16384, 16877, 17364, 17847, 18324, 18795, 19261, 19720, 20174, 20622,
+    21063, 21498, 21926, 22348, 22763, 23170, 23571, 23965, 24351, 24730,
+    25102, 25466, 25822, 26170, 26510, 26842, 27166, 27482, 27789, 28088,
+    28378, 28660, 28932, 29197, 29452, 29698, 29935, 30163, 30382, 30592,
+    30792, 30983, 31164, 31336, 31499, 31651, 31795, 31928, 32052, 32166,
+    32270, 32365, 32449, 32524, 32588, 32643, 32688, 32723, 32748, 32763,
+    32768,
+};
+
+/**
+ * @brief Minimal unsigned 128-bit value for the Heron radicand.
+ */
+typedef struct {
+    uint64_t hi;
+    uint64_t lo;
+} fx_u128;
+
+/**
+ * @brief Multiply two 64-bit values into a 128-bit product.
+ *
+ * Built from 32x32 partial products since the M0+ has no 64-bit multiply.
+ */
+static fx_u128 fx_mul_u64(uint64_t a, uint64_t b) {
+    uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+    uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+
+    uint64_t lo_lo = a_lo * b_lo;
+    uint64_t hi_lo = a_hi * b_lo;
+    uint64_t lo_hi = a_lo * b_hi;
+    uint64_t hi_hi = a_hi * b_hi;
+
+    // Sum the middle column, carrying into the high word
+    uint64_t cross = (lo_lo >> 32) + (uint32_t)hi_lo + (uint32_t)lo_hi;
+
+    fx_u128 result;
+    result.lo = (cross << 32) | (uint32_t)lo_lo;
+    result.hi = hi_hi + (hi_lo >> 32) + (lo_hi >> 32) + (cross >> 32);
+    return result;
+}
+
+static bool fx_u128_ge(fx_u128 a, fx_u128 b) {
+    return (a.hi > b.hi) || (a.hi == b.hi && a.lo >= b.lo);
+}
+
+static fx_u128 fx_u128_add(fx_u128 a, fx_u128 b) {
+    fx_u128 result;
+    result.lo = a.lo + b.lo;
+    result.hi = a.hi + b.hi + (result.lo < a.lo);
+    return result;
+}
+
+static fx_u128 fx_u128_sub(fx_u128 a, fx_u128 b) {
+    fx_u128 result;
+    result.lo = a.lo - b.lo;
+    result.hi = a.hi - b.hi - (a.lo < b.lo);
+    return result;
+}
+
+static fx_u128 fx_u128_shr(fx_u128 a, unsigned n) {
+    fx_u128 result;
+    if (n == 0) {
+        return a;
+    } else if (n >= 64) {
+        result.lo = a.hi >> (n - 64);
+        result.hi = 0;
+    } else {
+        result.lo = (a.lo >> n) | (a.hi << (64 - n));
+        result.hi = a.hi >> n;
+    }
+    return result;
+}
+
+/**
+ * @brief Digit-by-digit integer square root of a 128-bit value.
+ */
+static uint64_t fx_isqrt128(fx_u128 value) {
+    fx_u128 res = {0, 0};
+    fx_u128 bit = {1ull << 62, 0};
+
+    // Start from the highest power of four not greater than the value
+    while (!fx_u128_ge(value, bit) && (bit.hi | bit.lo)) {
+        bit = fx_u128_shr(bit, 2);
+    }
+
+    while (bit.hi | bit.lo) {
+        fx_u128 trial = fx_u128_add(res, bit);
+        if (fx_u128_ge(value, trial)) {
+            value = fx_u128_sub(value, trial);
+            res = fx_u128_add(fx_u128_shr(res, 1), bit);
+        } else {
+            res = fx_u128_shr(res, 1);
+        }
+        bit = fx_u128_shr(bit, 2);
+    }
+    return res.lo;
+}
+
+/**
+ * @brief Integer square root of a 64-bit value.
+ *
+ * Uses the digit-by-digit method so only shifts, adds and compares are
+ * needed.
+ *
+ * @param value The radicand.
+ * @return floor(sqrt(value)).
+ */
+uint32_t fx_isqrt64(uint64_t value) {
+    uint64_t res = 0;
+    uint64_t bit = 1ull << 62;
+
+    // Start from the highest power of four not greater than the value
+    while (bit > value) {
+        bit >>= 2;
+    }
+
+    while (bit != 0) {
+        if (value >= res + bit) {
+            value -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)res;
+}
+
+/**
+ * @brief Saturating addition of two areas.
+ *
+ * @param acc   The running total.
+ * @param term  The area to add.
+ * @return acc + term, clamped to the fx_area_t range.
+ */
+fx_area_t fx_area_add(fx_area_t acc, fx_area_t term) {
+    if (term > 0 && acc > INT64_MAX - term) {
+        return INT64_MAX;
+    }
+    if (term < 0 && acc < INT64_MIN - term) {
+        return INT64_MIN;
+    }
+    return acc + term;
+}
+
+/**
+ * @brief Area of the product of two signed lengths in whole centimeters.
+ *
+ * The product of two 32-bit values times FX_SCALE always fits in 64 bits
+ * for the 16-bit distances the LiDAR reports.
+ *
+ * @param a First side in centimeters.
+ * @param b Second side in centimeters.
+ * @return a * b in hundredths of a square centimeter.
+ */
+fx_area_t fx_area_product(int32_t a, int32_t b) {
+    return (fx_area_t)a * b * FX_SCALE;
+}
+
+/**
+ * @brief Area of a circle from its diameter.
+ *
+ * Area * 100 = d^2 * pi * 25, evaluated against a Q60 pi in 128 bits so
+ * the result is exact to the nearest hundredth for any 16-bit diameter.
+ *
+ * @param diameter Diameter in centimeters.
+ * @return pi * d^2 / 4 in hundredths of a square centimeter.
+ */
+fx_area_t fx_area_circle(uint16_t diameter) {
+    uint64_t d2 = (uint64_t)diameter * diameter * (FX_SCALE / 4);
+    fx_u128 pi_d2 = fx_mul_u64(d2, FX_PI_Q60);
+    fx_u128 round = {0, 1ull << 59};
+    return (fx_area_t)fx_u128_shr(fx_u128_add(pi_d2, round), 60).lo;
+}
+
+/**
+ * @brief Area of a triangle from its three sides (Heron's formula).
+ *
+ * Uses the integer form 16 * A^2 = (a+b+c)(-a+b+c)(a-b+c)(a+b-c), so
+ * (100 * A)^2 = 625 * product. The product can reach 2^80, so the square
+ * root is taken over a 128-bit radicand.
+ *
+ * @param a First side in centimeters.
+ * @param b Second side in centimeters.
+ * @param c Third side in centimeters.
+ * @return Area in hundredths of a square centimeter, 0 if the sides do not
+ *         form a triangle.
+ */
+fx_area_t fx_area_triangle(uint16_t a, uint16_t b, uint16_t c) {
+    int32_t f0 = (int32_t)a + b + c;
+    int32_t f1 = -(int32_t)a + b + c;
+    int32_t f2 = (int32_t)a - b + c;
+    int32_t f3 = (int32_t)a + b - c;
+
+    // Degenerate or impossible triangle
+    if (f1 <= 0 || f2 <= 0 || f3 <= 0) {
+        return 0;
+    }
+
+    uint64_t p = (uint64_t)f0 * (uint32_t)f1;
+    uint64_t q = (uint64_t)f2 * (uint32_t)f3 * (FX_SCALE * FX_SCALE / 16);
+    fx_u128 x = fx_mul_u64(p, q);
+    uint64_t root = fx_isqrt128(x);
+
+    // Round to nearest: sqrt(x) >= root + 0.5 exactly when x > root * (root + 1)
+    fx_u128 half = fx_mul_u64(root, root + 1);
+    if (!fx_u128_ge(half, x)) {
+        root++;
+    }
+    return (fx_area_t)root;
+}
+
+/**
+ * @brief Area of a trapezoid from its parallel sides and height.
+ *
+ * @param a First parallel side in centimeters.
+ * @param b Second parallel side in centimeters.
+ * @param h Height in centimeters.
+ * @return (a + b) * h / 2 in hundredths of a square centimeter.
+ */
+fx_area_t fx_area_trapezoid(uint16_t a, uint16_t b, uint16_t h) {
+    return ((fx_area_t)a + b) * h * (FX_SCALE / 2);
+}
+
+/**
+ * @brief Convert an area from square centimeters to square feet.
+ *
+ * Uses the exact ratio 625 / 580644 so no rounding error accumulates from
+ * a truncated decimal constant.
+ *
+ * @param area_cm2 Area in hundredths of a square centimeter.
+ * @return Area in hundredths of a square foot, rounded to nearest.
+ */
+fx_area_t fx_cm2_to_ft2(fx_area_t area_cm2) {
+    const fx_area_t limit = INT64_MAX / FX_CM2_PER_FT2_DEN;
+    bool negative = area_cm2 < 0;
+    uint64_t magnitude = negative ? -(uint64_t)area_cm2 : (uint64_t)area_cm2;
+
+    if (magnitude > (uint64_t)limit) {
+        magnitude = (uint64_t)limit;
+    }
+    uint64_t ft2 = (magnitude * FX_CM2_PER_FT2_DEN + FX_CM2_PER_FT2_NUM / 2) / FX_CM2_PER_FT2_NUM;
+    return negative ? -(fx_area_t)ft2 : (fx_area_t)ft2;
+}
+
+/**
+ * @brief Convert a length from centimeters to feet.
+ *
+ * @param cm Length in whole centimeters.
+ * @return Length in hundredths of a foot, rounded to nearest.
+ */
+fx_length_t fx_cm_to_ft(uint32_t cm) {
+    // cm * 100 * 25 / 762, reduced to cm * 1250 / 381
+    const uint32_t num = FX_SCALE * FX_CM_PER_FOOT_DEN / 2;
+    const uint32_t den = FX_CM_PER_FOOT_NUM / 2;
+
+    if (cm > UINT32_MAX / num) {
+        cm = UINT32_MAX / num;
+    }
+    return (fx_length_t)((cm * num + den / 2) / den);
+}
+
+/**
+ * @brief Sine of an angle in the first quadrant.
+ *
+ * Linear interpolation between whole degrees keeps the error within a
+ * couple of Q15 LSBs.
+ */
+static int32_t fx_sin_quadrant(int32_t angle) {
+    int32_t index = angle / FX_DEGREE;
+    int32_t frac = angle % FX_DEGREE;
+
+    if (index >= 90) {
+        return FX_TRIG_ONE;
+    }
+    int32_t lo = fx_sin_table[index];
+    int32_t hi = fx_sin_table[index + 1];
+    return lo + ((hi - lo) * frac + FX_DEGREE / 2) / FX_DEGREE;
+}
+
+/**
+ * @brief Sine of an angle.
+ *
+ * @param angle Angle in hundredths of a degree, any sign or magnitude.
+ * @return sin(angle) in Q15 (FX_TRIG_ONE is 1.0).
+ */
+int32_t fx_sin(int32_t angle) {
+    const int32_t quarter = FX_FULL_TURN / 4;
+
+    // Wrap into [0, 360) degrees
+    angle %= FX_FULL_TURN;
+    if (angle < 0) {
+        angle += FX_FULL_TURN;
+    }
+
+    if (angle < quarter) {
+        return fx_sin_quadrant(angle);
+    } else if (angle < 2 * quarter) {
+        return fx_sin_quadrant(2 * quarter - angle);
+    } else if (angle < 3 * quarter) {
+        return -fx_sin_quadrant(angle - 2 * quarter);
+    }
+    return -fx_sin_quadrant(FX_FULL_TURN - angle);
+}
+
+/**
+ * @brief Cosine of an angle.
+ *
+ * @param angle Angle in hundredths of a degree, any sign or magnitude.
+ * @return cos(angle) in Q15 (FX_TRIG_ONE is 1.0).
+ */
+int32_t fx_cos(int32_t angle) {
+    // Shift by a quarter turn without overflowing near INT32_MAX
+    return fx_sin((angle % FX_FULL_TURN) + FX_FULL_TURN / 4);
+}
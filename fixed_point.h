@@ -0,0 +1,156 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file fixed_point.h
+ * @brief Integer-only geometry helpers used by the area calculations.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * The Cortex-M0+ has no FPU, so every double operation is a soft-float library
+ * call. All area and unit conversions are done here in 64-bit integers with
+ * two implied decimals; conversion to double happens only at the display.
+ */
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of implied fractional units in an fx_area_t / fx_length_t (2 decimals)
+#define FX_SCALE (100)
+
+// One foot is exactly 762/25 cm, so one square foot is 580644/625 cm^2
+#define FX_CM_PER_FOOT_NUM (762)
+#define FX_CM_PER_FOOT_DEN (25)
+#define FX_CM2_PER_FT2_NUM (580644)
+#define FX_CM2_PER_FT2_DEN (625)
+
+// Angles are carried in hundredths of a degree
+#define FX_DEGREE (100)
+#define FX_FULL_TURN (360 * FX_DEGREE)
+
+// Fixed-point one for the Q15 results of fx_sin() and fx_cos()
+#define FX_TRIG_ONE (32768)
+
+/**
+ * @brief Area in hundredths of a square unit (cm^2 or ft^2).
+ */
+typedef int64_t fx_area_t;
+
+/**
+ * @brief Length in hundredths of a unit (cm or ft).
+ */
+typedef int32_t fx_length_t;
+
+/**
+ * @brief Integer square root of a 64-bit value.
+ *
+ * @param value The radicand.
+ * @return floor(sqrt(value)).
+ */
+uint32_t fx_isqrt64(uint64_t value);
+
+/**
+ * @brief Saturating addition of two areas.
+ *
+ * @param acc   The running total.
+ * @param term  The area to add.
+ * @return acc + term, clamped to the fx_area_t range.
+ */
+fx_area_t fx_area_add(fx_area_t acc, fx_area_t term);
+
+/**
+ * @brief Area of the product of two signed lengths in whole centimeters.
+ *
+ * @param a First side in centimeters.
+ * @param b Second side in centimeters.
+ * @return a * b in hundredths of a square centimeter.
+ */
+fx_area_t fx_area_product(int32_t a, int32_t b);
+
+/**
+ * @brief Area of a circle from its diameter.
+ *
+ * @param diameter Diameter in centimeters.
+ * @return pi * d^2 / 4 in hundredths of a square centimeter.
+ */
+fx_area_t fx_area_circle(uint16_t diameter);
+
+/**
+ * @brief Area of a triangle from its three sides (Heron's formula).
+ *
+ * @param a First side in centimeters.
+ * @param b Second side in centimeters.
+ * @param c Third side in centimeters.
+ * @return Area in hundredths of a square centimeter, 0 if the sides do not
+ *         form a triangle.
+ */
+fx_area_t fx_area_triangle(uint16_t a, uint16_t b, uint16_t c);
+
+/**
+ * @brief Area of a trapezoid from its parallel sides and height.
+ *
+ * @param a First parallel side in centimeters.
+ * @param b Second parallel side in centimeters.
+ * @param h Height in centimeters.
+ * @return (a + b) * h / 2 in hundredths of a square centimeter.
+ */
+fx_area_t fx_area_trapezoid(uint16_t a, uint16_t b, uint16_t h);
+
+/**
+ * @brief Convert an area from square centimeters to square feet.
+ *
+ * @param area_cm2 Area in hundredths of a square centimeter.
+ * @return Area in hundredths of a square foot, rounded to nearest.
+ */
+fx_area_t fx_cm2_to_ft2(fx_area_t area_cm2);
+
+/**
+ * @brief Convert a length from centimeters to feet.
+ *
+ * @param cm Length in whole centimeters.
+ * @return Length in hundredths of a foot, rounded to nearest.
+ */
+fx_length_t fx_cm_to_ft(uint32_t cm);
+
+/**
+ * @brief Sine of an angle.
+ *
+ * @param angle Angle in hundredths of a degree, any sign or magnitude.
+ * @return sin(angle) in Q15 (FX_TRIG_ONE is 1.0).
+ */
+int32_t fx_sin(int32_t angle);
+
+/**
+ * @brief Cosine of an angle.
+ *
+ * @param angle Angle in hundredths of a degree, any sign or magnitude.
+ * @return cos(angle) in Q15 (FX_TRIG_ONE is 1.0).
+ */
+int32_t fx_cos(int32_t angle);
+
+/**
+ * @brief Convert a fixed-point value to double for display.
+ *
+ * @param value Value in hundredths.
+ * @return The value as a double.
+ */
+static inline double fx_to_double(int64_t value) {
+    return (double)value / FX_SCALE;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FIXED_POINT_H
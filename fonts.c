@@ -30,6 +30,9 @@
 ******************************************************************************/
 #include "oled.h"
 
+// Glyph source for tools/fontgen, which builds the firmware's fonts from these
+// tables with only the characters the UI draws (see CmakeLists.txt). This file
+// is not compiled into the firmware
 const uint8_t Font8_Table[] = 
 {
 	// @0 ' ' (5 pixels wide)
@@ -0,0 +1,160 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file frame.c
+ * @brief Framed binary protocol of the USB link.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#include "frame.h"
+#include <string.h>
+
+/**
+ * @brief CRC-16/CCITT-FALSE of a buffer.
+ */
+static uint16_t frame_crc16(const uint8_t *bytes, size_t length) {
+    uint16_t crc = 0xFFFF;
+
+    while (length--) {
+        crc ^= (uint16_t)(*bytes++) << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief Encode a frame.
+ *
+ * @param type   The frame type.
+ * @param seq    The sequence number.
+ * @param data   The data, or NULL if length is 0.
+ * @param length Bytes of data, at most FRAME_MAX_DATA.
+ * @param out    Output of at least FRAME_MAX_ENCODED bytes.
+ * @return Bytes written to out, delimiter included, or 0 if length is too large.
+ */
+size_t frame_encode(uint8_t type, uint8_t seq, const void *data, size_t length, uint8_t *out) {
+    uint8_t raw[FRAME_MAX_RAW];
+
+    if (length > FRAME_MAX_DATA) {
+        return 0;
+    }
+    raw[0] = type;
+    raw[1] = seq;
+    if (length > 0) {
+        memcpy(&raw[2], data, length);
+    }
+    uint16_t crc = frame_crc16(raw, length + 2);
+    raw[length + 2] = (uint8_t)crc;
+    raw[length + 3] = (uint8_t)(crc >> 8);
+
+    // COBS: each code byte gives the distance to the next zero, which it
+    // replaces; a code of 0xFF is a run of 254 non-zero bytes with no zero
+    size_t code_at = 0;
+    size_t n = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < length + 4; i++) {
+        if (raw[i] == 0) {
+            out[code_at] = code;
+            code_at = n++;
+            code = 1;
+            continue;
+        }
+        out[n++] = raw[i];
+        if (++code == 0xFF) {
+            out[code_at] = code;
+            code_at = n++;
+            code = 1;
+        }
+    }
+    out[code_at] = code;
+    out[n++] = 0;
+    return n;
+}
+
+/**
+ * @brief Reset a decoder to wait for the start of a frame.
+ *
+ * @param decoder The decoder.
+ */
+void frame_decoder_init(frame_decoder *decoder) {
+    decoder->length = 0;
+    decoder->overflow = 0;
+}
+
+/**
+ * @brief Undo COBS and check a frame.
+ */
+static frame_status frame_unpack(const uint8_t *in, size_t length, frame *out) {
+    uint8_t raw[FRAME_MAX_RAW + 1];
+    size_t n = 0;
+    size_t i = 0;
+
+    while (i < length) {
+        uint8_t code = in[i++];
+        if (code == 0 || i + code - 1 > length) {
+            return FRAME_BAD;
+        }
+        for (uint8_t k = 1; k < code; k++) {
+            if (n >= sizeof(raw)) {
+                return FRAME_BAD;
+            }
+            raw[n++] = in[i++];
+        }
+        // The zero a code stands for, except after a full run or at the end
+        if (code < 0xFF && i < length) {
+            if (n >= sizeof(raw)) {
+                return FRAME_BAD;
+            }
+            raw[n++] = 0;
+        }
+    }
+
+    if (n < 4 || n > FRAME_MAX_RAW) {
+        return FRAME_BAD;
+    }
+    uint16_t crc = (uint16_t)(raw[n - 2] | (raw[n - 1] << 8));
+    if (crc != frame_crc16(raw, n - 2)) {
+        return FRAME_BAD;
+    }
+    out->type = raw[0];
+    out->seq = raw[1];
+    out->length = (uint16_t)(n - 4);
+    memcpy(out->data, &raw[2], out->length);
+    return FRAME_READY;
+}
+
+/**
+ * @brief Feed one received byte to a decoder.
+ *
+ * @param decoder The decoder.
+ * @param byte    The byte.
+ * @param out     Output frame, written when FRAME_READY is returned.
+ * @return Whether a frame ended at this byte, and if it was valid.
+ */
+frame_status frame_decode(frame_decoder *decoder, uint8_t byte, frame *out) {
+    if (byte != 0) {
+        if (decoder->length < sizeof(decoder->buf)) {
+            decoder->buf[decoder->length++] = byte;
+        } else {
+            decoder->overflow = 1;
+        }
+        return FRAME_PENDING;
+    }
+
+    // Back-to-back delimiters carry no frame
+    if (decoder->length == 0 && !decoder->overflow) {
+        return FRAME_PENDING;
+    }
+    frame_status status = decoder->overflow ? FRAME_BAD : frame_unpack(decoder->buf, decoder->length, out);
+    frame_decoder_init(decoder);
+    return status;
+}
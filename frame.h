@@ -0,0 +1,154 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file frame.h
+ * @brief Framed binary protocol of the USB link.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * A frame is a type, a sequence number, up to FRAME_MAX_DATA bytes of data
+ * and a CRC-16 of all three, COBS-encoded and ended by a zero byte. COBS
+ * leaves no zero inside a frame, so a receiver that starts mid-stream or
+ * loses bytes resynchronizes at the next zero. Multi-byte fields are
+ * little-endian.
+ *
+ * The host tools in tools/ build this file too; keep it free of SDK
+ * includes.
+ */
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Largest data field
+#define FRAME_MAX_DATA (240)
+
+// Type, sequence number, data and CRC before encoding
+#define FRAME_MAX_RAW (FRAME_MAX_DATA + 4)
+
+// Encoded frame: one COBS code byte per 254 bytes, plus the delimiter
+#define FRAME_MAX_ENCODED (FRAME_MAX_RAW + FRAME_MAX_RAW / 254 + 2)
+
+// Export requests, host to device; a new one drops the export in progress
+#define FRAME_GET_JOURNAL (0x01)    // Every journal record, oldest first
+#define FRAME_GET_SCAN (0x02)       // The last completed sweep, or with a uint32_t
+                                    // record id the sweep stored with that record
+#define FRAME_GET_MAP (0x03)        // The occupancy grid of the last finished map
+
+// Remote control commands, host to device. Each gets one FRAME_REPLY, in the
+// order sent, so a host may have several in flight and match the replies by
+// sequence number.
+#define FRAME_CMD_PING (0x10)       // Any data, echoed in the reply
+#define FRAME_CMD_PRESS (0x11)      // uint8_t button, 0 Yellow and 1 Red; an optional
+                                    // uint8_t 1 holds it as a long press
+#define FRAME_CMD_MEASURE (0x12)    // Menu entry to measure, as text without terminator
+#define FRAME_CMD_STATUS (0x13)     // Reply: uint8_t ui_state, uint8_t step, uint8_t
+                                    // steps, then the shape as text
+#define FRAME_CMD_MIRROR (0x14)     // uint8_t 1 starts the display mirror, 0 stops it
+
+// Device to host. Sequence numbers count every frame the device sends, so a
+// gap shows a lost frame whatever request it belonged to.
+#define FRAME_RECORD (0x81)         // uint32_t record id, then a journal_record
+#define FRAME_SCAN (0x82)           // uint32_t offset, uint32_t total, then bytes of
+                                    // the sweep encoded as in scan_codec.h
+#define FRAME_MAP (0x83)            // uint32_t offset, uint32_t total, then bytes of
+                                    // the map in the export form of occupancy.h
+#define FRAME_END (0x8F)            // uint32_t records, scan or map bytes sent, uint8_t status
+#define FRAME_REPLY (0x90)          // uint8_t command sequence number, uint8_t status,
+                                    // then the command's reply data
+#define FRAME_CAPTURED (0x91)       // uint8_t step, uint8_t steps, uint16_t distance in
+                                    // cm, as soon as a capture step is taken
+#define FRAME_RESULT (0x92)         // int32_t result[2] in hundredths, then the shape as
+                                    // text, as soon as a measurement completes
+#define FRAME_CANCELLED (0x93)      // The running measurement was abandoned
+#define FRAME_MIRROR (0x94)         // uint16_t packet number, uint16_t offset, uint16_t
+                                    // total, then bytes of a packet of fb_delta.h
+
+// Encoded scan bytes in one FRAME_SCAN
+#define FRAME_SCAN_CHUNK (FRAME_MAX_DATA - 8)
+
+// Map bytes in one FRAME_MAP
+#define FRAME_MAP_CHUNK (FRAME_MAX_DATA - 8)
+
+// Status in FRAME_END and FRAME_REPLY
+#define FRAME_STATUS_OK (0)
+#define FRAME_STATUS_NO_DATA (1)    // Nothing to export, such as no sweep yet
+#define FRAME_STATUS_UNKNOWN (2)    // Request type not known, or not built in
+#define FRAME_STATUS_BUSY (3)       // A measurement is running or the event queue is full;
+                                    // or a new map replaced the one being exported
+#define FRAME_STATUS_BAD_ARG (4)    // Missing or invalid command data
+
+/**
+ * @brief One decoded frame.
+ */
+typedef struct {
+    uint8_t type;
+    uint8_t seq;
+    uint16_t length;                // Bytes in data
+    uint8_t data[FRAME_MAX_DATA];
+} frame;
+
+/**
+ * @brief Result of feeding a byte to the decoder.
+ */
+typedef enum {
+    FRAME_PENDING,  // No frame ends here
+    FRAME_READY,    // A valid frame was decoded
+    FRAME_BAD,      // A frame ended but was too long, malformed or failed its CRC
+} frame_status;
+
+/**
+ * @brief Decoder state: the encoded bytes since the last delimiter.
+ */
+typedef struct {
+    uint8_t buf[FRAME_MAX_ENCODED];
+    uint16_t length;
+    uint8_t overflow;               // More bytes than any valid frame
+} frame_decoder;
+
+/**
+ * @brief Encode a frame.
+ *
+ * @param type   The frame type.
+ * @param seq    The sequence number.
+ * @param data   The data, or NULL if length is 0.
+ * @param length Bytes of data, at most FRAME_MAX_DATA.
+ * @param out    Output of at least FRAME_MAX_ENCODED bytes.
+ * @return Bytes written to out, delimiter included, or 0 if length is too large.
+ */
+size_t frame_encode(uint8_t type, uint8_t seq, const void *data, size_t length, uint8_t *out);
+
+/**
+ * @brief Reset a decoder to wait for the start of a frame.
+ *
+ * @param decoder The decoder.
+ */
+void frame_decoder_init(frame_decoder *decoder);
+
+/**
+ * @brief Feed one received byte to a decoder.
+ *
+ * @param decoder The decoder.
+ * @param byte    The byte.
+ * @param out     Output frame, written when FRAME_READY is returned.
+ * @return Whether a frame ended at this byte, and if it was valid.
+ */
+frame_status frame_decode(frame_decoder *decoder, uint8_t byte, frame *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FRAME_H
@@ -15,6 +15,14 @@
 */
 #include "stdio.h"
 #include "i2c_code.h"
+#include "profile.h"
+#include "trace.h"
+#include "log.h"
+#include "ram_code.h"
+
+// Bus rates; the SDK derives the SCL counts and SDA hold time from clk_sys
+#define I2C0_BAUD_HZ (200 * 1000)
+#define I2C1_BAUD_HZ (100 * 1000)
 
 /**
  * @brief Write data to the specified register over I2C.
@@ -28,11 +36,11 @@
  * @param nbytes    Number of bytes to write.
  * @return int      Number of bytes written.
  */
-int reg_write(i2c_inst_t *i2c,
-              const uint addr,
-              const uint8_t reg,
-              uint8_t *buf,
-              const uint8_t nbytes) {
+int RAM_FUNC(reg_write)(i2c_inst_t *i2c,
+                        const uint addr,
+                        const uint8_t reg,
+                        uint8_t *buf,
+                        const uint8_t nbytes) {
     // Initialize the number of bytes written
     int num_bytes_written = 0;
 
@@ -69,11 +77,11 @@ int reg_write(i2c_inst_t *i2c,
  * @param nbytes    Number of bytes to read.
  * @return int      Number of bytes read.
  */
-int reg_read(i2c_inst_t *i2c,
-             const uint addr,
-             const uint8_t reg,
-             uint8_t *buf,
-             const uint8_t nbytes) {
+int RAM_FUNC(reg_read)(i2c_inst_t *i2c,
+                       const uint addr,
+                       const uint8_t reg,
+                       uint8_t *buf,
+                       const uint8_t nbytes) {
     // Initialize the number of bytes read
     int num_bytes_read = 0;
 
@@ -81,10 +89,14 @@ int reg_read(i2c_inst_t *i2c,
     if (nbytes < 1) {
         return 0; // Return 0 if an invalid number of bytes is provided
     }
+    PROFILE_START(PROFILE_REG_READ);
+    TRACE_SPAN_BEGIN(TRACE_I2C, addr);
 
     // Read data from register(s) over I2C
     i2c_write_blocking(i2c, addr, &reg, 1, true);
     num_bytes_read = i2c_read_blocking(i2c, addr, buf, nbytes, false);
+    TRACE_SPAN_END(TRACE_I2C);
+    PROFILE_STOP(PROFILE_REG_READ);
 
     return num_bytes_read; // Return the number of bytes read
 }
@@ -96,19 +108,23 @@ int reg_read(i2c_inst_t *i2c,
  * This function initializes the I2C modules and pins for communication.
  * It sets the I2C0 port at 200 kHz and I2C1 port at 100 kHz.
  * It configures the corresponding SDA and SCK pins for I2C functionality.
+ * The dividers come from clk_sys as it is now, so this must run after
+ * clock_profile_apply(); the rates actually reached are logged.
  */
 void I2C_Module_Init() {
     // Initialize I2C0 port at 200 kHz
-    i2c_init(i2c0, 200 * 1000);
+    uint baud0 = i2c_init(i2c0, I2C0_BAUD_HZ);
 
     // Initialize I2C0 pins
     iobank0_hw->io[I2C_SDA].ctrl = GPIO_FUNC_I2C << IO_BANK0_GPIO0_CTRL_FUNCSEL_LSB;
     iobank0_hw->io[I2C_SCK].ctrl = GPIO_FUNC_I2C << IO_BANK0_GPIO0_CTRL_FUNCSEL_LSB;
 
     // Initialize I2C1 port at 100 kHz
-    i2c_init(i2c1, 100 * 1000);
+    uint baud1 = i2c_init(i2c1, I2C1_BAUD_HZ);
 
     // Initialize I2C1 pins
     iobank0_hw->io[I2C1_SDA_PIN].ctrl = GPIO_FUNC_I2C << IO_BANK0_GPIO0_CTRL_FUNCSEL_LSB;
     iobank0_hw->io[I2C1_SCL_PIN].ctrl = GPIO_FUNC_I2C << IO_BANK0_GPIO0_CTRL_FUNCSEL_LSB;
+
+    LOG_INFO("I2C0 at %u Hz, I2C1 at %u Hz\n\r", baud0, baud1);
 }
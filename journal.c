@@ -0,0 +1,615 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file journal.c
+ * @brief Append-only journal of measurements in the external flash.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * The flash is read through the XIP window. Erasing and programming stop
+ * execution from flash, so core1 is locked out and core0 runs with
+ * interrupts masked for each operation.
+ */
+#include "journal.h"
+#include <stddef.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "log.h"
+
+// The ring ends at the end of the flash the board is built for
+#define JOURNAL_OFFSET (PICO_FLASH_SIZE_BYTES - JOURNAL_SECTORS * FLASH_SECTOR_SIZE)
+
+#define JOURNAL_MAGIC (0x4A4D5353)      // "SSMJ"
+#define JOURNAL_COMMITTED (0x0000)      // Commit marker; erased flash reads 0xFFFF
+
+// The scan ring sits just below the record ring; a scan's data starts on
+// the sector's second page, so the header page can be programmed last
+#define JOURNAL_SCAN_OFFSET (JOURNAL_OFFSET - JOURNAL_SCAN_SECTORS * FLASH_SECTOR_SIZE)
+#define JOURNAL_SCAN_MAGIC (0x43534D53)  // "SMSC"
+#define JOURNAL_SCAN_DATA (FLASH_PAGE_SIZE)
+
+// End of the program image in the XIP window, from the SDK's linker script
+extern char __flash_binary_end;
+
+_Static_assert(JOURNAL_SCAN_DATA + JOURNAL_SCAN_MAX <= FLASH_SECTOR_SIZE, "a scan must fit one sector");
+_Static_assert(sizeof(journal_record) == JOURNAL_RECORD_SIZE, "journal_record must fill one slot");
+_Static_assert(FLASH_SECTOR_SIZE == 4096, "JOURNAL_SECTOR_RECORDS assumes 4 KB sectors");
+_Static_assert(JOURNAL_SECTOR_RECORDS <= 64, "a sector's slots must fit one index bitmap");
+
+/**
+ * @brief Start of a sector, in slot 0.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;           // Grows by one per sector opened
+    uint32_t seq_check;     // ~seq; catches a header cut short
+    uint32_t erases;        // Times this sector has been erased
+} journal_header;
+
+/**
+ * @brief Start of a scan sector, programmed after the scan itself.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;           // Grows by one per scan stored
+    uint32_t length;        // Bytes of the encoded scan
+    uint16_t crc;           // CRC-16 of the encoded scan
+    uint16_t reserved;
+} journal_scan_header;
+
+static bool usable;             // The rings lie past the program image
+static journal_cursor head;     // Sector being filled and its next free slot
+static bool opened;             // head.sector has a valid header
+
+static uint8_t scan_head;       // Scan sector holding the newest scan
+static uint32_t scan_seq;       // Its sequence number
+static bool scan_stored;        // Some scan sector has a valid header
+
+/**
+ * @brief Committed slots of the sectors in use, for reading by position.
+ *
+ * Built on first use and kept up to date by journal_append(); 640 bytes
+ * cover the whole ring.
+ */
+static struct {
+    bool built;
+    uint8_t sectors;                    // Sectors in use, counting back from the head
+    uint32_t total;                     // Committed records in those sectors
+    uint64_t slots[JOURNAL_SECTORS];    // Bit slot - 1 set for each committed slot
+    uint16_t counts[JOURNAL_SECTORS];   // Bits set in slots[]
+} slot_index;
+
+/**
+ * @brief Flash offset of a slot; slot 0 is the header.
+ */
+static uint32_t slot_offset(uint8_t sector, uint8_t slot) {
+    return JOURNAL_OFFSET + sector * FLASH_SECTOR_SIZE + slot * JOURNAL_RECORD_SIZE;
+}
+
+/**
+ * @brief Address of a flash offset in the XIP window.
+ */
+static const uint8_t *flash_ptr(uint32_t offset) {
+    return (const uint8_t *)(XIP_BASE + offset);
+}
+
+/**
+ * @brief CRC-16/CCITT of a buffer.
+ */
+static uint16_t crc16(const void *data, size_t length) {
+    const uint8_t *bytes = data;
+    uint16_t crc = 0xFFFF;
+
+    while (length--) {
+        crc ^= (uint16_t)(*bytes++) << 8;
+        for (uint8_t i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief Stop everything that runs from flash.
+ */
+static uint32_t flash_lock(void) {
+    if (multicore_lockout_victim_is_initialized(1)) {
+        multicore_lockout_start_blocking();
+    }
+    return save_and_disable_interrupts();
+}
+
+/**
+ * @brief Resume what flash_lock() stopped.
+ */
+static void flash_unlock(uint32_t irq) {
+    restore_interrupts(irq);
+    if (multicore_lockout_victim_is_initialized(1)) {
+        multicore_lockout_end_blocking();
+    }
+}
+
+/**
+ * @brief Program bytes within one flash page.
+ *
+ * The rest of the page is programmed with 0xFF, which leaves it unchanged.
+ */
+static void program(uint32_t offset, const void *data, size_t length) {
+    static uint8_t page[FLASH_PAGE_SIZE];
+    uint32_t page_offset = offset & ~(FLASH_PAGE_SIZE - 1);
+    uint32_t irq;
+
+    memset(page, 0xFF, sizeof(page));
+    memcpy(&page[offset - page_offset], data, length);
+
+    irq = flash_lock();
+    flash_range_program(page_offset, page, FLASH_PAGE_SIZE);
+    flash_unlock(irq);
+}
+
+/**
+ * @brief Read and check the header of a sector.
+ */
+static bool read_header(uint8_t sector, journal_header *header) {
+    memcpy(header, flash_ptr(slot_offset(sector, 0)), sizeof(*header));
+    return header->magic == JOURNAL_MAGIC && header->seq_check == ~header->seq;
+}
+
+/**
+ * @brief Flash offset of a scan sector.
+ */
+static uint32_t scan_offset(uint8_t sector) {
+    return JOURNAL_SCAN_OFFSET + sector * FLASH_SECTOR_SIZE;
+}
+
+/**
+ * @brief Read and check the header of a scan sector.
+ */
+static bool read_scan_header(uint8_t sector, journal_scan_header *header) {
+    memcpy(header, flash_ptr(scan_offset(sector)), sizeof(*header));
+    return header->magic == JOURNAL_SCAN_MAGIC && header->length <= JOURNAL_SCAN_MAX;
+}
+
+/**
+ * @brief Whether a slot has never been programmed.
+ */
+static bool slot_blank(uint8_t sector, uint8_t slot) {
+    const uint8_t *p = flash_ptr(slot_offset(sector, slot));
+
+    for (uint8_t i = 0; i < JOURNAL_RECORD_SIZE; i++) {
+        if (p[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Whether a record was written completely.
+ */
+static bool record_valid(const journal_record *record) {
+    return record->commit == JOURNAL_COMMITTED &&
+           record->crc == crc16(record, offsetof(journal_record, crc));
+}
+
+/**
+ * @brief Whether a slot has its commit marker, without checking its CRC.
+ */
+static bool slot_committed(uint8_t sector, uint8_t slot) {
+    uint16_t commit;
+
+    memcpy(&commit, flash_ptr(slot_offset(sector, slot) + offsetof(journal_record, commit)),
+           sizeof(commit));
+    return commit == JOURNAL_COMMITTED;
+}
+
+/**
+ * @brief Add a committed slot to the index.
+ */
+static void index_add(uint8_t sector, uint8_t slot) {
+    slot_index.slots[sector] |= 1ull << (slot - 1);
+    slot_index.counts[sector]++;
+    slot_index.total++;
+}
+
+/**
+ * @brief Build the index from the commit markers of the sectors in use.
+ *
+ * Reads two bytes per slot, walking back from the head like journal_prev().
+ */
+static void index_build(void) {
+    journal_header header;
+    uint8_t sector = head.sector;
+    uint32_t seq = head.seq;
+
+    memset(&slot_index, 0, sizeof(slot_index));
+    slot_index.built = true;
+    if (!opened) {
+        return;
+    }
+
+    while (true) {
+        uint8_t last = (sector == head.sector) ? head.slot - 1 : JOURNAL_SECTOR_RECORDS;
+        for (uint8_t slot = 1; slot <= last; slot++) {
+            if (slot_committed(sector, slot)) {
+                index_add(sector, slot);
+            }
+        }
+        slot_index.sectors++;
+
+        sector = (sector + JOURNAL_SECTORS - 1) % JOURNAL_SECTORS;
+        if (sector == head.sector || !read_header(sector, &header) || header.seq != seq - 1) {
+            break;
+        }
+        seq = header.seq;
+    }
+}
+
+/**
+ * @brief Erase the sector after the head and make it the head.
+ */
+static void open_sector(void) {
+    uint8_t sector = (head.sector + 1) % JOURNAL_SECTORS;
+    journal_header header;
+    uint32_t erases = read_header(sector, &header) ? header.erases + 1 : 1;
+    uint32_t irq;
+
+    irq = flash_lock();
+    flash_range_erase(slot_offset(sector, 0), FLASH_SECTOR_SIZE);
+    flash_unlock(irq);
+
+    header = (journal_header){
+        .magic = JOURNAL_MAGIC,
+        .seq = head.seq + 1,
+        .seq_check = ~(head.seq + 1),
+        .erases = erases,
+    };
+    program(slot_offset(sector, 0), &header, sizeof(header));
+
+    head.sector = sector;
+    head.seq++;
+    head.slot = 1;
+    opened = true;
+
+    // Once the ring is full the new head was the oldest sector in use
+    if (slot_index.built) {
+        if (slot_index.sectors == JOURNAL_SECTORS) {
+            slot_index.total -= slot_index.counts[sector];
+        } else {
+            slot_index.sectors++;
+        }
+        slot_index.slots[sector] = 0;
+        slot_index.counts[sector] = 0;
+    }
+}
+
+/**
+ * @brief Find the end of the journal.
+ *
+ * The head is the sector with the newest valid header. Its slots are filled
+ * in order, so the first blank one is found by bisection.
+ */
+void journal_init(void) {
+    journal_header header;
+    journal_scan_header scan;
+    uint8_t low;
+    uint8_t high;
+    uint32_t image_end = (uint32_t)((uintptr_t)&__flash_binary_end - XIP_BASE);
+
+    scan_stored = false;
+    opened = false;
+    usable = image_end <= JOURNAL_SCAN_OFFSET;
+    if (!usable) {
+        // Erasing a sector of the rings would erase code
+        LOG_ERROR("Journal disabled: program image ends at 0x%lx, past the journal at 0x%lx\n\r",
+                  (unsigned long)image_end, (unsigned long)JOURNAL_SCAN_OFFSET);
+        return;
+    }
+
+    for (uint8_t sector = 0; sector < JOURNAL_SCAN_SECTORS; sector++) {
+        if (read_scan_header(sector, &scan) && (!scan_stored || (int32_t)(scan.seq - scan_seq) > 0)) {
+            scan_head = sector;
+            scan_seq = scan.seq;
+            scan_stored = true;
+        }
+    }
+
+    for (uint8_t sector = 0; sector < JOURNAL_SECTORS; sector++) {
+        if (read_header(sector, &header) && (!opened || (int32_t)(header.seq - head.seq) > 0)) {
+            head.sector = sector;
+            head.seq = header.seq;
+            opened = true;
+        }
+    }
+
+    if (!opened) {
+        // Empty journal: the first append opens sector 0 with sequence 0
+        head.sector = JOURNAL_SECTORS - 1;
+        head.seq = UINT32_MAX;
+        head.slot = JOURNAL_SECTOR_RECORDS + 1;
+        LOG_INFO("Journal empty\n\r");
+        return;
+    }
+
+    low = 1;
+    high = JOURNAL_SECTOR_RECORDS + 1;
+    while (low < high) {
+        uint8_t mid = (low + high) / 2;
+        if (slot_blank(head.sector, mid)) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    head.slot = low;
+    LOG_INFO("Journal at sector %u, record %u\n\r", head.sector, head.slot);
+}
+
+/**
+ * @brief Append a record and commit it.
+ *
+ * The slot counts as used once its body is programmed, so a record that
+ * loses power before its commit is never written over.
+ *
+ * @param record The record; crc and commit are filled in.
+ * @return false if the record could not be verified after programming or
+ *         the journal is disabled.
+ */
+bool journal_append(journal_record *record) {
+    uint32_t offset;
+    uint16_t commit = JOURNAL_COMMITTED;
+
+    if (!usable) {
+        return false;
+    }
+    if (head.slot > JOURNAL_SECTOR_RECORDS) {
+        open_sector();
+    }
+    offset = slot_offset(head.sector, head.slot);
+    head.slot++;
+
+    record->commit = 0xFFFF;
+    record->crc = crc16(record, offsetof(journal_record, crc));
+    program(offset, record, sizeof(*record));
+    program(offset + offsetof(journal_record, commit), &commit, sizeof(commit));
+    record->commit = JOURNAL_COMMITTED;
+
+    if (slot_index.built && slot_committed(head.sector, head.slot - 1)) {
+        index_add(head.sector, head.slot - 1);
+    }
+
+    if (memcmp(flash_ptr(offset), record, sizeof(*record)) != 0) {
+        LOG_ERROR("Journal record at sector %u slot %u failed to verify\n\r",
+                  head.sector, head.slot - 1);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Store an encoded sweep and point a record at it.
+ *
+ * The scan is programmed before its header, so a scan cut short by power
+ * loss has no valid header and the record it was meant for finds none.
+ *
+ * @param record The record; scan_sector and scan_tag are filled in.
+ * @param data   The encoded sweep.
+ * @param length Bytes of data, at most JOURNAL_SCAN_MAX.
+ * @return false if the sweep is too long, failed to verify or the journal
+ *         is disabled.
+ */
+bool journal_attach_scan(journal_record *record, const uint8_t *data, uint32_t length) {
+    uint8_t sector = scan_stored ? (scan_head + 1) % JOURNAL_SCAN_SECTORS : 0;
+    journal_scan_header header = {
+        .magic = JOURNAL_SCAN_MAGIC,
+        .seq = scan_stored ? scan_seq + 1 : 0,
+        .length = length,
+        .crc = crc16(data, length),
+        .reserved = 0xFFFF,
+    };
+    uint32_t offset = scan_offset(sector);
+    uint32_t irq;
+
+    record->scan_sector = 0;
+    if (!usable || length > JOURNAL_SCAN_MAX) {
+        return false;
+    }
+
+    irq = flash_lock();
+    flash_range_erase(offset, FLASH_SECTOR_SIZE);
+    flash_unlock(irq);
+
+    for (uint32_t done = 0; done < length; done += FLASH_PAGE_SIZE) {
+        uint32_t n = length - done < FLASH_PAGE_SIZE ? length - done : FLASH_PAGE_SIZE;
+        program(offset + JOURNAL_SCAN_DATA + done, data + done, n);
+    }
+    program(offset, &header, sizeof(header));
+
+    scan_head = sector;
+    scan_seq = header.seq;
+    scan_stored = true;
+
+    if (memcmp(flash_ptr(offset + JOURNAL_SCAN_DATA), data, length) != 0) {
+        LOG_ERROR("Journal scan in sector %u failed to verify\n\r", sector);
+        return false;
+    }
+    record->scan_sector = sector + 1;
+    record->scan_tag = (uint16_t)header.seq;
+    return true;
+}
+
+/**
+ * @brief Read the sweep attached to a record.
+ *
+ * @param record   The record.
+ * @param data     Output of up to capacity bytes.
+ * @param capacity Size of data.
+ * @return Bytes of the encoded sweep, or 0 if there is none, it has been
+ *         overwritten, it fails its CRC or it does not fit.
+ */
+uint32_t journal_read_scan(const journal_record *record, uint8_t *data, uint32_t capacity) {
+    journal_scan_header header;
+    const uint8_t *p;
+
+    if (!usable || record->scan_sector == 0 || record->scan_sector > JOURNAL_SCAN_SECTORS) {
+        return 0;
+    }
+    uint8_t sector = record->scan_sector - 1;
+    if (!read_scan_header(sector, &header) || (uint16_t)header.seq != record->scan_tag ||
+        header.length > capacity) {
+        return 0;
+    }
+    p = flash_ptr(scan_offset(sector) + JOURNAL_SCAN_DATA);
+    if (crc16(p, header.length) != header.crc) {
+        return 0;
+    }
+    memcpy(data, p, header.length);
+    return header.length;
+}
+
+/**
+ * @brief Find a record by its number.
+ *
+ * Numbers fall as the position grows, so the position is found by
+ * bisection with a dozen reads at most.
+ *
+ * @param id     The record number, as journal_record_id().
+ * @param record Output record.
+ * @return false if the record is no longer in the journal or fails its CRC.
+ */
+bool journal_find(uint32_t id, journal_record *record) {
+    uint32_t low = 0;
+    uint32_t high = journal_count();
+    uint32_t found;
+
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        found = id;     // Ends the search if the index has no such position
+        bool valid = journal_read(mid, record, &found);
+        if (found == id) {
+            return valid;
+        }
+        if (found > id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Number of committed records in the journal.
+ *
+ * The first call builds the index, reading the commit marker of every slot
+ * in use; later calls are immediate.
+ *
+ * @return The number of records.
+ */
+uint32_t journal_count(void) {
+    if (!slot_index.built) {
+        index_build();
+    }
+    return slot_index.total;
+}
+
+/**
+ * @brief Read a record by its position, newest first.
+ *
+ * The index is walked a sector at a time, so the cost is bounded by the
+ * number of sectors, not records, and only the record itself is read from
+ * flash.
+ *
+ * @param position 0 for the newest record, up to journal_count() - 1.
+ * @param record   Output record.
+ * @param id       Output record number, as journal_record_id().
+ * @return false if there is no such record or it fails its CRC.
+ */
+bool journal_read(uint32_t position, journal_record *record, uint32_t *id) {
+    if (position >= journal_count()) {
+        return false;
+    }
+
+    for (uint8_t back = 0; back < slot_index.sectors; back++) {
+        uint8_t sector = (head.sector + JOURNAL_SECTORS - back) % JOURNAL_SECTORS;
+        if (position >= slot_index.counts[sector]) {
+            position -= slot_index.counts[sector];
+            continue;
+        }
+
+        // The position-th newest committed slot of this sector
+        for (uint8_t slot = JOURNAL_SECTOR_RECORDS; slot >= 1; slot--) {
+            if (!(slot_index.slots[sector] & (1ull << (slot - 1))) || position-- > 0) {
+                continue;
+            }
+            memcpy(record, flash_ptr(slot_offset(sector, slot)), sizeof(*record));
+            *id = (head.seq - back) * JOURNAL_SECTOR_RECORDS + (slot - 1);
+            return record_valid(record);
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Point a cursor past the newest record.
+ *
+ * @param cursor The cursor.
+ */
+void journal_newest(journal_cursor *cursor) {
+    *cursor = head;
+}
+
+/**
+ * @brief Step a cursor back to the previous committed record and read it.
+ *
+ * The walk stops at a sector that was not opened just before the one after
+ * it, which is where the ring wraps to records already overwritten.
+ *
+ * @param cursor The cursor, from journal_newest().
+ * @param record Output record.
+ * @return false once the oldest record has been passed.
+ */
+bool journal_prev(journal_cursor *cursor, journal_record *record) {
+    journal_header header;
+
+    if (!opened) {
+        return false;
+    }
+    while (true) {
+        if (cursor->slot <= 1) {
+            uint8_t sector = (cursor->sector + JOURNAL_SECTORS - 1) % JOURNAL_SECTORS;
+            if (sector == head.sector || !read_header(sector, &header) ||
+                header.seq != cursor->seq - 1) {
+                return false;
+            }
+            cursor->sector = sector;
+            cursor->seq = header.seq;
+            cursor->slot = JOURNAL_SECTOR_RECORDS + 1;
+        }
+        cursor->slot--;
+        memcpy(record, flash_ptr(slot_offset(cursor->sector, cursor->slot)), sizeof(*record));
+        if (record_valid(record)) {
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief Number of a record, unique for the life of the journal.
+ *
+ * @param cursor The cursor, as left by journal_prev().
+ * @return The record number.
+ */
+uint32_t journal_record_id(const journal_cursor *cursor) {
+    return cursor->seq * JOURNAL_SECTOR_RECORDS + (cursor->slot - 1);
+}
@@ -0,0 +1,179 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file journal.h
+ * @brief Append-only journal of measurements in the external flash.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * The journal is a ring of flash sectors at the end of the flash, past the
+ * program image. Each sector starts with a header carrying a sequence number
+ * that grows by one per sector opened, followed by fixed-size records filled
+ * in order. Sectors are reused in turn, so every sector is erased equally
+ * often and the oldest records are the ones overwritten.
+ *
+ * A record is programmed in two steps: its body with a CRC, then its commit
+ * marker. A record cut short by power loss has no marker and is skipped.
+ *
+ * Below the ring, a second, smaller ring holds encoded sweeps (scan_codec.h),
+ * one per sector. A record refers to its sweep by sector and sequence
+ * number, so a record whose sweep has since been overwritten simply has
+ * none.
+ */
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Sectors in the ring (256 KB)
+#define JOURNAL_SECTORS (64)
+
+// Size of one record and of the sector header
+#define JOURNAL_RECORD_SIZE (64)
+
+// Records per sector, after the header
+#define JOURNAL_SECTOR_RECORDS (4096 / JOURNAL_RECORD_SIZE - 1)
+
+// Distances a record can hold
+#define JOURNAL_MAX_VALUES (12)
+
+// Length of the shape name, terminator included
+#define JOURNAL_SHAPE_LEN (16)
+
+// Sectors in the scan ring (64 KB), and the largest scan one can hold
+#define JOURNAL_SCAN_SECTORS (16)
+#define JOURNAL_SCAN_MAX (4096 - 256)
+
+/**
+ * @brief One measurement as stored in flash.
+ */
+typedef struct {
+    uint32_t time_ms;                       // Time since boot when recorded
+    char shape[JOURNAL_SHAPE_LEN];          // Menu entry that was measured
+    uint16_t values[JOURNAL_MAX_VALUES];    // Captured distances in centimeters
+    int32_t result[2];                      // Results shown, in hundredths
+    int16_t tilt[2];                        // Device tilt X and Y at the end
+    uint8_t steps;                          // Distances captured; 0 for sweeps
+    uint8_t scan_sector;                    // Scan sector + 1 of the attached sweep, 0 if none
+    uint16_t scan_tag;                      // Low bits of that scan's sequence number
+    uint16_t crc;                           // CRC-16 of the fields above
+    uint16_t commit;                        // JOURNAL_COMMITTED once complete
+} journal_record;
+
+/**
+ * @brief Position of a record, for walking the journal from the newest.
+ */
+typedef struct {
+    uint32_t seq;       // Sequence number of the sector
+    uint8_t sector;     // Sector in the ring
+    uint8_t slot;       // Record in the sector, counting from 1
+} journal_cursor;
+
+/**
+ * @brief Find the end of the journal.
+ *
+ * Only the sector headers and the newest sector are read, so this takes the
+ * same time however full the journal is. If the program image reaches into
+ * the rings the journal is disabled: it reads as empty and appends fail.
+ */
+void journal_init(void);
+
+/**
+ * @brief Append a record and commit it.
+ *
+ * Opening a new sector erases it, which stops both cores for up to the
+ * sector erase time of the flash (tens of milliseconds).
+ *
+ * @param record The record; crc and commit are filled in.
+ * @return false if the record could not be verified after programming or
+ *         the journal is disabled.
+ */
+bool journal_append(journal_record *record);
+
+/**
+ * @brief Store an encoded sweep and point a record at it.
+ *
+ * Call before journal_append(). Erases the oldest scan sector, which stops
+ * both cores as opening a record sector does.
+ *
+ * @param record The record; scan_sector and scan_tag are filled in.
+ * @param data   The encoded sweep.
+ * @param length Bytes of data, at most JOURNAL_SCAN_MAX.
+ * @return false if the sweep is too long, failed to verify or the journal
+ *         is disabled.
+ */
+bool journal_attach_scan(journal_record *record, const uint8_t *data, uint32_t length);
+
+/**
+ * @brief Read the sweep attached to a record.
+ *
+ * @param record   The record.
+ * @param data     Output of up to capacity bytes.
+ * @param capacity Size of data.
+ * @return Bytes of the encoded sweep, or 0 if there is none, it has been
+ *         overwritten, it fails its CRC or it does not fit.
+ */
+uint32_t journal_read_scan(const journal_record *record, uint8_t *data, uint32_t capacity);
+
+/**
+ * @brief Find a record by its number.
+ *
+ * @param id     The record number, as journal_record_id().
+ * @param record Output record.
+ * @return false if the record is no longer in the journal or fails its CRC.
+ */
+bool journal_find(uint32_t id, journal_record *record);
+
+/**
+ * @brief Number of committed records in the journal.
+ *
+ * The first call builds a RAM index of the committed slots; later calls and
+ * journal_append() keep it current.
+ *
+ * @return The number of records.
+ */
+uint32_t journal_count(void);
+
+/**
+ * @brief Read a record by its position, newest first.
+ *
+ * @param position 0 for the newest record, up to journal_count() - 1.
+ * @param record   Output record.
+ * @param id       Output record number, as journal_record_id().
+ * @return false if there is no such record or it fails its CRC.
+ */
+bool journal_read(uint32_t position, journal_record *record, uint32_t *id);
+
+/**
+ * @brief Point a cursor past the newest record.
+ *
+ * @param cursor The cursor.
+ */
+void journal_newest(journal_cursor *cursor);
+
+/**
+ * @brief Step a cursor back to the previous committed record and read it.
+ *
+ * @param cursor The cursor, from journal_newest().
+ * @param record Output record.
+ * @return false once the oldest record has been passed.
+ */
+bool journal_prev(journal_cursor *cursor, journal_record *record);
+
+/**
+ * @brief Number of a record, unique for the life of the journal.
+ *
+ * @param cursor The cursor, as left by journal_prev().
+ * @return The record number.
+ */
+uint32_t journal_record_id(const journal_cursor *cursor);
+
+#endif // JOURNAL_H
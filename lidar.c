@@ -15,7 +15,8 @@
 */
 #include "lidar.h"
 #include "i2c_code.h"
-#include "stdio.h"
+#include "profile.h"
+#include "trace.h"
 
 // I2C address of the LIDAR device
 static const uint8_t LIDAR = 0x10;
@@ -34,6 +35,8 @@ static const uint8_t DIST_HIGH = 0x01;
  * @return The distance measured by the LIDAR device.
  */
 uint16_t read_lidar() {
+    PROFILE_START(PROFILE_READ_LIDAR);
+
     // I2C instance to use (in this case, i2c0)
     i2c_inst_t *i2c = i2c0;
 
@@ -46,8 +49,8 @@ uint16_t read_lidar() {
     // Combine low and high bytes to get the distance
     uint16_t distance = (data[1] << 8) | data[0];
 
-    // Print the results (you can remove this if not needed)
-    printf("Distance: %d\r\n", distance);
+    TRACE_COUNTER_VALUE(TRACE_DISTANCE, distance);
 
+    PROFILE_STOP(PROFILE_READ_LIDAR);
     return distance;
 }
@@ -0,0 +1,255 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file log.c
+ * @brief Leveled logging with deferred formatting.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#include "log.h"
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "pico/sync.h"
+#include "task.h"
+#include "trace.h"
+
+// Messages buffered before new ones are dropped
+#define LOG_RING_SIZE (32)
+
+// Longest acceptable print step: one message at 115200 baud
+#define LOG_TASK_BUDGET_US (10000)
+
+// Longest conversion specification, such as "%-12.3lu"
+#define LOG_SPEC_MAX (16)
+
+/**
+ * @brief How a conversion reads its argument.
+ */
+typedef enum {
+    LOG_ARG_NONE,       // "%%", or the end of the format
+    LOG_ARG_INT,
+    LOG_ARG_LONG,
+    LOG_ARG_LLONG,
+    LOG_ARG_SIZE,
+    LOG_ARG_PTR,
+    LOG_ARG_DOUBLE,
+} log_arg_type;
+
+typedef union {
+    int i;
+    long l;
+    long long ll;
+    size_t z;
+    const void *p;
+    double d;
+} log_arg;
+
+typedef struct {
+    const log_site *site;
+    log_arg args[LOG_MAX_ARGS];
+} log_entry;
+
+static log_entry ring[LOG_RING_SIZE];
+static uint8_t ring_head;       // Next entry to write
+static uint8_t ring_count;      // Entries waiting to be printed
+static uint32_t dropped;        // Messages lost since the last report
+static critical_section_t ring_lock;
+
+static task_status log_step(task *t);
+static task log_task = { .name = "log", .fn = log_step, .budget_us = LOG_TASK_BUDGET_US,
+                         .trace_id = TRACE_TASK_LOG };
+
+/**
+ * @brief Find the next conversion in a format.
+ *
+ * @param format The format, from just after the previous conversion.
+ * @param spec   Start of the conversion, or the end of the format if none.
+ * @param type   How the conversion reads its argument.
+ * @return The format just after the conversion.
+ */
+static const char *next_spec(const char *format, const char **spec, log_arg_type *type) {
+    const char *p = strchr(format, '%');
+    uint8_t longs = 0;
+    bool size = false;
+
+    *type = LOG_ARG_NONE;
+    if (p == NULL) {
+        *spec = format + strlen(format);
+        return *spec;
+    }
+    *spec = p++;
+
+    // Flags, width and precision
+    while (*p != '\0' && strchr("-+ #0123456789.", *p) != NULL) {
+        p++;
+    }
+    // Length modifier
+    while (*p == 'h' || *p == 'l' || *p == 'z') {
+        longs += (*p == 'l');
+        size |= (*p == 'z');
+        p++;
+    }
+
+    switch (*p) {
+    case '\0':
+        return p;
+    case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+        *type = size ? LOG_ARG_SIZE : longs >= 2 ? LOG_ARG_LLONG : longs ? LOG_ARG_LONG : LOG_ARG_INT;
+        break;
+    case 's': case 'p':
+        *type = LOG_ARG_PTR;
+        break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        *type = LOG_ARG_DOUBLE;
+        break;
+    default:
+        break;
+    }
+    return p + 1;
+}
+
+/**
+ * @brief Queue a message; use the LOG_ macros instead.
+ *
+ * The arguments are read with the types their conversions name, so the
+ * entry holds the same values printf would have printed.
+ *
+ * @param site The call site.
+ * @param ...  The arguments of the site's format.
+ */
+void log_write(const log_site *site, ...) {
+    log_entry entry = { .site = site };
+    const char *format = site->format;
+    const char *spec;
+    log_arg_type type;
+    uint8_t count = 0;
+    va_list ap;
+
+    va_start(ap, site);
+    while (*format != '\0' && count < LOG_MAX_ARGS) {
+        format = next_spec(format, &spec, &type);
+        switch (type) {
+        case LOG_ARG_INT: entry.args[count++].i = va_arg(ap, int); break;
+        case LOG_ARG_LONG: entry.args[count++].l = va_arg(ap, long); break;
+        case LOG_ARG_LLONG: entry.args[count++].ll = va_arg(ap, long long); break;
+        case LOG_ARG_SIZE: entry.args[count++].z = va_arg(ap, size_t); break;
+        case LOG_ARG_PTR: entry.args[count++].p = va_arg(ap, const void *); break;
+        case LOG_ARG_DOUBLE: entry.args[count++].d = va_arg(ap, double); break;
+        default: break;
+        }
+    }
+    va_end(ap);
+
+    critical_section_enter_blocking(&ring_lock);
+    if (ring_count < LOG_RING_SIZE) {
+        ring[ring_head] = entry;
+        ring_head = (ring_head + 1) % LOG_RING_SIZE;
+        ring_count++;
+    } else {
+        dropped++;
+    }
+    critical_section_exit(&ring_lock);
+}
+
+/**
+ * @brief Print one entry, one conversion at a time.
+ */
+static void print_entry(const log_entry *entry) {
+    const char *format = entry->site->format;
+    const char *spec;
+    const char *next;
+    log_arg_type type;
+    char conversion[LOG_SPEC_MAX];
+    uint8_t count = 0;
+
+    if (entry->site->level == LOG_LEVEL_ERROR) {
+        printf("error: ");
+    } else if (entry->site->level == LOG_LEVEL_WARN) {
+        printf("warning: ");
+    }
+
+    while (*format != '\0') {
+        next = next_spec(format, &spec, &type);
+
+        // Text before the conversion
+        if (spec > format) {
+            printf("%.*s", (int)(spec - format), format);
+        }
+        if (next == spec) {
+            break;
+        }
+
+        size_t length = (size_t)(next - spec);
+        if (length >= sizeof(conversion) || (type != LOG_ARG_NONE && count >= LOG_MAX_ARGS)) {
+            printf("%.*s", (int)length, spec);
+            format = next;
+            continue;
+        }
+        memcpy(conversion, spec, length);
+        conversion[length] = '\0';
+
+        const log_arg *arg = &entry->args[count];
+        switch (type) {
+        case LOG_ARG_INT: printf(conversion, arg->i); break;
+        case LOG_ARG_LONG: printf(conversion, arg->l); break;
+        case LOG_ARG_LLONG: printf(conversion, arg->ll); break;
+        case LOG_ARG_SIZE: printf(conversion, arg->z); break;
+        case LOG_ARG_PTR: printf(conversion, arg->p); break;
+        case LOG_ARG_DOUBLE: printf(conversion, arg->d); break;
+        default: printf("%s", conversion[1] == '%' ? "%" : conversion); break;
+        }
+        if (type != LOG_ARG_NONE) {
+            count++;
+        }
+        format = next;
+    }
+}
+
+/**
+ * @brief Log task: print one queued message per step.
+ */
+static task_status log_step(task *t) {
+    log_entry entry;
+    uint32_t lost;
+    bool more;
+
+    critical_section_enter_blocking(&ring_lock);
+    if (ring_count == 0) {
+        critical_section_exit(&ring_lock);
+        return TASK_WAITING;
+    }
+    entry = ring[(ring_head + LOG_RING_SIZE - ring_count) % LOG_RING_SIZE];
+    ring_count--;
+    more = ring_count > 0;
+    // Drops happen while the ring is full, so they follow its last entry
+    lost = more ? 0 : dropped;
+    dropped -= lost;
+    critical_section_exit(&ring_lock);
+
+    print_entry(&entry);
+    if (lost > 0) {
+        printf("(%lu log messages dropped)\n\r", (unsigned long)lost);
+    }
+    return more ? TASK_YIELDED : TASK_WAITING;
+}
+
+/**
+ * @brief Set up the log ring and register the task that prints it.
+ */
+void log_init(void) {
+    critical_section_init(&ring_lock);
+    ring_head = 0;
+    ring_count = 0;
+    dropped = 0;
+    task_add(&log_task);
+}
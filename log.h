@@ -0,0 +1,112 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file log.h
+ * @brief Leveled logging with deferred formatting.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * A log call stores its call site and raw arguments in a ring and returns;
+ * a task on core0 formats and prints the entries later, between other work.
+ * Calls above SSM_LOG_LEVEL compile to nothing; their arguments are not
+ * evaluated.
+ *
+ * The format is printf's, with at most LOG_MAX_ARGS conversions and no '*'
+ * width or precision. A %s argument must point to a string that is never
+ * changed, such as a literal or a menu entry, as it is read when the entry
+ * is printed.
+ */
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define LOG_LEVEL_NONE (0)
+#define LOG_LEVEL_ERROR (1)
+#define LOG_LEVEL_WARN (2)
+#define LOG_LEVEL_INFO (3)
+#define LOG_LEVEL_DEBUG (4)
+
+#ifndef SSM_LOG_LEVEL
+#define SSM_LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// Most conversions in one format
+#define LOG_MAX_ARGS (8)
+
+/**
+ * @brief One log call site; its address identifies the message.
+ */
+typedef struct {
+    uint8_t level;
+    const char *format;
+} log_site;
+
+// Queue a message from a site defined in place; the dead printf only lets
+// the compiler check the arguments against the format
+#define LOG_AT(level, format, ...)                                  \
+    do {                                                            \
+        static const log_site log_site_ = { (level), (format) };    \
+        if (0) {                                                    \
+            printf(format, ##__VA_ARGS__);                          \
+        }                                                           \
+        log_write(&log_site_, ##__VA_ARGS__);                       \
+    } while (0)
+
+// A call compiled out; its arguments still count as used, but are never evaluated
+#define LOG_NONE(...)                                               \
+    do {                                                            \
+        if (0) {                                                    \
+            printf(__VA_ARGS__);                                    \
+        }                                                           \
+    } while (0)
+
+#if SSM_LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) LOG_NONE(__VA_ARGS__)
+#endif
+
+#if SSM_LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) LOG_AT(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) LOG_NONE(__VA_ARGS__)
+#endif
+
+#if SSM_LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) LOG_NONE(__VA_ARGS__)
+#endif
+
+#if SSM_LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) LOG_NONE(__VA_ARGS__)
+#endif
+
+/**
+ * @brief Set up the log ring and register the task that prints it.
+ */
+void log_init(void);
+
+/**
+ * @brief Queue a message; use the LOG_ macros instead.
+ *
+ * Safe from either core and from interrupt handlers. A full ring drops the
+ * message; the number dropped is printed once there is room again.
+ *
+ * @param site The call site.
+ * @param ...  The arguments of the site's format.
+ */
+void log_write(const log_site *site, ...);
+
+#endif // LOG_H
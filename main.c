@@ -15,6 +15,7 @@
  */
 #include <stdio.h>
 #include "pico/stdlib.h"
+#include "hardware/clocks.h"
 #include <stdlib.h>
 #include "spi_code.h"
 #include "i2c_code.h"
@@ -23,22 +24,44 @@
 #include "button.h"
 #include "user_interface.h"
 #include "mpu6050.h"
+#include "event.h"
+#include "sensor_core.h"
+#include "task.h"
+#include "profile.h"
+#include "trace.h"
+#include "log.h"
+#include "journal.h"
+#include "usb_link.h"
+#include "clock_profile.h"
 
 /**
  * @brief Main function for the SS Mapper application.
  *
  * This function initializes the serial port, I2C module, SPI module, OLED display,
  * MPU6050 sensor, buttons, and starts the user interface for the SS Mapper application.
- * The application then enters the main loop where it continuously checks for button
- * presses and updates the user interface accordingly.
+ * The application then enters the task scheduler, which runs the user interface and
+ * reporting tasks as button and timer events arrive.
  *
  * @return 0 upon successful execution.
  */
 int main() {
+    // Set the clock profile before any peripheral derives its timing from it
+    clock_profile_apply();
+
+    // Start the cycle counter used by the profiling probes on this core
+    profile_init();
+
     // Initialize chosen serial port
     stdio_init_all();
     printf(" !!!!!!!!!!!!!!!!!! SS Mapper started !!!!!!!!!!!!!!!!!!!\n");
 
+    // From here on messages are queued and printed by the log task
+    log_init();
+    LOG_INFO("clk_sys at %lu kHz\n\r", clock_get_hz(clk_sys) / 1000);
+
+    // Binary trace on its own UART; records queue until the drain task runs
+    trace_init();
+
     // Initialize I2C module
     I2C_Module_Init();
 
@@ -49,14 +72,28 @@ int main() {
     OLED_init();
     OLED_Clear();
 
-    // Reset MPU6050 sensor
+    // Reset MPU6050 sensor and set the gyroscope range used for sweeps
     resetMPU6050(i2c1);
+    configureMPU6050Gyro(i2c1);
+
+    // Start the event queue before the button interrupts can post to it
+    event_init();
 
     // Initialize buttons
     Button_Init();
 
-    // Start the user interface
-    user_interface();
+    // Find the end of the measurement journal in flash
+    journal_init();
+
+    // Serve journal and scan exports on the USB port
+    usb_link_init();
+
+    // Hand the sensors over to core1; from here on core0 only reads frames
+    sensor_core_start();
+
+    // Register the user interface tasks and run them; this never returns
+    user_interface_start();
+    task_run();
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,147 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file measure.c
+ * @brief Resumable capture sequences for the point-to-point measurements.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#include "measure.h"
+#include <stdio.h>
+#include "fixed_point.h"
+#include "button.h"
+#include "profile.h"
+#include "log.h"
+
+// Event ticks between distance readings on the capture screen (100 ms)
+#define CAPTURE_REFRESH_TICKS (100 / EVENT_TICK_MS)
+
+/**
+ * @brief Draw the title of the current step
+ */
+static void draw_step(const measure_session *m){
+    // Clear the previous title, which may be longer
+    Paint_DrawString_EN(0, 0, "                         ", &Font8, WHITE, BLACK);
+    if(m->plan->prompts != NULL){
+        Paint_DrawString_EN(0, 0, m->plan->prompts[m->step], &Font8, WHITE, BLACK);
+    }else{
+        Paint_DrawString_EN(0, 0, "Measuring at Corner:", &Font8, WHITE, BLACK);
+        Paint_DrawNum(112, 0, m->step + 1, &Font8, 0, WHITE, BLACK);
+    }
+}
+
+/**
+ * @brief Show the newest sensor frame on the capture screen
+ */
+static void draw_frame(measure_session *m, UBYTE *BlackImage){
+    sensor_latest(&m->frame);
+
+    // Display captured distance in both centimeters and feet
+    Paint_DrawString_EN(24, 36, "          ", &Font12, WHITE, BLACK);
+    Paint_DrawNum(24, 36, m->frame.distance, &Font12, 0, WHITE, BLACK);
+    Paint_DrawString_EN(76, 36, "          ", &Font12, WHITE, BLACK);
+    Paint_DrawNum(76, 36, fx_to_double(fx_cm_to_ft(m->frame.distance)), &Font12, 2, WHITE, BLACK);
+
+    // Display device orientation angles
+    Paint_DrawString_EN(21, 72, "          ", &Font12, WHITE, BLACK);
+    Paint_DrawNum(21, 72, m->frame.tilt[0], &Font12, 0, WHITE, BLACK);
+    Paint_DrawString_EN(21, 84, "          ", &Font12, WHITE, BLACK);
+    Paint_DrawNum(21, 84, m->frame.tilt[1], &Font12, 0, WHITE, BLACK);
+
+    // Update the OLED display
+    OLED_Display(BlackImage);
+}
+
+/**
+ * @brief Start a plan and draw its first capture screen.
+ *
+ * @param m          The session.
+ * @param plan       The plan.
+ * @param BlackImage Pointer to the image cache.
+ */
+void measure_start(measure_session *m, const measure_plan *plan, UBYTE *BlackImage){
+    m->plan = plan;
+    m->step = 0;
+    m->frame = (sensor_frame){0};
+    m->ticks = 0;
+
+    // Display distance-related information on the OLED screen
+    draw_step(m);
+    Paint_DrawString_EN(0, 12, "Distance:", &Font12, WHITE, BLACK);
+    Paint_DrawString_EN(24, 24, "cm", &Font12, WHITE, BLACK);
+    Paint_DrawString_EN(76, 24, "Feet", &Font12, WHITE, BLACK);
+    Paint_DrawString_EN(0, 60, "Device orientation:", &Font12, WHITE, BLACK);
+    Paint_DrawString_EN(0, 72, "X :", &Font12, WHITE, BLACK);
+    Paint_DrawString_EN(0, 84, "Y :", &Font12, WHITE, BLACK);
+    Paint_DrawString_EN(0, 120, "*Red:Read  Yellow:Undo", &Font8, WHITE, BLACK);
+    draw_frame(m, BlackImage);
+}
+
+/**
+ * @brief Advance the session with one event.
+ *
+ * Red stores the distance on screen and moves to the next step, Yellow goes
+ * back one step and a long Yellow press cancels. Ticks refresh the reading
+ * every CAPTURE_REFRESH_TICKS; core1 keeps sampling at its own rate.
+ *
+ * @param m          The session.
+ * @param e          The event.
+ * @param BlackImage Pointer to the image cache.
+ * @return Whether the plan is still running, complete or cancelled.
+ */
+measure_status measure_handle(measure_session *m, const event *e, UBYTE *BlackImage){
+    if(e->type == EVENT_BUTTON_LONG && e->data == GPIO10){
+        LOG_INFO("Measurement cancelled\n\r");
+        return MEASURE_CANCELLED;
+    }
+
+    if(e->type == EVENT_BUTTON_PRESS && e->data == GPIO11){
+        LOG_INFO("Captured distance %u cm for step %u\n\r", m->frame.distance, m->step + 1);
+        m->values[m->step++] = m->frame.distance;
+        if(m->step == m->plan->steps){
+            return MEASURE_DONE;
+        }
+        draw_step(m);
+        OLED_Display(BlackImage);
+        return MEASURE_RUNNING;
+    }
+
+    if(e->type == EVENT_BUTTON_PRESS && e->data == GPIO10){
+        // Yellow at the first step leaves the measurement like a cancel
+        if(m->step == 0){
+            LOG_INFO("Measurement cancelled\n\r");
+            return MEASURE_CANCELLED;
+        }
+        m->step--;
+        LOG_INFO("Undo, back to step %u\n\r", m->step + 1);
+        draw_step(m);
+        OLED_Display(BlackImage);
+        return MEASURE_RUNNING;
+    }
+
+    if(e->type == EVENT_TICK && ++m->ticks >= CAPTURE_REFRESH_TICKS){
+        m->ticks = 0;
+        draw_frame(m, BlackImage);
+    }
+    return MEASURE_RUNNING;
+}
+
+/**
+ * @brief Reduce the captured distances of a completed session.
+ *
+ * @param m The session.
+ * @return The result for the UI.
+ */
+double_array measure_result(const measure_session *m){
+    PROFILE_START(PROFILE_AREA);
+    double_array result = m->plan->reduce(m->values);
+    PROFILE_STOP(PROFILE_AREA);
+    return result;
+}
@@ -0,0 +1,100 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file measure.h
+ * @brief Resumable capture sequences for the point-to-point measurements.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * A measurement is described by a plan: the distances to capture, in order,
+ * and a reducer that turns them into the result. A session walks the plan
+ * one event at a time and never blocks, so the caller's loop keeps running
+ * between captures.
+ *
+ * On the capture screen Red reads the distance shown, Yellow takes back the
+ * last reading (or cancels at the first step) and holding Yellow cancels.
+ */
+#ifndef MEASURE_H
+#define MEASURE_H
+
+#include <stdint.h>
+#include "area.h"
+#include "event.h"
+#include "sensor_core.h"
+
+// Most distances any plan captures
+#define MEASURE_MAX_STEPS (12)
+
+/**
+ * @brief Turn the captured distances into the result.
+ *
+ * @param values The distances in centimeters, in plan order.
+ * @return The result for the UI.
+ */
+typedef double_array (*measure_reducer)(const uint16_t *values);
+
+/**
+ * @brief A shape and how to measure it.
+ */
+typedef struct measure_plan {
+    const char *shape;              // Menu entry that runs the plan
+    uint8_t steps;                  // Distances to capture
+    const char *const *prompts;     // Title of each step, or NULL to number corners
+    measure_reducer reduce;
+} measure_plan;
+
+/**
+ * @brief Outcome of handling one event.
+ */
+typedef enum {
+    MEASURE_RUNNING,
+    MEASURE_DONE,           // Every step captured; read measure_result()
+    MEASURE_CANCELLED,
+} measure_status;
+
+/**
+ * @brief Progress through one plan.
+ */
+typedef struct {
+    const measure_plan *plan;
+    uint8_t step;                       // Step being captured
+    uint16_t values[MEASURE_MAX_STEPS]; // Distances captured so far
+    sensor_frame frame;                 // Frame on screen, read by Red
+    uint8_t ticks;                      // Ticks since the screen was refreshed
+} measure_session;
+
+/**
+ * @brief Start a plan and draw its first capture screen.
+ *
+ * @param m          The session.
+ * @param plan       The plan.
+ * @param BlackImage Pointer to the image cache.
+ */
+void measure_start(measure_session *m, const measure_plan *plan, UBYTE *BlackImage);
+
+/**
+ * @brief Advance the session with one event.
+ *
+ * @param m          The session.
+ * @param e          The event.
+ * @param BlackImage Pointer to the image cache.
+ * @return Whether the plan is still running, complete or cancelled.
+ */
+measure_status measure_handle(measure_session *m, const event *e, UBYTE *BlackImage);
+
+/**
+ * @brief Reduce the captured distances of a completed session.
+ *
+ * @param m The session.
+ * @return The result for the UI.
+ */
+double_array measure_result(const measure_session *m);
+
+#endif // MEASURE_H
@@ -24,8 +24,16 @@
 
 /**
  * @brief Y-coordinate for the start position of shapes in the menu.
+ *
+ * The rule under the title uses Font8 so that eight entries fit above the
+ * instruction line.
  */
-#define SHAPES_START_Y (35)
+#define SHAPES_START_Y (24)
+
+/**
+ * @brief Y-coordinate of the rule under the menu title.
+ */
+#define RULE_Y (16)
 
 /**
  * @brief X-coordinate for the start position of the cursor in the menu.
@@ -35,12 +43,18 @@
 /**
  * @brief Array of strings representing different shapes.
  */
-char shapes[][16] = {"Distance", "Circle", "Rectangle", "Triangle", "Irregular menu"};
+char shapes[][16] = {"Distance", "Circle", "Rectangle", "Triangle", "Irregular menu", "Sweep", "Map", "History"};
 
 /**
  * @brief Array of strings representing shapes in the irregular menu.
  */
-char irr_shapes[][16] = {"shape1", "shape2", "shape3", "shape4", "shape5"};
+char irr_shapes[][16] = {"shape1", "shape2", "shape3", "shape4", "shape5", "walls"};
+
+/**
+ * @brief Number of entries in each shape array, for code outside this file.
+ */
+const uint8_t shapes_count = sizeof(shapes) / sizeof(shapes[0]);
+const uint8_t irr_shapes_count = sizeof(irr_shapes) / sizeof(irr_shapes[0]);
 
 /**
  * @brief Cursor position in the main menu.
@@ -70,7 +84,7 @@ void menu(UBYTE *BlackImage) {
 
     // Display the application name
     Paint_DrawString_EN(10, 0, "SS Mapper", &Font16, WHITE, BLACK);
-    Paint_DrawString_EN(0, 18, "-------------------", &Font12, WHITE, BLACK);
+    Paint_DrawString_EN(0, RULE_Y, "-------------------------", &Font8, WHITE, BLACK);
 
     // Display shapes with checkboxes
     for (int i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i++) {
@@ -81,9 +95,8 @@ void menu(UBYTE *BlackImage) {
     // Display cursor for shape selection
     Paint_DrawString_EN(CURSOR_START_X + 8, SHAPES_START_Y + (cursor_pos * Font12.Height), "+", &Font12, WHITE, BLACK);
 
-    // Display navigation instructions
-    Paint_DrawString_EN(0, 112, "*Press Yellow to Navigate", &Font8, WHITE, BLACK);
-    Paint_DrawString_EN(0, 120, "*Press Red to select", &Font8, WHITE, BLACK);
+    // Display navigation instructions; one line leaves room for eight shapes
+    Paint_DrawString_EN(0, 120, "*Yellow:Next  Red:Select", &Font8, WHITE, BLACK);
 
     // Update the OLED display
     OLED_Display(BlackImage);
@@ -186,7 +199,7 @@ void irr_menu(UBYTE *BlackImage) {
 
     // Display the title
     Paint_DrawString_EN(10, 0, "SS Mapper", &Font16, WHITE, BLACK);
-    Paint_DrawString_EN(0, 18, "-------------------", &Font12, WHITE, BLACK);
+    Paint_DrawString_EN(0, RULE_Y, "-------------------------", &Font8, WHITE, BLACK);
 
     // Display shapes and cursor in the irregular menu
     for (int i = 0; i < sizeof(irr_shapes) / sizeof(irr_shapes[0]); i++) {
@@ -22,6 +22,10 @@
 extern char shapes[][SHAPE_NAME_MAX_LENGTH];
 extern char irr_shapes[][SHAPE_NAME_MAX_LENGTH];
 
+// Number of entries in each shape array
+extern const uint8_t shapes_count;
+extern const uint8_t irr_shapes_count;
+
 // Function declarations
 
 /**
@@ -0,0 +1,153 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file mirror.c
+ * @brief Mirror of the OLED framebuffer to the host over the USB link.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#include "mirror.h"
+
+#if SSM_MIRROR
+#include <string.h>
+#include "pico/stdlib.h"
+#include "oled.h"
+#include "fb_delta.h"
+
+#define MIRROR_ROW_BYTES (OLED_IMAGE_SIZE / OLED_HEIGHT)
+
+// Packet number, offset and total ahead of the packet bytes in a frame
+#define MIRROR_CHUNK_HEADER (6)
+
+#define MIRROR_PACKET_MAX (sizeof(fb_delta_header) + FB_DELTA_MAX(OLED_IMAGE_SIZE))
+
+static uint8_t screen[OLED_IMAGE_SIZE];     // What the OLED shows
+static uint8_t host[OLED_IMAGE_SIZE];       // What the host has once the packet in flight arrives
+static uint8_t packet[MIRROR_PACKET_MAX];
+static uint16_t packet_length;
+static uint16_t packet_sent;                // Bytes of the packet in frames already
+static uint16_t packet_number;
+static uint16_t dirty_first;                // Rows changed since the last packet
+static uint16_t dirty_end;
+static uint16_t updates;                    // OLED updates since the last packet
+static uint32_t update_time_us;             // Time of the newest of them
+static bool enabled;
+static bool keyframe;                       // The next packet starts from a blank image
+
+/**
+ * @brief Note an OLED update.
+ *
+ * The screen copy is kept even while the mirror is off, so enabling it
+ * can send what is on the OLED at once.
+ *
+ * @param image The framebuffer.
+ * @param first First row sent to the OLED.
+ * @param end   Row after the last one sent.
+ */
+void mirror_rows(const uint8_t *image, uint16_t first, uint16_t end) {
+    if (first >= end) {
+        return;
+    }
+    memcpy(&screen[first * MIRROR_ROW_BYTES], &image[first * MIRROR_ROW_BYTES],
+           (end - first) * MIRROR_ROW_BYTES);
+    if (!enabled) {
+        return;
+    }
+    if (first < dirty_first) {
+        dirty_first = first;
+    }
+    if (end > dirty_end) {
+        dirty_end = end;
+    }
+    updates++;
+    update_time_us = time_us_32();
+}
+
+/**
+ * @brief Start or stop mirroring; starting sends the whole screen first.
+ *
+ * @param on Whether to mirror.
+ */
+void mirror_enable(bool on) {
+    enabled = on;
+    packet_length = 0;
+    packet_sent = 0;
+    if (on) {
+        memset(host, 0, sizeof(host));
+        dirty_first = 0;
+        dirty_end = OLED_HEIGHT;
+        updates = 0;
+        update_time_us = time_us_32();
+        keyframe = true;
+    }
+}
+
+/**
+ * @brief Encode the rows changed since the last packet.
+ */
+static void build_packet(void) {
+    size_t offset = dirty_first * MIRROR_ROW_BYTES;
+    size_t length = (dirty_end - dirty_first) * MIRROR_ROW_BYTES;
+    fb_delta_header header = {
+        .time_us = update_time_us,
+        .updates = updates,
+        .row_bytes = MIRROR_ROW_BYTES,
+        .height = OLED_HEIGHT,
+        .first_row = (uint8_t)dirty_first,
+        .rows = (uint8_t)(dirty_end - dirty_first),
+        .flags = keyframe ? FB_DELTA_KEYFRAME : 0,
+    };
+
+    memcpy(packet, &header, sizeof(header));
+    packet_length = (uint16_t)(sizeof(header) +
+                               fb_delta_encode(&screen[offset], &host[offset], length, packet + sizeof(header)));
+    memcpy(&host[offset], &screen[offset], length);
+    packet_sent = 0;
+    packet_number++;
+    dirty_first = OLED_HEIGHT;
+    dirty_end = 0;
+    updates = 0;
+    keyframe = false;
+}
+
+/**
+ * @brief Take the next FRAME_MIRROR data to send.
+ *
+ * @param out      Output data.
+ * @param capacity Bytes available in out.
+ * @return Bytes written, or 0 if nothing is waiting.
+ */
+size_t mirror_chunk(uint8_t *out, size_t capacity) {
+    if (!mirror_pending() || capacity <= MIRROR_CHUNK_HEADER) {
+        return 0;
+    }
+    if (packet_sent == packet_length) {
+        build_packet();
+    }
+
+    size_t count = packet_length - packet_sent;
+    if (count > capacity - MIRROR_CHUNK_HEADER) {
+        count = capacity - MIRROR_CHUNK_HEADER;
+    }
+    memcpy(out, &packet_number, 2);
+    memcpy(out + 2, &packet_sent, 2);
+    memcpy(out + 4, &packet_length, 2);
+    memcpy(out + MIRROR_CHUNK_HEADER, &packet[packet_sent], count);
+    packet_sent += count;
+    return MIRROR_CHUNK_HEADER + count;
+}
+
+/**
+ * @brief Whether mirror_chunk() has something to send.
+ */
+bool mirror_pending(void) {
+    return enabled && (packet_sent < packet_length || dirty_first < dirty_end);
+}
+#endif // SSM_MIRROR
@@ -0,0 +1,75 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file mirror.h
+ * @brief Mirror of the OLED framebuffer to the host over the USB link.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Every OLED update is copied aside; while a host has the mirror enabled,
+ * the USB task sends the rows that changed as fb_delta.h packets in
+ * FRAME_MIRROR frames. Updates made while a packet is still in flight are
+ * folded into the next one, so a slow host sees fewer frames but never a
+ * wrong one. tools/ssm_mirror rebuilds the frames.
+ *
+ * The mirror compiles to nothing unless SSM_MIRROR is set to 1.
+ */
+#ifndef MIRROR_H
+#define MIRROR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef SSM_MIRROR
+#define SSM_MIRROR 0
+#endif
+
+#if SSM_MIRROR
+#define MIRROR_ROWS(image, first, end) mirror_rows((image), (first), (end))
+
+/**
+ * @brief Note an OLED update.
+ *
+ * @param image The framebuffer.
+ * @param first First row sent to the OLED.
+ * @param end   Row after the last one sent.
+ */
+void mirror_rows(const uint8_t *image, uint16_t first, uint16_t end);
+
+/**
+ * @brief Start or stop mirroring; starting sends the whole screen first.
+ *
+ * @param on Whether to mirror.
+ */
+void mirror_enable(bool on);
+
+/**
+ * @brief Take the next FRAME_MIRROR data to send.
+ *
+ * @param out      Output data.
+ * @param capacity Bytes available in out.
+ * @return Bytes written, or 0 if nothing is waiting.
+ */
+size_t mirror_chunk(uint8_t *out, size_t capacity);
+
+/**
+ * @brief Whether mirror_chunk() has something to send.
+ */
+bool mirror_pending(void);
+#else
+#define MIRROR_ROWS(image, first, end) do {} while (0)
+
+static inline void mirror_enable(bool on) { (void)on; }
+static inline size_t mirror_chunk(uint8_t *out, size_t capacity) { (void)out; (void)capacity; return 0; }
+static inline bool mirror_pending(void) { return false; }
+#endif
+
+#endif // MIRROR_H
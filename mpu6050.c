@@ -16,11 +16,22 @@
 #include "mpu6050.h"
 #include "stdint.h"
 #include "math.h"
-#include <stdio.h>
+#include "profile.h"
+#include "trace.h"
 
 // MPU6050 I2C address
 #define MPU6050_ADDRESS (0x68)
 
+// Gyroscope configuration register and the +-500 deg/s full-scale setting
+#define GYRO_CONFIG_REG (0x1B)
+#define GYRO_FS_500_DPS (0x08)
+
+// Start of the gyroscope output registers (X, Y, Z high/low bytes)
+#define GYRO_XOUT_H_REG (0x43)
+
+// Sensitivity at +-500 deg/s is 65.5 LSB per deg/s, i.e. 131 LSB per 2 deg/s
+#define GYRO_LSB_PER_2_DPS (131)
+
 /**
  * @brief Resets the MPU6050 device.
  *
@@ -37,6 +48,22 @@ void resetMPU6050(i2c_inst_t *i2c) {
 }
 
 
+/**
+ * @brief Configures the MPU6050 gyroscope range.
+ *
+ * This function selects the +-500 deg/s full-scale range, which covers a
+ * device being turned by hand without saturating.
+ *
+ * @param i2c The I2C instance to use for communication.
+ */
+void configureMPU6050Gyro(i2c_inst_t *i2c) {
+    // Data to send for the gyroscope configuration
+    uint8_t configData[] = {GYRO_CONFIG_REG, GYRO_FS_500_DPS};
+
+    // Write the configuration to the MPU6050 device
+    i2c_write_blocking(i2c, MPU6050_ADDRESS, configData, sizeof(configData), false);
+}
+
 /**
  * @brief Reads accelerometer data from the MPU6050 device.
  *
@@ -46,6 +73,9 @@ void resetMPU6050(i2c_inst_t *i2c) {
  * @param accel An array to store the accelerometer data [X, Y, Z].
  */
 void readAccelData(i2c_inst_t *i2c, int16_t accel[3]) {
+    PROFILE_START(PROFILE_READ_ACCEL);
+    TRACE_SPAN_BEGIN(TRACE_I2C, MPU6050_ADDRESS);
+
     // Buffer to store raw accelerometer data
     uint8_t buffer[6];
     
@@ -62,6 +92,55 @@ void readAccelData(i2c_inst_t *i2c, int16_t accel[3]) {
     for (int i = 0; i < 3; i++) {
         accel[i] = (buffer[i * 2] << 8 | buffer[(i * 2) + 1]);
     }
+    TRACE_SPAN_END(TRACE_I2C);
+    PROFILE_STOP(PROFILE_READ_ACCEL);
+}
+
+/**
+ * @brief Reads gyroscope data from the MPU6050 device.
+ *
+ * This function reads the raw angular rate for all three axes over I2C.
+ *
+ * @param i2c The I2C instance to use for communication.
+ * @param gyro An array to store the gyroscope data [X, Y, Z].
+ */
+void readGyroData(i2c_inst_t *i2c, int16_t gyro[3]) {
+    TRACE_SPAN_BEGIN(TRACE_I2C, MPU6050_ADDRESS);
+
+    // Buffer to store raw gyroscope data
+    uint8_t buffer[6];
+
+    // Register address for gyroscope data
+    uint8_t regAddress = GYRO_XOUT_H_REG;
+
+    // Write the register address to initiate reading
+    i2c_write_blocking(i2c, MPU6050_ADDRESS, &regAddress, 1, true);
+
+    // Read gyroscope data from the MPU6050 device
+    i2c_read_blocking(i2c, MPU6050_ADDRESS, buffer, sizeof(buffer), false);
+
+    // Combine high and low bytes for each axis and store in the gyro array
+    for (int i = 0; i < 3; i++) {
+        gyro[i] = (buffer[i * 2] << 8 | buffer[(i * 2) + 1]);
+    }
+    TRACE_SPAN_END(TRACE_I2C);
+}
+
+/**
+ * @brief Reads the yaw rate of the device.
+ *
+ * The yaw axis is the sensor Z axis when the device is held level.
+ *
+ * @return The yaw rate in hundredths of a degree per second.
+ */
+int32_t read_yaw_rate() {
+    int16_t gyro[3];
+
+    // Read gyroscope data from the MPU6050 device
+    readGyroData(i2c1, gyro);
+
+    // Scale raw counts to hundredths of a degree per second
+    return ((int32_t)gyro[2] * 200) / GYRO_LSB_PER_2_DPS;
 }
 
 /**
@@ -81,7 +160,7 @@ float calculate_tilt_angle(int16_t accel_value) {
  * @brief Reads accelerometer data and calculates tilt angles.
  *
  * This function reads accelerometer data from the MPU6050 device, calculates tilt
- * angles for each axis, and prints the results.
+ * angles for each axis, and records the X and Y angles in the trace.
  *
  * @param acceleration An array to store the accelerometer data [X, Y, Z].
  */
@@ -94,6 +173,6 @@ void read_tilt_angle(int16_t acceleration[3]){
     acceleration[1] = (int16_t)calculate_tilt_angle(acceleration[1]) * 2;
     acceleration[2] = (int16_t)calculate_tilt_angle(acceleration[2]) * 2;
 
-    // Print the calculated tilt angles for X and Y axes
-    printf("Acc. X = %d, Y = %d\n", acceleration[0], acceleration[1]);
+    TRACE_COUNTER_VALUE(TRACE_TILT_X, acceleration[0]);
+    TRACE_COUNTER_VALUE(TRACE_TILT_Y, acceleration[1]);
 }
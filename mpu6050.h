@@ -24,6 +24,15 @@
  */
 void resetMPU6050(i2c_inst_t *i2c);
 
+/**
+ * @brief Configures the MPU6050 gyroscope range.
+ *
+ * This function selects the +-500 deg/s full-scale range used for yaw tracking.
+ *
+ * @param i2c The I2C instance to use for communication.
+ */
+void configureMPU6050Gyro(i2c_inst_t *i2c);
+
 /**
  * @brief Reads accelerometer data from the MPU6050.
  *
@@ -34,6 +43,23 @@ void resetMPU6050(i2c_inst_t *i2c);
  */
 void readAccelData(i2c_inst_t *i2c, int16_t accel[]);
 
+/**
+ * @brief Reads gyroscope data from the MPU6050.
+ *
+ * This function reads raw gyroscope data from the MPU6050 and stores it in the provided array.
+ *
+ * @param i2c The I2C instance to use for communication.
+ * @param gyro An array to store the X, Y, and Z-axis angular rates.
+ */
+void readGyroData(i2c_inst_t *i2c, int16_t gyro[]);
+
+/**
+ * @brief Reads the yaw rate of the device.
+ *
+ * @return The yaw rate around the Z axis in hundredths of a degree per second.
+ */
+int32_t read_yaw_rate();
+
 /**
  * @brief Calculates the tilt angle from accelerometer value.
  *
@@ -0,0 +1,376 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file occupancy.c
+ * @brief Log-odds occupancy grid built from sweeps at several positions.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#include "occupancy.h"
+#include <string.h>
+
+// Both nibbles of a byte set to unknown
+#define OCC_UNKNOWN_BYTE ((OCC_UNKNOWN << 4) | OCC_UNKNOWN)
+
+_Static_assert(sizeof(occ_pose) == 3 * sizeof(int32_t), "poses are exported as stored");
+
+// Passes of occ_matcher
+#define OCC_PASS_COARSE (0)
+#define OCC_PASS_FINE (1)
+#define OCC_PASS_DONE (2)
+
+// Sweep points in centimeters relative to the device, sweep start along +X
+static int32_t local_x[SWEEP_MAX_POINTS];
+static int32_t local_y[SWEEP_MAX_POINTS];
+
+// Sweep points in cells for the heading being scored
+static int32_t cell_x[SWEEP_MAX_POINTS];
+static int32_t cell_y[SWEEP_MAX_POINTS];
+
+/**
+ * @brief Grid column or row of a map coordinate.
+ *
+ * Rounds toward minus infinity so cells do not double up around zero.
+ */
+static int32_t to_cell(int32_t cm) {
+    int32_t cell = (cm >= 0) ? cm / OCC_CELL_CM : -((-cm + OCC_CELL_CM - 1) / OCC_CELL_CM);
+    return cell + OCC_GRID_SIZE / 2;
+}
+
+/**
+ * @brief Write one cell; cells outside the grid are ignored.
+ */
+static void occ_set(occ_map *map, int32_t gx, int32_t gy, uint8_t value) {
+    if (gx < 0 || gy < 0 || gx >= OCC_GRID_SIZE || gy >= OCC_GRID_SIZE) {
+        return;
+    }
+    uint32_t index = (uint32_t)gy * OCC_GRID_SIZE + gx;
+    uint8_t *byte = &map->cells[index / 2];
+    if (index & 1) {
+        *byte = (*byte & 0x0F) | (value << 4);
+    } else {
+        *byte = (*byte & 0xF0) | value;
+    }
+}
+
+/**
+ * @brief Add a log-odds step to a cell, saturating at 0 and OCC_MAX.
+ */
+static void occ_update(occ_map *map, int32_t gx, int32_t gy, int8_t step) {
+    int16_t value = occ_get(map, gx, gy) + step;
+    if (value < 0) {
+        value = 0;
+    } else if (value > OCC_MAX) {
+        value = OCC_MAX;
+    }
+    occ_set(map, gx, gy, (uint8_t)value);
+}
+
+/**
+ * @brief Match score contributed by one cell.
+ *
+ * The log-odds relative to unknown: returns on occupied cells raise the
+ * score, returns inside known free space lower it.
+ */
+static int32_t cell_score(const occ_map *map, int32_t gx, int32_t gy) {
+    return (int32_t)occ_get(map, gx, gy) - OCC_UNKNOWN;
+}
+
+/**
+ * @brief Load the sweep points into local centimeter coordinates.
+ */
+static void load_points(const sweep_scan *scan) {
+    for (uint16_t i = 0; i < scan->count; i++) {
+        int32_t x, y;
+        sweep_point_xy(sweep_point_at(scan, i), &x, &y);
+        local_x[i] = (x + (x >= 0 ? FX_SCALE / 2 : -FX_SCALE / 2)) / FX_SCALE;
+        local_y[i] = (y + (y >= 0 ? FX_SCALE / 2 : -FX_SCALE / 2)) / FX_SCALE;
+    }
+}
+
+/**
+ * @brief Place the loaded points in cells for a device pose.
+ */
+static void project_points(uint16_t count, int32_t x, int32_t y, int32_t heading) {
+    int64_t c = fx_cos(heading);
+    int64_t s = fx_sin(heading);
+    for (uint16_t i = 0; i < count; i++) {
+        int32_t wx = (int32_t)((local_x[i] * c - local_y[i] * s) / FX_TRIG_ONE);
+        int32_t wy = (int32_t)((local_x[i] * s + local_y[i] * c) / FX_TRIG_ONE);
+        cell_x[i] = to_cell(x + wx);
+        cell_y[i] = to_cell(y + wy);
+    }
+}
+
+/**
+ * @brief Score the projected points shifted by a whole number of cells.
+ */
+static int32_t score_shift(const occ_map *map, uint16_t count, uint16_t stride, int32_t dx, int32_t dy) {
+    int32_t score = 0;
+    for (uint16_t i = 0; i < count; i += stride) {
+        score += cell_score(map, cell_x[i] + dx, cell_y[i] + dy);
+    }
+    return score;
+}
+
+/**
+ * @brief Clear the map to unknown.
+ *
+ * @param map The map.
+ */
+void occ_init(occ_map *map) {
+    memset(map->cells, OCC_UNKNOWN_BYTE, sizeof(map->cells));
+    map->pose_count = 0;
+}
+
+/**
+ * @brief Read one cell.
+ *
+ * @param map The map.
+ * @param gx  Column, 0 at the left edge.
+ * @param gy  Row, 0 at the bottom edge.
+ * @return The log-odds nibble, OCC_UNKNOWN outside the grid.
+ */
+uint8_t occ_get(const occ_map *map, int32_t gx, int32_t gy) {
+    if (gx < 0 || gy < 0 || gx >= OCC_GRID_SIZE || gy >= OCC_GRID_SIZE) {
+        return OCC_UNKNOWN;
+    }
+    uint32_t index = (uint32_t)gy * OCC_GRID_SIZE + gx;
+    uint8_t byte = map->cells[index / 2];
+    return (index & 1) ? (byte >> 4) : (byte & 0x0F);
+}
+
+/**
+ * @brief Align a sweep to the map with a correlative search.
+ *
+ * Rotating the points is the expensive part, so it is done once per
+ * candidate heading; translations are then whole-cell shifts of the
+ * projected points and cost one grid lookup per point.
+ *
+ * @param map  The map, with at least one sweep added.
+ * @param scan The new sweep.
+ * @return The best pose and its score.
+ */
+occ_match occ_match_scan(const occ_map *map, const sweep_scan *scan) {
+    occ_matcher matcher;
+
+    occ_match_begin(&matcher, map, scan);
+    while (!occ_match_step(&matcher, map)) {
+    }
+    return matcher.match;
+}
+
+/**
+ * @brief Start aligning a sweep to the map, to be run by occ_match_step().
+ *
+ * @param matcher The search state.
+ * @param map     The map, with at least one sweep added.
+ * @param scan    The new sweep.
+ */
+void occ_match_begin(occ_matcher *matcher, const occ_map *map, const sweep_scan *scan) {
+    memset(matcher, 0, sizeof(*matcher));
+    matcher->count = scan->count;
+    matcher->pass = OCC_PASS_DONE;
+    if (map->pose_count > 0) {
+        matcher->match.pose = map->poses[map->pose_count - 1];
+    }
+    if (matcher->count == 0 || map->pose_count == 0) {
+        return;
+    }
+    load_points(scan);
+
+    // Coarse pass: every heading step and every cell shift on a point subset
+    matcher->pass = OCC_PASS_COARSE;
+    matcher->centre = matcher->match.pose;
+    matcher->best = INT32_MIN;
+    matcher->turn = -OCC_SEARCH_ANGLE;
+    matcher->dy = -OCC_SEARCH_CELLS;
+}
+
+/**
+ * @brief Search one row of cell shifts.
+ *
+ * The points are projected again at the first row of every heading, since
+ * that is the only time the heading changes.
+ *
+ * @param matcher The search state.
+ * @param map     The map passed to occ_match_begin().
+ * @return true once the search is done and matcher->match holds the result.
+ */
+bool occ_match_step(occ_matcher *matcher, const occ_map *map) {
+    if (matcher->pass == OCC_PASS_DONE) {
+        return true;
+    }
+    bool coarse = (matcher->pass == OCC_PASS_COARSE);
+    int32_t reach = coarse ? OCC_SEARCH_CELLS : 1;
+    int32_t turn_limit = coarse ? OCC_SEARCH_ANGLE : OCC_COARSE_ANGLE_STEP;
+    const occ_pose *centre = &matcher->centre;
+
+    if (matcher->dy == -reach) {
+        project_points(matcher->count, centre->x, centre->y, centre->heading + matcher->turn);
+    }
+    for (int32_t dx = -reach; dx <= reach; dx++) {
+        int32_t score = score_shift(map, matcher->count, coarse ? OCC_COARSE_DECIMATION : 1, dx, matcher->dy);
+        if (score > matcher->best) {
+            matcher->best = score;
+            matcher->match.pose.x = centre->x + dx * OCC_CELL_CM;
+            matcher->match.pose.y = centre->y + matcher->dy * OCC_CELL_CM;
+            matcher->match.pose.heading = centre->heading + matcher->turn;
+        }
+    }
+
+    if (++matcher->dy <= reach) {
+        return false;
+    }
+    matcher->dy = -reach;
+    matcher->turn += coarse ? OCC_COARSE_ANGLE_STEP : OCC_FINE_ANGLE_STEP;
+    if (matcher->turn <= turn_limit) {
+        return false;
+    }
+
+    if (coarse) {
+        // Fine pass: all points, finer headings and one cell around the coarse pose
+        matcher->pass = OCC_PASS_FINE;
+        matcher->centre = matcher->match.pose;
+        matcher->best = INT32_MIN;
+        matcher->turn = -OCC_COARSE_ANGLE_STEP;
+        matcher->dy = -1;
+        return false;
+    }
+    matcher->match.score = matcher->best;
+    matcher->match.points = matcher->count;
+    matcher->pass = OCC_PASS_DONE;
+    return true;
+}
+
+/**
+ * @brief Ray-trace a sweep into the map.
+ *
+ * Each beam is walked with Bresenham's line algorithm from the device cell
+ * to the return cell.
+ *
+ * @param map  The map.
+ * @param scan The sweep.
+ * @param pose Position of the device during the sweep.
+ * @return false if the map already holds OCC_MAX_POSES sweeps.
+ */
+bool occ_add_scan(occ_map *map, const sweep_scan *scan, const occ_pose *pose) {
+    if (map->pose_count >= OCC_MAX_POSES) {
+        return false;
+    }
+    map->poses[map->pose_count++] = *pose;
+
+    load_points(scan);
+    project_points(scan->count, pose->x, pose->y, pose->heading);
+
+    int32_t x0 = to_cell(pose->x);
+    int32_t y0 = to_cell(pose->y);
+    for (uint16_t i = 0; i < scan->count; i++) {
+        int32_t x1 = cell_x[i], y1 = cell_y[i];
+        int32_t dx = (x1 > x0) ? x1 - x0 : x0 - x1;
+        int32_t dy = (y1 > y0) ? y0 - y1 : y1 - y0;
+        int32_t sx = (x0 < x1) ? 1 : -1;
+        int32_t sy = (y0 < y1) ? 1 : -1;
+        int32_t err = dx + dy;
+        int32_t x = x0, y = y0;
+
+        while (x != x1 || y != y1) {
+            // Leave the cells next to the return alone so beams grazing a
+            // wall do not erase it
+            int32_t left_x = (x > x1) ? x - x1 : x1 - x;
+            int32_t left_y = (y > y1) ? y - y1 : y1 - y;
+            if (left_x > 1 || left_y > 1) {
+                occ_update(map, x, y, -OCC_MISS);
+            }
+            int32_t e2 = 2 * err;
+            if (e2 >= dy) {
+                err += dy;
+                x += sx;
+            }
+            if (e2 <= dx) {
+                err += dx;
+                y += sy;
+            }
+        }
+        occ_update(map, x1, y1, OCC_HIT);
+    }
+    return true;
+}
+
+/**
+ * @brief Explored floor area.
+ *
+ * @param map The map.
+ * @return Area of the free cells in hundredths of a square centimeter.
+ */
+fx_area_t occ_free_area(const occ_map *map) {
+    uint32_t free_cells = 0;
+    for (int32_t gy = 0; gy < OCC_GRID_SIZE; gy++) {
+        for (int32_t gx = 0; gx < OCC_GRID_SIZE; gx++) {
+            if (occ_get(map, gx, gy) <= OCC_FREE) {
+                free_cells++;
+            }
+        }
+    }
+    return fx_area_product(free_cells, OCC_CELL_CM * OCC_CELL_CM);
+}
+
+/**
+ * @brief Size of the map in its export form.
+ *
+ * @param map The map.
+ * @return Bytes in the export form.
+ */
+uint32_t occ_export_size(const occ_map *map) {
+    return OCC_EXPORT_HEADER + map->pose_count * sizeof(occ_pose) + sizeof(map->cells);
+}
+
+/**
+ * @brief Read part of the map in its export form.
+ *
+ * The header and poses are built on the fly; the cells are copied as
+ * stored.
+ *
+ * @param map    The map.
+ * @param offset First byte to read.
+ * @param out    Output of count bytes.
+ * @param count  Bytes to read.
+ * @return Bytes read, fewer than count at the end of the export form.
+ */
+size_t occ_export_read(const occ_map *map, uint32_t offset, uint8_t *out, size_t count) {
+    uint32_t head_size = OCC_EXPORT_HEADER + map->pose_count * sizeof(occ_pose);
+    uint32_t total = head_size + sizeof(map->cells);
+    size_t n = 0;
+
+    if (offset >= total) {
+        return 0;
+    }
+    if (count > total - offset) {
+        count = total - offset;
+    }
+    if (offset < head_size) {
+        uint8_t head[OCC_EXPORT_HEADER + sizeof(map->poses)];
+        head[0] = (uint8_t)OCC_GRID_SIZE;
+        head[1] = (uint8_t)(OCC_GRID_SIZE >> 8);
+        head[2] = OCC_CELL_CM;
+        head[3] = map->pose_count;
+        memcpy(head + OCC_EXPORT_HEADER, map->poses, map->pose_count * sizeof(occ_pose));
+
+        n = head_size - offset;
+        if (n > count) {
+            n = count;
+        }
+        memcpy(out, head + offset, n);
+    }
+    if (n < count) {
+        memcpy(out + n, &map->cells[offset + n - head_size], count - n);
+    }
+    return count;
+}
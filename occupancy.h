@@ -0,0 +1,206 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file occupancy.h
+ * @brief Log-odds occupancy grid built from sweeps at several positions.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#ifndef OCCUPANCY_H
+#define OCCUPANCY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "fixed_point.h"
+#include "sweep.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Grid side in cells; one nibble per cell keeps the grid at 32 KB of SRAM
+#define OCC_GRID_SIZE (256)
+
+// Cell side in centimeters; the grid covers 12.8 m x 12.8 m
+#define OCC_CELL_CM (5)
+
+// Log-odds nibble: 0 is certainly free, 15 certainly occupied
+#define OCC_UNKNOWN (8)
+#define OCC_MAX (15)
+
+// Log-odds steps for a LiDAR return in a cell and for a beam passing through
+#define OCC_HIT (3)
+#define OCC_MISS (1)
+
+// Cells at or above this value count as occupied, at or below OCC_FREE as free
+#define OCC_OCCUPIED (11)
+#define OCC_FREE (5)
+
+// Maximum number of sweep positions kept in one map
+#define OCC_MAX_POSES (16)
+
+// Correlative matcher search window around the previous position
+#define OCC_SEARCH_CELLS (20)                   // +-1 m in translation
+#define OCC_SEARCH_ANGLE (10 * FX_DEGREE)       // +-10 degrees in heading
+#define OCC_COARSE_ANGLE_STEP (FX_DEGREE)
+#define OCC_FINE_ANGLE_STEP (FX_DEGREE / 4)
+
+// Every n-th point is scored in the coarse pass
+#define OCC_COARSE_DECIMATION (4)
+
+// Bytes of the export form before the poses
+#define OCC_EXPORT_HEADER (4)
+
+/**
+ * @brief Position and heading of the device for one sweep.
+ */
+typedef struct {
+    int32_t x;          // X in centimeters from the first sweep position
+    int32_t y;          // Y in centimeters from the first sweep position
+    int32_t heading;    // Heading in hundredths of a degree
+} occ_pose;
+
+/**
+ * @brief Occupancy grid and the positions it was built from.
+ */
+typedef struct {
+    uint8_t cells[OCC_GRID_SIZE * OCC_GRID_SIZE / 2];  // Two cells per byte, low nibble first
+    occ_pose poses[OCC_MAX_POSES];
+    uint8_t pose_count;
+} occ_map;
+
+/**
+ * @brief Result of aligning a sweep to the map.
+ */
+typedef struct {
+    occ_pose pose;      // Best position of the sweep in the map
+    int32_t score;      // Summed log-odds under the sweep points at that pose
+    uint16_t points;    // Number of points scored
+} occ_match;
+
+/**
+ * @brief A correlative search in progress, stepped one row of shifts at a time.
+ */
+typedef struct {
+    occ_match match;    // Best pose so far; the result once done
+    occ_pose centre;    // Pose the current pass searches around
+    int32_t best;       // Score of match.pose
+    int32_t turn;       // Heading offset being searched
+    int32_t dy;         // Row of shifts being searched
+    uint16_t count;     // Points in the sweep
+    uint8_t pass;       // Coarse, fine or done
+} occ_matcher;
+
+/**
+ * @brief Clear the map to unknown.
+ *
+ * @param map The map.
+ */
+void occ_init(occ_map *map);
+
+/**
+ * @brief Read one cell.
+ *
+ * @param map The map.
+ * @param gx  Column, 0 at the left edge.
+ * @param gy  Row, 0 at the bottom edge.
+ * @return The log-odds nibble, OCC_UNKNOWN outside the grid.
+ */
+uint8_t occ_get(const occ_map *map, int32_t gx, int32_t gy);
+
+/**
+ * @brief Align a sweep to the map with a correlative search.
+ *
+ * Searches +-OCC_SEARCH_CELLS and +-OCC_SEARCH_ANGLE around the last
+ * sweep position, first coarsely on a subset of points, then refining the
+ * heading around the best coarse pose on all points.
+ *
+ * @param map  The map, with at least one sweep added.
+ * @param scan The new sweep.
+ * @return The best pose and its score.
+ */
+occ_match occ_match_scan(const occ_map *map, const sweep_scan *scan);
+
+/**
+ * @brief Start aligning a sweep to the map, to be run by occ_match_step().
+ *
+ * The search is the one occ_match_scan() makes, cut into steps of one row
+ * of cell shifts (at most 2 * OCC_SEARCH_CELLS + 1 scores) so a caller can
+ * let other work run in between. Only one search can be in progress, and
+ * the map and sweep must not change until it is done.
+ *
+ * @param matcher The search state.
+ * @param map     The map, with at least one sweep added.
+ * @param scan    The new sweep.
+ */
+void occ_match_begin(occ_matcher *matcher, const occ_map *map, const sweep_scan *scan);
+
+/**
+ * @brief Search one row of cell shifts.
+ *
+ * @param matcher The search state.
+ * @param map     The map passed to occ_match_begin().
+ * @return true once the search is done and matcher->match holds the result.
+ */
+bool occ_match_step(occ_matcher *matcher, const occ_map *map);
+
+/**
+ * @brief Ray-trace a sweep into the map.
+ *
+ * Cells along each beam are marked free and the end cell occupied.
+ *
+ * @param map  The map.
+ * @param scan The sweep.
+ * @param pose Position of the device during the sweep.
+ * @return false if the map already holds OCC_MAX_POSES sweeps.
+ */
+bool occ_add_scan(occ_map *map, const sweep_scan *scan, const occ_pose *pose);
+
+/**
+ * @brief Explored floor area.
+ *
+ * @param map The map.
+ * @return Area of the free cells in hundredths of a square centimeter.
+ */
+fx_area_t occ_free_area(const occ_map *map);
+
+/**
+ * @brief Size of the map in its export form.
+ *
+ * The export form is a uint16_t grid size, a uint8_t cell size in
+ * centimeters and a uint8_t pose count; then every pose as three int32_t,
+ * x, y and heading; then the cells as stored, rows from the bottom up, two
+ * cells per byte, low nibble first. Multi-byte fields are little-endian.
+ *
+ * @param map The map.
+ * @return Bytes in the export form.
+ */
+uint32_t occ_export_size(const occ_map *map);
+
+/**
+ * @brief Read part of the map in its export form.
+ *
+ * Reads the map in place, so a large map can be sent in pieces without a
+ * copy.
+ *
+ * @param map    The map.
+ * @param offset First byte to read.
+ * @param out    Output of count bytes.
+ * @param count  Bytes to read.
+ * @return Bytes read, fewer than count at the end of the export form.
+ */
+size_t occ_export_read(const occ_map *map, uint32_t offset, uint8_t *out, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OCCUPANCY_H
@@ -32,6 +32,11 @@
 #include "spi_code.h"
 #include "pico/stdlib.h"
 #include "stdio.h"
+#include "profile.h"
+#include "trace.h"
+#include "log.h"
+#include "mirror.h"
+#include "ram_code.h"
 /**
  * Image attributes
 **/
@@ -145,7 +150,7 @@ void OLED_Clear()
 function:   
             reverse a byte data
 ********************************************************************************/
-UBYTE reverse(UBYTE temp)
+UBYTE RAM_FUNC(reverse)(UBYTE temp)
 {
     temp = ((temp & 0x55) << 1) | ((temp & 0xaa) >> 1);
     temp = ((temp & 0x33) << 2) | ((temp & 0xcc) >> 2);
@@ -156,13 +161,27 @@ UBYTE reverse(UBYTE temp)
 function:	
     Update all memory to OLED
 ********************************************************************************/
-void OLED_Display(const UBYTE *Image)
+void RAM_FUNC(OLED_Display)(const UBYTE *Image)
+{
+	OLED_Display_Rows(Image, 0, OLED_HEIGHT);
+}
+
+/********************************************************************************
+function:	
+    Update the image rows Ystart to Yend - 1 on the OLED; a region that
+    changed alone is sent in a fraction of a full update
+********************************************************************************/
+void RAM_FUNC(OLED_Display_Rows)(const UBYTE *Image, UWORD Ystart, UWORD Yend)
 {       
-	UWORD Width, Height, column, temp;
+	UWORD Width, column, temp;
+	if (Yend > OLED_HEIGHT) {
+		Yend = OLED_HEIGHT;
+	}
+	PROFILE_START(PROFILE_OLED_DISPLAY);
+	TRACE_SPAN_BEGIN(TRACE_FLUSH, Yend - Ystart);
 	Width = (OLED_WIDTH % 8 == 0)? (OLED_WIDTH / 8 ): (OLED_WIDTH / 8 + 1);
-	Height = OLED_HEIGHT;   
 	SPI_WriteCommand(0xb0); 	//Set the row  start address
-	for (UWORD j = 0; j < Height; j++) {
+	for (UWORD j = Ystart; j < Yend; j++) {
 		// column = 63 - j;
         column=j;
 		SPI_WriteCommand(0x00 + (column & 0x0f));  //Set column low start address
@@ -173,6 +192,9 @@ void OLED_Display(const UBYTE *Image)
 			SPI_WriteData(temp);
 		 }
 	}   
+	TRACE_SPAN_END(TRACE_FLUSH);
+	PROFILE_STOP(PROFILE_OLED_DISPLAY);
+	MIRROR_ROWS(Image, Ystart, Yend);
 }
 
 /********************************************************************************
@@ -250,10 +272,10 @@ parameter:
     Ypoint : At point Y
     Color  : Painted colors
 ******************************************************************************/
-void Paint_SetPixel(UWORD Xpoint, UWORD Ypoint, UWORD Color)
+void RAM_FUNC(Paint_SetPixel)(UWORD Xpoint, UWORD Ypoint, UWORD Color)
 {
     if(Xpoint > Paint.Width || Ypoint > Paint.Height){
-        printf("Exceeding display boundaries\r\n");
+        LOG_WARN("Exceeding display boundaries\r\n");
         return;
     }      
     UWORD X, Y;
@@ -297,7 +319,7 @@ void Paint_SetPixel(UWORD Xpoint, UWORD Ypoint, UWORD Color)
     }
 
     if(X > Paint.WidthMemory || Y > Paint.HeightMemory){
-        printf("Exceeding display boundaries\r\n");
+        LOG_WARN("Exceeding display boundaries\r\n");
         return;
     }
     
@@ -339,29 +361,31 @@ parameter:
     Color_Foreground : Select the foreground color
     Color_Background : Select the background color
 ******************************************************************************/
-void Paint_DrawChar(UWORD Xpoint, UWORD Ypoint, const char Acsii_Char,
-                    sFONT* Font, UWORD Color_Foreground, UWORD Color_Background)
+void RAM_FUNC(Paint_DrawChar)(UWORD Xpoint, UWORD Ypoint, const char Acsii_Char,
+                              sFONT* Font, UWORD Color_Foreground, UWORD Color_Background)
 {
     UWORD Page, Column;
 
     if (Xpoint > Paint.Width || Ypoint > Paint.Height) {
-        printf("Paint_DrawChar Input exceeds the normal display range\r\n");
+        LOG_WARN("Paint_DrawChar Input exceeds the normal display range\r\n");
         return;
     }
 
-    uint32_t Char_Offset = (Acsii_Char - ' ') * Font->Height * (Font->Width / 8 + (Font->Width % 8 ? 1 : 0));
-    const unsigned char *ptr = &Font->table[Char_Offset];
+    uint8_t Char_Index = (uint8_t)(Acsii_Char - ' ');
+    uint8_t Glyph = Char_Index < FONT_MAP_SIZE ? Font->map[Char_Index] : 0;
+    const unsigned char *ptr = &Font->table[Glyph * ((Font->Width * Font->Height + 7) / 8)];
+    uint8_t Bit = 0;
 
     for (Page = 0; Page < Font->Height; Page ++ ) {
         for (Column = 0; Column < Font->Width; Column ++ ) {
 
             //To determine whether the font background color and screen background color is consistent
             if (FONT_BACKGROUND == Color_Background) { //this process is to speed up the scan
-                if (*ptr & (0x80 >> (Column % 8)))
+                if (*ptr & (0x80 >> Bit))
                     Paint_SetPixel(Xpoint + Column, Ypoint + Page, Color_Foreground);
                     // Paint_DrawPoint(Xpoint + Column, Ypoint + Page, Color_Foreground, DOT_PIXEL_DFT, DOT_STYLE_DFT);
             } else {
-                if (*ptr & (0x80 >> (Column % 8))) {
+                if (*ptr & (0x80 >> Bit)) {
                     Paint_SetPixel(Xpoint + Column, Ypoint + Page, Color_Foreground);
                     // Paint_DrawPoint(Xpoint + Column, Ypoint + Page, Color_Foreground, DOT_PIXEL_DFT, DOT_STYLE_DFT);
                 } else {
@@ -369,12 +393,12 @@ void Paint_DrawChar(UWORD Xpoint, UWORD Ypoint, const char Acsii_Char,
                     // Paint_DrawPoint(Xpoint + Column, Ypoint + Page, Color_Background, DOT_PIXEL_DFT, DOT_STYLE_DFT);
                 }
             }
-            //One pixel is 8 bits
-            if (Column % 8 == 7)
+            //Rows are packed with no padding, so the bits run on across them
+            if (++Bit == 8) {
+                Bit = 0;
                 ptr++;
+            }
         }// Write a line
-        if (Font->Width % 8 != 0)
-            ptr++;
     }// Write all
 }
 
@@ -388,16 +412,17 @@ parameter:
     Color_Foreground : Select the foreground color
     Color_Background : Select the background color
 ******************************************************************************/
-void Paint_DrawString_EN(UWORD Xstart, UWORD Ystart, const char * pString,
-                         sFONT* Font, UWORD Color_Foreground, UWORD Color_Background)
+void RAM_FUNC(Paint_DrawString_EN)(UWORD Xstart, UWORD Ystart, const char * pString,
+                                   sFONT* Font, UWORD Color_Foreground, UWORD Color_Background)
 {
     UWORD Xpoint = Xstart;
     UWORD Ypoint = Ystart;
 
     if (Xstart > Paint.Width || Ystart > Paint.Height) {
-        printf("Paint_DrawString_EN Input exceeds the normal display range\r\n");
+        LOG_WARN("Paint_DrawString_EN Input exceeds the normal display range\r\n");
         return;
     }
+    PROFILE_START(PROFILE_DRAW_STRING);
 
     while (* pString != '\0') {
         //if X direction filled , reposition to(Xstart,Ypoint),Ypoint is Y direction plus the Height of the character
@@ -419,6 +444,7 @@ void Paint_DrawString_EN(UWORD Xstart, UWORD Ystart, const char * pString,
         //The next word of the abscissa increases the font of the broadband
         Xpoint += Font->Width;
     }
+    PROFILE_STOP(PROFILE_DRAW_STRING);
 }
 void Paint_SetScale(UBYTE scale)
 {
@@ -435,8 +461,8 @@ void Paint_SetScale(UBYTE scale)
         Paint.Scale = scale;
         Paint.WidthByte = Paint.WidthMemory*2; 
     }else{
-        printf("Set Scale Input parameter error\r\n");
-        printf("Scale Only support: 2 4 16 65\r\n");
+        LOG_WARN("Set Scale Input parameter error\r\n");
+        LOG_WARN("Scale Only support: 2 4 16 65\r\n");
     }
 }
 
@@ -480,7 +506,7 @@ function: Clear the color of the picture
 parameter:
     Color : Painted colors
 ******************************************************************************/
-void Paint_Clear(UWORD Color)
+void RAM_FUNC(Paint_Clear)(UWORD Color)
 {
     if(Paint.Scale == 2 || Paint.Scale == 4) {
         for (UWORD Y = 0; Y < Paint.HeightByte; Y++) {
@@ -521,9 +547,9 @@ void Paint_DrawPoint(UWORD Xpoint, UWORD Ypoint, UWORD Color,
                      DOT_PIXEL Dot_Pixel, DOT_STYLE Dot_Style)
 {
     if (Xpoint > Paint.Width || Ypoint > Paint.Height) {
-        printf("Paint_DrawPoint Input exceeds the normal display range\r\n");
-				printf("Xpoint = %d , Paint.Width = %d  \r\n ",Xpoint,Paint.Width);
-				printf("Ypoint = %d , Paint.Height = %d  \r\n ",Ypoint,Paint.Height);
+        LOG_WARN("Paint_DrawPoint Input exceeds the normal display range\r\n");
+				LOG_WARN("Xpoint = %d , Paint.Width = %d  \r\n ",Xpoint,Paint.Width);
+				LOG_WARN("Ypoint = %d , Paint.Height = %d  \r\n ",Ypoint,Paint.Height);
         return;
     }
 
@@ -562,7 +588,7 @@ void Paint_DrawLine(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend,
 {
     if (Xstart > Paint.Width || Ystart > Paint.Height ||
         Xend > Paint.Width || Yend > Paint.Height) {
-        printf("Paint_DrawLine Input exceeds the normal display range\r\n");
+        LOG_WARN("Paint_DrawLine Input exceeds the normal display range\r\n");
         return;
     }
 
@@ -623,7 +649,7 @@ void Paint_DrawRectangle(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend,
 {
     if (Xstart > Paint.Width || Ystart > Paint.Height ||
         Xend > Paint.Width || Yend > Paint.Height) {
-        printf("Input exceeds the normal display range\r\n");
+        LOG_WARN("Input exceeds the normal display range\r\n");
         return;
     }
 
@@ -655,7 +681,7 @@ void Paint_DrawCircle(UWORD X_Center, UWORD Y_Center, UWORD Radius,
                       UWORD Color, DOT_PIXEL Line_width, DRAW_FILL Draw_Fill)
 {
     if (X_Center > Paint.Width || Y_Center >= Paint.Height) {
-        printf("Paint_DrawCircle Input exceeds the normal display range\r\n");
+        LOG_WARN("Paint_DrawCircle Input exceeds the normal display range\r\n");
         return;
     }
 
@@ -732,7 +758,7 @@ void Paint_DrawNum(UWORD Xpoint, UWORD Ypoint, double Nummber,
 	float decimals;
 	uint8_t i;
     if (Xpoint > Paint.Width || Ypoint > Paint.Height) {
-        printf("Paint_DisNum Input exceeds the normal display range\r\n");
+        LOG_WARN("Paint_DisNum Input exceeds the normal display range\r\n");
         return;
     }
    
@@ -53,15 +53,22 @@
 #define ROTATE_270          270
 
 //ASCII
+// Characters ' ' to '~' in a font's map
+#define FONT_MAP_SIZE (95)
+
+// Fonts are generated by tools/fontgen with only the glyphs the UI draws;
+// each glyph is Width * Height bits, row after row, most significant bit
+// leftmost, and map gives the glyph of each character (0, a space, if the
+// font was built without it)
 typedef struct _tFont
 {    
   const uint8_t *table;
   uint16_t Width;
   uint16_t Height;
+  const uint8_t *map;
   
 } sFONT;
-extern sFONT Font24;
-extern sFONT Font20;
+// The fonts the UI draws with, which tools/fontgen writes to fonts_subset.c
 extern sFONT Font16;
 extern sFONT Font12;
 extern sFONT Font8;
@@ -126,6 +133,8 @@ UBYTE reverse(UBYTE temp);
 
 void OLED_Display(const UBYTE *Image);
 
+void OLED_Display_Rows(const UBYTE *Image, UWORD Ystart, UWORD Yend);
+
 void OLED_Display_Test(void);
 
 void Paint_SelectImage(UBYTE *image);
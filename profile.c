@@ -0,0 +1,145 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file profile.c
+ * @brief Cycle-count probes for named hot spots.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#include "profile.h"
+#include "pico/stdlib.h"
+#include "hardware/structs/systick.h"
+#include "hardware/structs/scb.h"
+#include "hardware/structs/xip_ctrl.h"
+#include "ram_code.h"
+
+// SysTick counts down from this, wrapping every 2^24 cycles (134 ms at 125 MHz)
+#define PROFILE_SYSTICK_RELOAD (0x00FFFFFF)
+
+static const char *const names[PROFILE_COUNT] = {
+    [PROFILE_OLED_DISPLAY] = "oled",
+    [PROFILE_SPI_SEND_BYTE] = "spi_tx",
+    [PROFILE_DRAW_STRING] = "string",
+    [PROFILE_READ_LIDAR] = "lidar",
+    [PROFILE_READ_ACCEL] = "accel",
+    [PROFILE_REG_READ] = "reg_rd",
+    [PROFILE_AREA] = "area",
+};
+
+static profile_stats table[PROFILE_COUNT];
+static volatile uint32_t wraps[2];      // SysTick wraps, per core
+
+/**
+ * @brief SysTick interrupt: count a wrap of the calling core's counter.
+ */
+void isr_systick(void) {
+    wraps[get_core_num()]++;
+}
+
+/**
+ * @brief Start the cycle counter of the calling core.
+ */
+void profile_init(void) {
+    systick_hw->csr = 0;
+    systick_hw->rvr = PROFILE_SYSTICK_RELOAD;
+    systick_hw->cvr = 0;
+    // Processor clock, interrupt on wrap, enabled
+    systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_TICKINT_BITS |
+                      M0PLUS_SYST_CSR_ENABLE_BITS;
+}
+
+/**
+ * @brief Read the calling core's cycle counter.
+ *
+ * The wrap count is read on both sides of the counter to catch a wrap in
+ * between. A wrap whose interrupt is still pending, because interrupts are
+ * masked, shows as a high counter value with the pending bit set.
+ *
+ * @return Cycles since profile_init(), modulo 2^32.
+ */
+uint32_t RAM_FUNC(profile_cycles)(void) {
+    volatile uint32_t *core_wraps = &wraps[get_core_num()];
+    uint32_t count;
+    uint32_t value;
+    bool pending;
+
+    do {
+        count = *core_wraps;
+        value = systick_hw->cvr;
+        pending = scb_hw->icsr & M0PLUS_ICSR_PENDSTSET_BITS;
+    } while (count != *core_wraps);
+
+    if (pending && value > PROFILE_SYSTICK_RELOAD / 2) {
+        count++;
+    }
+    return (count << 24) | (PROFILE_SYSTICK_RELOAD - value);
+}
+
+/**
+ * @brief Record one run of a probe.
+ *
+ * @param id     The probe.
+ * @param cycles Cycles the run took.
+ */
+void RAM_FUNC(profile_record)(profile_id id, uint32_t cycles) {
+    profile_stats *s = &table[id];
+
+    if (s->count == 0 || cycles < s->min) {
+        s->min = cycles;
+    }
+    if (cycles > s->max) {
+        s->max = cycles;
+    }
+    s->total += cycles;
+    s->count++;
+}
+
+/**
+ * @brief Read the statistics of a probe.
+ *
+ * @param id    The probe.
+ * @param stats Output statistics.
+ */
+void profile_get(profile_id id, profile_stats *stats) {
+    *stats = table[id];
+}
+
+/**
+ * @brief Short display name of a probe.
+ *
+ * @param id The probe.
+ * @return The name, at most six characters.
+ */
+const char *profile_name(profile_id id) {
+    return names[id];
+}
+
+/**
+ * @brief Clear the statistics of every probe.
+ */
+void profile_reset(void) {
+    for (uint8_t i = 0; i < PROFILE_COUNT; i++) {
+        table[i] = (profile_stats){0};
+    }
+}
+
+/**
+ * @brief Read and restart the XIP cache counters.
+ *
+ * @param hits     Output reads served from the cache since the last call.
+ * @param accesses Output reads since the last call.
+ */
+void profile_xip(uint32_t *hits, uint32_t *accesses) {
+    *hits = xip_ctrl_hw->ctr_hit;
+    *accesses = xip_ctrl_hw->ctr_acc;
+    // Any write clears a counter
+    xip_ctrl_hw->ctr_hit = 0;
+    xip_ctrl_hw->ctr_acc = 0;
+}
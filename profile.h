@@ -0,0 +1,118 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file profile.h
+ * @brief Cycle-count probes for named hot spots.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Cycles are counted with each core's SysTick, extended past its 24 bits by
+ * a wrap counter, so a probe costs a few register reads and no printf. The
+ * probes compile to nothing unless SSM_PROFILE is set to 1.
+ */
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+#ifndef SSM_PROFILE
+#define SSM_PROFILE 0
+#endif
+
+/**
+ * @brief Probed hot spots. Each one is only entered from one core.
+ */
+typedef enum {
+    PROFILE_OLED_DISPLAY,   // OLED_Display, full frame over SPI
+    PROFILE_SPI_SEND_BYTE,  // SPI_send_byte
+    PROFILE_DRAW_STRING,    // Paint_DrawString_EN
+    PROFILE_READ_LIDAR,     // read_lidar (core1)
+    PROFILE_READ_ACCEL,     // readAccelData (core1)
+    PROFILE_REG_READ,       // reg_read (core1)
+    PROFILE_AREA,           // Area formula of a capture plan
+    PROFILE_COUNT,
+} profile_id;
+
+/**
+ * @brief Statistics of one probe since the last reset.
+ */
+typedef struct {
+    uint32_t count;         // Times the probe ran
+    uint64_t total;         // Cycles over all runs
+    uint32_t min;           // Fewest cycles of one run
+    uint32_t max;           // Most cycles of one run
+} profile_stats;
+
+#if SSM_PROFILE
+// Start timing a probe; opens a local, so use once per probe per block
+#define PROFILE_START(id) uint32_t profile_start_##id = profile_cycles()
+// Stop timing a probe and record the run
+#define PROFILE_STOP(id) profile_record(id, profile_cycles() - profile_start_##id)
+#else
+#define PROFILE_START(id) do {} while (0)
+#define PROFILE_STOP(id) do {} while (0)
+#endif
+
+/**
+ * @brief Start the cycle counter of the calling core.
+ *
+ * Call once on each core that runs probes.
+ */
+void profile_init(void);
+
+/**
+ * @brief Read the calling core's cycle counter.
+ *
+ * @return Cycles since profile_init(), modulo 2^32.
+ */
+uint32_t profile_cycles(void);
+
+/**
+ * @brief Record one run of a probe.
+ *
+ * @param id     The probe.
+ * @param cycles Cycles the run took.
+ */
+void profile_record(profile_id id, uint32_t cycles);
+
+/**
+ * @brief Read the statistics of a probe.
+ *
+ * @param id    The probe.
+ * @param stats Output statistics.
+ */
+void profile_get(profile_id id, profile_stats *stats);
+
+/**
+ * @brief Short display name of a probe.
+ *
+ * @param id The probe.
+ * @return The name, at most six characters.
+ */
+const char *profile_name(profile_id id);
+
+/**
+ * @brief Clear the statistics of every probe.
+ */
+void profile_reset(void);
+
+/**
+ * @brief Read and restart the XIP cache counters.
+ *
+ * They count flash reads through the cache by both cores and DMA; a miss
+ * stalls the reader for a flash transfer. The counters wrap within a
+ * minute or two of busy running, so read them more often than that.
+ *
+ * @param hits     Output reads served from the cache since the last call.
+ * @param accesses Output reads since the last call.
+ */
+void profile_xip(uint32_t *hits, uint32_t *accesses);
+
+#endif // PROFILE_H
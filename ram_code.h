@@ -0,0 +1,43 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file ram_code.h
+ * @brief Placement of hot paths in SRAM instead of XIP flash.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Code runs from flash through a 16 KB cache. Drawing a screen walks the
+ * menu code, the paint routines and a font table, enough to evict the SPI
+ * and I2C helpers it calls per byte, and each miss stalls the core for a
+ * flash read. With SSM_RUN_FROM_RAM set to 1 the functions marked
+ * RAM_FUNC and the tables marked RAM_DATA are copied to SRAM at boot and
+ * never miss. The ESD_FINAL_ram build goes further and runs everything
+ * from SRAM.
+ */
+#ifndef RAM_CODE_H
+#define RAM_CODE_H
+
+#ifndef SSM_RUN_FROM_RAM
+#define SSM_RUN_FROM_RAM 0
+#endif
+
+#if SSM_RUN_FROM_RAM
+#include "pico/platform.h"
+
+// Define a function in SRAM: void RAM_FUNC(name)(args) { ... }
+#define RAM_FUNC(name) __not_in_flash_func(name)
+// Place a table in SRAM; group names the section, one per file
+#define RAM_DATA(group) __not_in_flash(group)
+#else
+#define RAM_FUNC(name) name
+#define RAM_DATA(group)
+#endif
+
+#endif // RAM_CODE_H
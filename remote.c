@@ -0,0 +1,183 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file remote.c
+ * @brief Remote control of measurements from the host over the USB link.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#include "remote.h"
+#include <string.h>
+#include "usb_link.h"
+#include "event.h"
+#include "button.h"
+#include "ui_fsm.h"
+#include "user_interface.h"
+#include "journal.h"
+#include "mirror.h"
+
+// Reply data after the sequence number and status
+#define REMOTE_REPLY_DATA (USB_LINK_MAX_MESSAGE - 2)
+
+/**
+ * @brief Queue the reply to a command.
+ *
+ * A reply is only lost if the outbox is full, which the link prevents by
+ * reading a command only when there is room.
+ */
+static void reply(const frame *request, uint8_t status, const void *data, size_t length) {
+    uint8_t out[USB_LINK_MAX_MESSAGE];
+
+    out[0] = request->seq;
+    out[1] = status;
+    if (length > 0) {
+        memcpy(out + 2, data, length);
+    }
+    usb_link_send(FRAME_REPLY, out, 2 + length);
+}
+
+/**
+ * @brief Post the events of a button press.
+ *
+ * The release is posted even if the press did not fit the queue, so the
+ * state machine never sees a button stuck down.
+ */
+static uint8_t press(const frame *request) {
+    if (request->length < 1 || request->data[0] > 1) {
+        return FRAME_STATUS_BAD_ARG;
+    }
+    uint32_t gpio = request->data[0] ? GPIO11 : GPIO10;
+    bool hold = request->length >= 2 && request->data[1] == 1;
+
+    bool posted = event_post(EVENT_BUTTON_PRESS, gpio);
+    if (posted && hold) {
+        posted = event_post(EVENT_BUTTON_LONG, gpio);
+    }
+    posted = event_post(EVENT_BUTTON_RELEASE, gpio) && posted;
+    return posted ? FRAME_STATUS_OK : FRAME_STATUS_BUSY;
+}
+
+/**
+ * @brief Start the measurement of a shape named in the command.
+ */
+static uint8_t measure(const frame *request) {
+    char name[JOURNAL_SHAPE_LEN];
+    ui_status status;
+
+    if (request->length == 0 || request->length >= sizeof(name)) {
+        return FRAME_STATUS_BAD_ARG;
+    }
+    memcpy(name, request->data, request->length);
+    name[request->length] = '\0';
+
+    int entry = user_interface_entry(name);
+    if (entry < 0) {
+        return FRAME_STATUS_BAD_ARG;
+    }
+    user_interface_status(&status);
+    if (status.state == UI_STATE_MEASURE) {
+        return FRAME_STATUS_BUSY;
+    }
+    return event_post(EVENT_REMOTE_MEASURE, (uint32_t)entry) ? FRAME_STATUS_OK : FRAME_STATUS_BUSY;
+}
+
+/**
+ * @brief Carry out a remote control command and queue its reply.
+ *
+ * Commands act on the event queue and return at once; a measurement's
+ * progress follows in FRAME_CAPTURED and FRAME_RESULT frames.
+ *
+ * @param request The received frame.
+ * @return false if the frame is not a command.
+ */
+bool remote_command(const frame *request) {
+    uint8_t data[REMOTE_REPLY_DATA];
+    ui_status status;
+    size_t length;
+
+    switch (request->type) {
+    case FRAME_CMD_PING:
+        if (request->length > sizeof(data)) {
+            reply(request, FRAME_STATUS_BAD_ARG, NULL, 0);
+        } else {
+            reply(request, FRAME_STATUS_OK, request->data, request->length);
+        }
+        return true;
+    case FRAME_CMD_PRESS:
+        reply(request, press(request), NULL, 0);
+        return true;
+    case FRAME_CMD_MEASURE:
+        reply(request, measure(request), NULL, 0);
+        return true;
+    case FRAME_CMD_STATUS:
+        user_interface_status(&status);
+        data[0] = status.state;
+        data[1] = status.step;
+        data[2] = status.steps;
+        length = strnlen(status.shape, sizeof(data) - 3);
+        memcpy(data + 3, status.shape, length);
+        reply(request, FRAME_STATUS_OK, data, 3 + length);
+        return true;
+    case FRAME_CMD_MIRROR:
+        if (!SSM_MIRROR) {
+            reply(request, FRAME_STATUS_UNKNOWN, NULL, 0);
+        } else if (request->length < 1 || request->data[0] > 1) {
+            reply(request, FRAME_STATUS_BAD_ARG, NULL, 0);
+        } else {
+            mirror_enable(request->data[0] == 1);
+            reply(request, FRAME_STATUS_OK, NULL, 0);
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Tell the host a capture step was taken.
+ *
+ * @param step     Distances captured so far.
+ * @param steps    Distances the measurement captures.
+ * @param distance The distance captured, in cm.
+ */
+void remote_captured(uint8_t step, uint8_t steps, uint16_t distance) {
+    uint8_t data[4] = { step, steps };
+
+    memcpy(data + 2, &distance, 2);
+    usb_link_send(FRAME_CAPTURED, data, sizeof(data));
+}
+
+/**
+ * @brief Tell the host a measurement completed.
+ *
+ * The result goes out in hundredths, rounded as the journal stores it.
+ *
+ * @param shape  The measured shape.
+ * @param result The result, as in double_array.
+ */
+void remote_result(const char *shape, const double result[2]) {
+    uint8_t data[8 + JOURNAL_SHAPE_LEN];
+    int32_t value[2];
+
+    for (int i = 0; i < 2; i++) {
+        value[i] = (int32_t)(result[i] * 100 + 0.5);
+    }
+    memcpy(data, value, sizeof(value));
+    size_t length = strnlen(shape, JOURNAL_SHAPE_LEN);
+    memcpy(data + 8, shape, length);
+    usb_link_send(FRAME_RESULT, data, 8 + length);
+}
+
+/**
+ * @brief Tell the host the running measurement was abandoned.
+ */
+void remote_cancelled(void) {
+    usb_link_send(FRAME_CANCELLED, NULL, 0);
+}
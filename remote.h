@@ -0,0 +1,58 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file remote.h
+ * @brief Remote control of measurements from the host over the USB link.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Commands become the same events the buttons post, so a remote press or
+ * measurement goes through the state machine exactly as a local one. The UI
+ * reports each capture and result back as it happens; tools/ssm_remote
+ * drives the commands and measures their round trip.
+ */
+#ifndef REMOTE_H
+#define REMOTE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "frame.h"
+
+/**
+ * @brief Carry out a remote control command and queue its reply.
+ *
+ * @param request The received frame.
+ * @return false if the frame is not a command.
+ */
+bool remote_command(const frame *request);
+
+/**
+ * @brief Tell the host a capture step was taken.
+ *
+ * @param step     Distances captured so far.
+ * @param steps    Distances the measurement captures.
+ * @param distance The distance captured, in cm.
+ */
+void remote_captured(uint8_t step, uint8_t steps, uint16_t distance);
+
+/**
+ * @brief Tell the host a measurement completed.
+ *
+ * @param shape  The measured shape.
+ * @param result The result, as in double_array.
+ */
+void remote_result(const char *shape, const double result[2]);
+
+/**
+ * @brief Tell the host the running measurement was abandoned.
+ */
+void remote_cancelled(void);
+
+#endif // REMOTE_H
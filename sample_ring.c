@@ -0,0 +1,231 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file sample_ring.c
+ * @brief Lock-free ring of timestamped sensor samples.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Only plain 32-bit loads and stores are used on shared words, which the
+ * Cortex-M0+ does atomically; the barriers come from the __atomic fences.
+ */
+#include "sample_ring.h"
+#include <string.h>
+
+/**
+ * @brief Prepare a ring over caller-owned storage.
+ *
+ * @param ring     The ring.
+ * @param seq      capacity sequence words.
+ * @param data     capacity * size bytes.
+ * @param capacity Number of slots; must be a power of two.
+ * @param size     Bytes per sample, at least sizeof(uint64_t).
+ */
+void sample_ring_init(sample_ring *ring, uint32_t *seq, void *data,
+                      uint32_t capacity, uint16_t size) {
+    memset(seq, 0, capacity * sizeof(uint32_t));
+    ring->seq = seq;
+    ring->data = data;
+    ring->mask = capacity - 1;
+    ring->size = size;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->lost = 0;
+}
+
+/**
+ * @brief Append a sample, overwriting the oldest when full (producer only).
+ *
+ * @param ring   The ring.
+ * @param sample The sample to copy in.
+ */
+void sample_ring_push(sample_ring *ring, const void *sample) {
+    uint32_t n = ring->head;
+    uint32_t slot = n & ring->mask;
+
+    // Odd sequence first, so a reader that races the copy sees a mismatch
+    __atomic_store_n(&ring->seq[slot], 2 * n + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(ring->data + slot * ring->size, sample, ring->size);
+    __atomic_store_n(&ring->seq[slot], 2 * n + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->head, n + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Copy part of sample n and check it was sample n throughout.
+ *
+ * @return false if the slot holds another sample or is being written.
+ */
+static bool read_slot(sample_ring *ring, uint32_t n, void *out, size_t bytes) {
+    uint32_t slot = n & ring->mask;
+    uint32_t want = 2 * n + 2;
+
+    if (__atomic_load_n(&ring->seq[slot], __ATOMIC_ACQUIRE) != want) {
+        return false;
+    }
+    memcpy(out, ring->data + slot * ring->size, bytes);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&ring->seq[slot], __ATOMIC_RELAXED) == want;
+}
+
+static uint32_t load_head(sample_ring *ring) {
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Copy the newest sample.
+ *
+ * @param ring The ring.
+ * @param out  Output sample.
+ * @return false if nothing has been pushed yet.
+ */
+bool sample_ring_latest(sample_ring *ring, void *out) {
+    while (true) {
+        uint32_t head = load_head(ring);
+
+        if (head == 0) {
+            return false;
+        }
+        if (read_slot(ring, head - 1, out, ring->size)) {
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief Copy the samples taken after a given time, oldest first.
+ *
+ * Timestamps only grow, so the start is found by stepping back from the
+ * newest sample until one is no later than time_us.
+ *
+ * @param ring    The ring.
+ * @param time_us Only samples stamped later than this are copied.
+ * @param out     Output array of max samples.
+ * @param max     Capacity of out; the oldest matching samples are kept.
+ * @return Number of samples copied.
+ */
+size_t sample_ring_since(sample_ring *ring, uint64_t time_us, void *out, size_t max) {
+    while (true) {
+        uint32_t head = load_head(ring);
+        uint32_t oldest = (head > ring->mask) ? head - ring->mask - 1 : 0;
+        uint32_t start = head;
+        uint64_t stamp = 0;
+        bool read = true;
+        uint32_t count;
+        uint32_t i;
+
+        // A slot that fails to read was overwritten, and so were all older
+        while (start > oldest && (read = read_slot(ring, start - 1, &stamp, sizeof(stamp))) && stamp > time_us) {
+            start--;
+        }
+        if (!read && start == head) {
+            // Even the newest was overwritten: the producer lapped us
+            continue;
+        }
+
+        count = head - start;
+        if (count > max) {
+            count = max;
+        }
+        for (i = 0; i < count; i++) {
+            if (!read_slot(ring, start + i, (uint8_t *)out + i * ring->size, ring->size)) {
+                break;
+            }
+        }
+        if (i == count) {
+            return count;
+        }
+    }
+}
+
+/**
+ * @brief Copy the newest count consecutive samples, oldest first.
+ *
+ * The producer overwrites the oldest slot of the run on every push, so
+ * count should stay well below the capacity for the copy to finish.
+ *
+ * @param ring  The ring.
+ * @param out   Output array of count samples.
+ * @param count Samples wanted.
+ * @return Number of samples copied; less than count only early after start.
+ */
+size_t sample_ring_snapshot(sample_ring *ring, void *out, size_t count) {
+    if (count > ring->mask + 1) {
+        count = ring->mask + 1;
+    }
+
+    while (true) {
+        uint32_t head = load_head(ring);
+        uint32_t n = (head < count) ? head : count;
+        uint32_t i;
+
+        for (i = 0; i < n; i++) {
+            if (!read_slot(ring, head - n + i, (uint8_t *)out + i * ring->size, ring->size)) {
+                break;
+            }
+        }
+        if (i == n) {
+            return n;
+        }
+    }
+}
+
+/**
+ * @brief Take the oldest sample not yet taken (single consumer).
+ *
+ * Samples overwritten before they were taken are skipped and counted in
+ * ring->lost.
+ *
+ * @param ring The ring.
+ * @param out  Output sample.
+ * @return false if no sample is waiting.
+ */
+bool sample_ring_next(sample_ring *ring, void *out) {
+    while (true) {
+        uint32_t head = load_head(ring);
+        uint32_t tail = ring->tail;
+
+        if (tail == head) {
+            return false;
+        }
+        if (head - tail > ring->mask + 1) {
+            ring->lost += head - tail - (ring->mask + 1);
+            tail = head - (ring->mask + 1);
+        }
+
+        ring->tail = tail + 1;
+        if (read_slot(ring, tail, out, ring->size)) {
+            return true;
+        }
+        // Overwritten while we looked; never wait on the producer
+        ring->lost++;
+    }
+}
+
+/**
+ * @brief Mark every pushed sample as taken (single consumer).
+ *
+ * @param ring The ring.
+ */
+void sample_ring_skip(sample_ring *ring) {
+    ring->tail = load_head(ring);
+}
+
+/**
+ * @brief Number of samples waiting for sample_ring_next().
+ *
+ * @param ring The ring.
+ * @return Samples pushed but not taken, at most the capacity.
+ */
+uint32_t sample_ring_pending(sample_ring *ring) {
+    uint32_t pending = load_head(ring) - ring->tail;
+
+    return (pending > ring->mask + 1) ? ring->mask + 1 : pending;
+}
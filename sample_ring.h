@@ -0,0 +1,132 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file sample_ring.h
+ * @brief Lock-free ring of timestamped sensor samples.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * One producer (an IRQ handler or the other core) pushes samples and never
+ * waits: when the ring is full the oldest sample is overwritten. Every slot
+ * carries a sequence number that is odd while the slot is being written, so
+ * a reader can copy a slot and then check that it was not overwritten
+ * underneath it. No lock is taken and interrupts stay enabled.
+ *
+ * Each sample must begin with a uint64_t timestamp from time_us_64().
+ */
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Ring state. Storage is supplied by the owner.
+ */
+typedef struct {
+    uint32_t *seq;          // Per-slot sequence: 2n+1 while writing sample n, 2n+2 once written
+    uint8_t *data;          // capacity * size bytes of sample storage
+    uint32_t mask;          // capacity - 1
+    uint16_t size;          // Bytes per sample
+    uint32_t head;          // Samples pushed, written by the producer only
+    uint32_t tail;          // Samples taken by sample_ring_next(), consumer only
+    uint32_t lost;          // Samples overwritten before the consumer took them
+} sample_ring;
+
+/**
+ * @brief Prepare a ring over caller-owned storage.
+ *
+ * @param ring     The ring.
+ * @param seq      capacity sequence words.
+ * @param data     capacity * size bytes.
+ * @param capacity Number of slots; must be a power of two.
+ * @param size     Bytes per sample, at least sizeof(uint64_t).
+ */
+void sample_ring_init(sample_ring *ring, uint32_t *seq, void *data,
+                      uint32_t capacity, uint16_t size);
+
+/**
+ * @brief Append a sample, overwriting the oldest when full (producer only).
+ *
+ * @param ring   The ring.
+ * @param sample The sample to copy in.
+ */
+void sample_ring_push(sample_ring *ring, const void *sample);
+
+/**
+ * @brief Copy the newest sample.
+ *
+ * @param ring The ring.
+ * @param out  Output sample.
+ * @return false if nothing has been pushed yet.
+ */
+bool sample_ring_latest(sample_ring *ring, void *out);
+
+/**
+ * @brief Copy the samples taken after a given time, oldest first.
+ *
+ * @param ring    The ring.
+ * @param time_us Only samples stamped later than this are copied.
+ * @param out     Output array of max samples.
+ * @param max     Capacity of out; the oldest matching samples are kept.
+ * @return Number of samples copied.
+ */
+size_t sample_ring_since(sample_ring *ring, uint64_t time_us, void *out, size_t max);
+
+/**
+ * @brief Copy the newest count consecutive samples, oldest first.
+ *
+ * The copy is retried until no slot in it was overwritten during the copy,
+ * so the samples always form one unbroken run.
+ *
+ * @param ring  The ring.
+ * @param out   Output array of count samples.
+ * @param count Samples wanted.
+ * @return Number of samples copied; less than count only early after start.
+ */
+size_t sample_ring_snapshot(sample_ring *ring, void *out, size_t count);
+
+/**
+ * @brief Take the oldest sample not yet taken (single consumer).
+ *
+ * Samples overwritten before they were taken are skipped and counted in
+ * ring->lost.
+ *
+ * @param ring The ring.
+ * @param out  Output sample.
+ * @return false if no sample is waiting.
+ */
+bool sample_ring_next(sample_ring *ring, void *out);
+
+/**
+ * @brief Mark every pushed sample as taken (single consumer).
+ *
+ * @param ring The ring.
+ */
+void sample_ring_skip(sample_ring *ring);
+
+/**
+ * @brief Number of samples waiting for sample_ring_next().
+ *
+ * @param ring The ring.
+ * @return Samples pushed but not taken, at most the capacity.
+ */
+uint32_t sample_ring_pending(sample_ring *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SAMPLE_RING_H
@@ -0,0 +1,148 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file sampler.c
+ * @brief Fixed-rate sampling scheduler for core1.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#include "sampler.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+/**
+ * @brief One periodic read.
+ */
+typedef struct {
+    uint32_t period_us;
+    sampler_fn fn;
+    repeating_timer_t timer;
+    uint64_t next_us;           // Time the timer fires next, kept by the timer
+    volatile uint64_t due_us;   // Scheduled time of the pending read
+    volatile bool pending;      // Set by the timer, cleared by the read
+    volatile bool reset;        // Statistics reset requested from core0
+    sampler_stats stats;
+} sampler_channel;
+
+static sampler_channel channels[SAMPLER_MAX_CHANNELS];
+static uint8_t channel_count;
+static alarm_pool_t *pool;
+
+/**
+ * @brief Timer callback: mark the channel due and wake core1.
+ */
+static bool sampler_timer(repeating_timer_t *timer) {
+    sampler_channel *ch = timer->user_data;
+
+    if (ch->pending) {
+        ch->stats.missed++;
+    }
+    ch->due_us = ch->next_us;
+    ch->pending = true;
+    ch->next_us += ch->period_us;
+    __sev();
+    return true;
+}
+
+/**
+ * @brief Register a channel (core1, before sampler_run()).
+ *
+ * @param period_us Sampling period in microseconds.
+ * @param fn        Read function.
+ * @return The channel number, or -1 if all channels are in use.
+ */
+int sampler_add(uint32_t period_us, sampler_fn fn) {
+    if (channel_count >= SAMPLER_MAX_CHANNELS) {
+        return -1;
+    }
+    channels[channel_count].period_us = period_us;
+    channels[channel_count].fn = fn;
+    return channel_count++;
+}
+
+/**
+ * @brief Run one channel if it is due.
+ */
+static void run_channel(sampler_channel *ch) {
+    uint32_t irq;
+    uint64_t due_us;
+    uint32_t late_us;
+
+    irq = save_and_disable_interrupts();
+    if (!ch->pending) {
+        restore_interrupts(irq);
+        return;
+    }
+    due_us = ch->due_us;
+    ch->pending = false;
+    restore_interrupts(irq);
+
+    if (ch->reset) {
+        ch->stats = (sampler_stats){0};
+        ch->reset = false;
+    }
+
+    late_us = (uint32_t)(time_us_64() - due_us);
+    ch->stats.samples++;
+    ch->stats.late_sum_us += late_us;
+    if (late_us > ch->stats.late_max_us) {
+        ch->stats.late_max_us = late_us;
+    }
+
+    ch->fn(due_us);
+}
+
+/**
+ * @brief Start the timers and run due channels forever (core1).
+ *
+ * The pool is created here so its alarm interrupt belongs to core1.
+ */
+void sampler_run(void) {
+    uint64_t start_us;
+    uint8_t i;
+
+    pool = alarm_pool_create(SAMPLER_ALARM_NUM, SAMPLER_MAX_CHANNELS);
+
+    // All channels share one phase, so equal periods fire together
+    start_us = time_us_64();
+    for (i = 0; i < channel_count; i++) {
+        channels[i].next_us = start_us + channels[i].period_us;
+        // A negative period schedules from the previous target, not the callback
+        alarm_pool_add_repeating_timer_us(pool, -(int64_t)channels[i].period_us,
+                                          sampler_timer, &channels[i], &channels[i].timer);
+    }
+
+    while (true) {
+        for (i = 0; i < channel_count; i++) {
+            run_channel(&channels[i]);
+        }
+        // A timer that fired during the reads has set the event flag already
+        __wfe();
+    }
+}
+
+/**
+ * @brief Read the timing statistics of a channel (either core).
+ *
+ * @param channel The channel number.
+ * @param stats   Output statistics.
+ */
+void sampler_get_stats(int channel, sampler_stats *stats) {
+    *stats = channels[channel].stats;
+}
+
+/**
+ * @brief Ask core1 to clear the statistics of a channel before its next read.
+ *
+ * @param channel The channel number.
+ */
+void sampler_reset_stats(int channel) {
+    channels[channel].reset = true;
+}
@@ -0,0 +1,82 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file sampler.h
+ * @brief Fixed-rate sampling scheduler for core1.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Each channel has a repeating timer in an alarm pool owned by core1. The
+ * timer only marks the channel due and wakes the core; the read itself runs
+ * in thread context, so a slow I2C transfer never blocks other interrupts.
+ * Channels are handed the time they were scheduled for, which advances in
+ * whole periods, and the lateness of each read is recorded.
+ */
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Maximum number of channels
+#define SAMPLER_MAX_CHANNELS (4)
+
+// Hardware alarm for the core1 pool; the default pool on core0 uses alarm 3
+#define SAMPLER_ALARM_NUM (2)
+
+/**
+ * @brief Read function for a channel.
+ *
+ * @param scheduled_us The time this sample was due, from time_us_64().
+ */
+typedef void (*sampler_fn)(uint64_t scheduled_us);
+
+/**
+ * @brief Timing statistics of one channel since the last reset.
+ */
+typedef struct {
+    uint32_t samples;       // Reads performed
+    uint32_t missed;        // Periods that came due while the last read was still pending
+    uint32_t late_sum_us;   // Sum of read start minus scheduled time
+    uint32_t late_max_us;   // Largest read start minus scheduled time
+} sampler_stats;
+
+/**
+ * @brief Register a channel (core1, before sampler_run()).
+ *
+ * Channels due at the same time are read in the order they were added.
+ *
+ * @param period_us Sampling period in microseconds.
+ * @param fn        Read function.
+ * @return The channel number, or -1 if all channels are in use.
+ */
+int sampler_add(uint32_t period_us, sampler_fn fn);
+
+/**
+ * @brief Start the timers and run due channels forever (core1).
+ */
+void sampler_run(void);
+
+/**
+ * @brief Read the timing statistics of a channel (either core).
+ *
+ * @param channel The channel number.
+ * @param stats   Output statistics.
+ */
+void sampler_get_stats(int channel, sampler_stats *stats);
+
+/**
+ * @brief Ask core1 to clear the statistics of a channel before its next read.
+ *
+ * @param channel The channel number.
+ */
+void sampler_reset_stats(int channel);
+
+#endif // SAMPLER_H
@@ -0,0 +1,320 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file scan_codec.c
+ * @brief Compact encoding of sweep scans for flash and the USB link.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#include "scan_codec.h"
+#include <string.h>
+
+/**
+ * @brief CRC-16/CCITT-FALSE of a buffer.
+ */
+static uint16_t scan_crc16(const uint8_t *bytes, size_t length) {
+    uint16_t crc = 0xFFFF;
+
+    while (length--) {
+        crc ^= (uint16_t)(*bytes++) << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static void put_u16(uint8_t *p, uint16_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t value) {
+    put_u16(p, (uint16_t)value);
+    put_u16(p + 2, (uint16_t)(value >> 16));
+}
+
+static uint16_t get_u16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p) {
+    return get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+/**
+ * @brief Append a signed residual as a zig-zag varint: small magnitudes of
+ * either sign take one byte per 7 bits.
+ */
+static void put_varint(scan_writer *w, int64_t value) {
+    uint64_t zz = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+
+    do {
+        uint8_t byte = (uint8_t)(zz & 0x7F);
+        zz >>= 7;
+        if (w->length >= w->capacity) {
+            w->failed = true;
+            return;
+        }
+        w->out[w->length++] = byte | (zz ? 0x80 : 0);
+    } while (zz);
+}
+
+/**
+ * @brief Read a zig-zag varint.
+ *
+ * @return false if it runs past end or is longer than any residual.
+ */
+static bool get_varint(const uint8_t **p, const uint8_t *end, int64_t *value) {
+    uint64_t zz = 0;
+
+    for (unsigned shift = 0; shift < 35; shift += 7) {
+        if (*p >= end) {
+            return false;
+        }
+        uint8_t byte = *(*p)++;
+        zz |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = (int64_t)(zz >> 1) ^ -(int64_t)(zz & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Index of the block a point falls in.
+ */
+static uint16_t block_of(uint16_t point) {
+    return point / SCAN_BLOCK_POINTS;
+}
+
+/**
+ * @brief Write the point count and CRC of the block being filled.
+ */
+static void close_block(scan_writer *w, uint8_t points) {
+    if (w->length + 2 > w->capacity) {
+        w->failed = true;
+        return;
+    }
+    w->out[w->block_start] = points;
+    put_u16(&w->out[w->length], scan_crc16(&w->out[w->block_start], w->length - w->block_start));
+    w->length += 2;
+}
+
+/**
+ * @brief Start an encoding of a known number of points.
+ *
+ * @param w        The encoder.
+ * @param out      Output buffer; SCAN_ENCODED_MAX(count) bytes always suffice.
+ * @param capacity Size of out.
+ * @param count    Points that will be added.
+ */
+void scan_writer_init(scan_writer *w, uint8_t *out, size_t capacity, uint16_t count) {
+    memset(w, 0, sizeof(*w));
+    w->out = out;
+    w->capacity = capacity;
+    w->count = count;
+    // Header, index and check are written by scan_writer_finish()
+    w->length = SCAN_HEADER_SIZE + 4 * SCAN_BLOCKS(count) + 2;
+    w->failed = w->length > capacity;
+}
+
+/**
+ * @brief Add the next point.
+ *
+ * @param w     The encoder.
+ * @param point The point.
+ */
+void scan_writer_add(scan_writer *w, const sweep_point *point) {
+    uint16_t in_block = w->added % SCAN_BLOCK_POINTS;
+    size_t data_start = SCAN_HEADER_SIZE + 4 * SCAN_BLOCKS(w->count) + 2;
+
+    if (w->failed || w->added >= w->count) {
+        w->failed = true;
+        return;
+    }
+
+    if (in_block == 0) {
+        if (w->added > 0) {
+            close_block(w, SCAN_BLOCK_POINTS);
+        }
+        if (w->failed || w->length >= w->capacity) {
+            w->failed = true;
+            return;
+        }
+        put_u32(&w->out[SCAN_HEADER_SIZE + 4 * block_of(w->added)], (uint32_t)(w->length - data_start));
+        w->block_start = w->length++;
+        w->last_angle = 0;
+        w->last_step = 0;
+        w->last_distance = 0;
+    }
+
+    put_varint(w, (int64_t)point->angle - ((int64_t)w->last_angle + w->last_step));
+    put_varint(w, (int64_t)point->distance - w->last_distance);
+    w->last_step = in_block ? point->angle - w->last_angle : 0;
+    w->last_angle = point->angle;
+    w->last_distance = point->distance;
+    w->added++;
+}
+
+/**
+ * @brief Close the last block and write the index.
+ *
+ * @param w The encoder.
+ * @return Bytes of the encoding, or 0 if the buffer was too small or the
+ *         number of points added differs from the count.
+ */
+size_t scan_writer_finish(scan_writer *w) {
+    uint16_t blocks = SCAN_BLOCKS(w->count);
+    size_t data_start = SCAN_HEADER_SIZE + 4 * blocks + 2;
+
+    if (w->failed || w->added != w->count) {
+        return 0;
+    }
+    if (w->added > 0) {
+        uint16_t last = w->added % SCAN_BLOCK_POINTS;
+        close_block(w, last ? last : SCAN_BLOCK_POINTS);
+        if (w->failed) {
+            return 0;
+        }
+    }
+
+    w->out[0] = SCAN_MAGIC_0;
+    w->out[1] = SCAN_MAGIC_1;
+    w->out[2] = SCAN_VERSION;
+    w->out[3] = SCAN_BLOCK_POINTS;
+    put_u16(&w->out[4], w->count);
+    put_u16(&w->out[6], blocks);
+    put_u32(&w->out[8], (uint32_t)(w->length - data_start));
+    put_u16(&w->out[data_start - 2], scan_crc16(w->out, data_start - 2));
+    return w->length;
+}
+
+/**
+ * @brief Check the header and index of an encoding.
+ *
+ * @param r      The decoder.
+ * @param data   The encoding; it must stay in place while r is used.
+ * @param length Bytes of the encoding.
+ * @return false if it is not a scan of this version or its index is damaged.
+ */
+bool scan_reader_open(scan_reader *r, const uint8_t *data, size_t length) {
+    memset(r, 0, sizeof(*r));
+    if (length < SCAN_HEADER_SIZE + 2 || data[0] != SCAN_MAGIC_0 || data[1] != SCAN_MAGIC_1 ||
+        data[2] != SCAN_VERSION || data[3] == 0) {
+        return false;
+    }
+
+    uint16_t count = get_u16(&data[4]);
+    uint16_t blocks = get_u16(&data[6]);
+    uint32_t blocks_length = get_u32(&data[8]);
+    size_t data_start = SCAN_HEADER_SIZE + 4 * (size_t)blocks + 2;
+
+    if (blocks != (count + data[3] - 1) / data[3] || data_start > length ||
+        blocks_length > length - data_start ||
+        get_u16(&data[data_start - 2]) != scan_crc16(data, data_start - 2)) {
+        return false;
+    }
+
+    r->data = data;
+    r->length = length;
+    r->count = count;
+    r->blocks = blocks;
+    r->block_points = data[3];
+    r->index = &data[SCAN_HEADER_SIZE];
+    r->blocks_start = &data[data_start];
+    r->blocks_length = blocks_length;
+    return true;
+}
+
+/**
+ * @brief Decode a block, keeping every point or only one.
+ *
+ * @param r      The decoder.
+ * @param block  Block number.
+ * @param points Output for every point, or NULL.
+ * @param want   With points NULL, the point in the block to keep.
+ * @param point  With points NULL, output for that point.
+ * @return Points in the block, or -1 if it is damaged.
+ */
+static int decode_block(const scan_reader *r, uint16_t block, sweep_point *points, uint16_t want,
+                        sweep_point *point) {
+    if (block >= r->blocks) {
+        return -1;
+    }
+    uint32_t offset = get_u32(&r->index[4 * block]);
+    if (offset >= r->blocks_length) {
+        return -1;
+    }
+
+    const uint8_t *start = r->blocks_start + offset;
+    const uint8_t *end = r->blocks_start + r->blocks_length;
+    const uint8_t *p = start + 1;
+    uint8_t n = *start;
+    uint32_t expected = (block + 1u == r->blocks) ? r->count - block * (uint32_t)r->block_points
+                                                   : r->block_points;
+    int64_t angle = 0;
+    int64_t step = 0;
+    int64_t distance = 0;
+
+    if (n != expected) {
+        return -1;
+    }
+    for (uint8_t i = 0; i < n; i++) {
+        int64_t da;
+        int64_t dd;
+        if (!get_varint(&p, end, &da) || !get_varint(&p, end, &dd)) {
+            return -1;
+        }
+        int64_t next = angle + step + da;
+        step = i ? next - angle : 0;
+        angle = next;
+        distance += dd;
+
+        sweep_point decoded = { (int32_t)angle, (uint16_t)distance };
+        if (points != NULL) {
+            points[i] = decoded;
+        } else if (i == want) {
+            *point = decoded;
+        }
+    }
+    if (p + 2 > end || get_u16(p) != scan_crc16(start, (size_t)(p - start))) {
+        return -1;
+    }
+    return n;
+}
+
+/**
+ * @brief Decode one block.
+ *
+ * @param r      The decoder.
+ * @param block  Block number, below r->blocks.
+ * @param points Output of at least r->block_points points.
+ * @return Points decoded, or -1 if the block is damaged.
+ */
+int scan_read_block(const scan_reader *r, uint16_t block, sweep_point *points) {
+    return decode_block(r, block, points, 0, NULL);
+}
+
+/**
+ * @brief Decode a single point, by decoding its block.
+ *
+ * @param r     The decoder.
+ * @param index Point number, below r->count.
+ * @param point Output point.
+ * @return false if the point's block is damaged.
+ */
+bool scan_read_point(const scan_reader *r, uint16_t index, sweep_point *point) {
+    if (index >= r->count) {
+        return false;
+    }
+    return decode_block(r, index / r->block_points, NULL, index % r->block_points, point) >= 0;
+}
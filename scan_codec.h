@@ -0,0 +1,158 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file scan_codec.h
+ * @brief Compact encoding of sweep scans for flash and the USB link.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Layout, little-endian:
+ *
+ *   header   'S' 'C', version, points per block, uint16_t points,
+ *            uint16_t blocks, uint32_t bytes of block data
+ *   index    uint32_t offset of each block in the block data
+ *   check    CRC-16 of the header and index
+ *   blocks   uint8_t points, then per point the angle and distance
+ *            residuals as zig-zag varints, then a CRC-16 of the block
+ *
+ * Each channel is predicted from the points before it in the same block:
+ * the angle from the last angle plus the last angle step, the distance from
+ * the last distance. A sweep at one point per degree leaves residuals of a
+ * few units, one byte each, so a point takes about two bytes against six
+ * raw. Every block starts from scratch, so any point can be reached by
+ * decoding only its own block, and a damaged block loses only its points.
+ *
+ * The host tools in tools/ build this file too; keep it free of SDK
+ * includes.
+ */
+#ifndef SCAN_CODEC_H
+#define SCAN_CODEC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sweep.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SCAN_MAGIC_0 ('S')
+#define SCAN_MAGIC_1 ('C')
+#define SCAN_VERSION (1)
+
+// Points per block; more packs tighter, fewer seeks faster
+#define SCAN_BLOCK_POINTS (32)
+
+#define SCAN_HEADER_SIZE (12)
+
+// Longest encoding of a point: a 5-byte angle and a 3-byte distance varint
+#define SCAN_POINT_MAX (8)
+
+// Blocks for a number of points
+#define SCAN_BLOCKS(points) (((points) + SCAN_BLOCK_POINTS - 1) / SCAN_BLOCK_POINTS)
+
+// Largest encoding of a number of points
+#define SCAN_ENCODED_MAX(points) \
+    (SCAN_HEADER_SIZE + 4 * SCAN_BLOCKS(points) + 2 + 3 * SCAN_BLOCKS(points) + SCAN_POINT_MAX * (points))
+
+/**
+ * @brief Encoder state. Points are added one at a time, so a sweep ring can
+ * be encoded without copying it.
+ */
+typedef struct {
+    uint8_t *out;
+    size_t capacity;
+    size_t length;          // Bytes written so far
+    uint16_t count;         // Points promised to scan_writer_init()
+    uint16_t added;         // Points added so far
+    size_t block_start;     // Offset of the current block
+    int32_t last_angle;
+    int32_t last_step;
+    uint16_t last_distance;
+    bool failed;            // Ran out of room or too many points
+} scan_writer;
+
+/**
+ * @brief Decoder state over a complete encoding.
+ */
+typedef struct {
+    const uint8_t *data;
+    size_t length;
+    uint16_t count;         // Points in the scan
+    uint16_t blocks;
+    uint8_t block_points;
+    const uint8_t *index;   // Offsets of the blocks
+    const uint8_t *blocks_start;
+    uint32_t blocks_length;
+} scan_reader;
+
+/**
+ * @brief Start an encoding of a known number of points.
+ *
+ * @param w        The encoder.
+ * @param out      Output buffer; SCAN_ENCODED_MAX(count) bytes always suffice.
+ * @param capacity Size of out.
+ * @param count    Points that will be added.
+ */
+void scan_writer_init(scan_writer *w, uint8_t *out, size_t capacity, uint16_t count);
+
+/**
+ * @brief Add the next point.
+ *
+ * @param w     The encoder.
+ * @param point The point.
+ */
+void scan_writer_add(scan_writer *w, const sweep_point *point);
+
+/**
+ * @brief Close the last block and write the index.
+ *
+ * @param w The encoder.
+ * @return Bytes of the encoding, or 0 if the buffer was too small or the
+ *         number of points added differs from the count.
+ */
+size_t scan_writer_finish(scan_writer *w);
+
+/**
+ * @brief Check the header and index of an encoding.
+ *
+ * @param r      The decoder.
+ * @param data   The encoding; it must stay in place while r is used.
+ * @param length Bytes of the encoding.
+ * @return false if it is not a scan of this version or its index is damaged.
+ */
+bool scan_reader_open(scan_reader *r, const uint8_t *data, size_t length);
+
+/**
+ * @brief Decode one block.
+ *
+ * @param r      The decoder.
+ * @param block  Block number, below r->blocks.
+ * @param points Output of at least r->block_points points.
+ * @return Points decoded, or -1 if the block is damaged.
+ */
+int scan_read_block(const scan_reader *r, uint16_t block, sweep_point *points);
+
+/**
+ * @brief Decode a single point, by decoding its block.
+ *
+ * @param r     The decoder.
+ * @param index Point number, below r->count.
+ * @param point Output point.
+ * @return false if the point's block is damaged.
+ */
+bool scan_read_point(const scan_reader *r, uint16_t index, sweep_point *point);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SCAN_CODEC_H
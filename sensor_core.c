@@ -0,0 +1,175 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file sensor_core.c
+ * @brief Sensor acquisition on core1, published to core0 as frames.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Frames go through a sample_ring: core1 never waits for core0, and a
+ * frame core0 was too slow to take is overwritten and counted.
+ */
+#include "sensor_core.h"
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/irq.h"
+#include "lidar.h"
+#include "mpu6050.h"
+#include "event.h"
+#include "sample_ring.h"
+#include "sampler.h"
+#include "profile.h"
+
+static sensor_frame frames[SENSOR_RING_SIZE];
+static uint32_t frame_seq[SENSOR_RING_SIZE];
+static sample_ring ring;
+
+// Core1 state between the IMU and LiDAR reads
+static sensor_frame frame;
+static int lidar_channel;
+
+/**
+ * @brief Publish a frame to core0 (core1 side).
+ *
+ * The FIFO push is skipped when the FIFO is full: core0 drains it in one
+ * go, so one pending word is enough to wake it.
+ */
+static void publish(const sensor_frame *frame) {
+    sample_ring_push(&ring, frame);
+
+    if (multicore_fifo_wready()) {
+        multicore_fifo_push_blocking(frame->seq);
+    }
+}
+
+/**
+ * @brief IMU channel: keep the newest yaw rate and tilt for the next frame.
+ *
+ * The reading carries its own scheduled time, so yaw integration uses the
+ * interval between IMU reads rather than between LiDAR reads.
+ */
+static void sample_imu(uint64_t scheduled_us) {
+    frame.imu_time_us = scheduled_us;
+    frame.yaw_rate = read_yaw_rate();
+    read_tilt_angle(frame.tilt);
+}
+
+/**
+ * @brief LiDAR channel: complete the frame and publish it.
+ *
+ * The frame is stamped with its scheduled time, so consecutive frames are
+ * a whole number of periods apart whatever the I2C latency.
+ */
+static void sample_lidar(uint64_t scheduled_us) {
+    frame.time_us = scheduled_us;
+    frame.distance = read_lidar();
+    publish(&frame);
+    frame.seq++;
+}
+
+/**
+ * @brief Sampling loop run on core1.
+ */
+static void sensor_core_main(void) {
+    // SysTick is per core; the sensor probes run here
+    profile_init();
+
+    // Let core0 pause this core while it writes the journal to flash
+    multicore_lockout_victim_init();
+
+    // The IMU is added first so it is read before a LiDAR read due together
+    sampler_add(SENSOR_IMU_PERIOD_US, sample_imu);
+    lidar_channel = sampler_add(SENSOR_PERIOD_US, sample_lidar);
+    sampler_run();
+}
+
+/**
+ * @brief FIFO interrupt on core0: turn frame signals into one event.
+ */
+static void sensor_fifo_irq(void) {
+    uint32_t seq = 0;
+
+    while (multicore_fifo_rvalid()) {
+        seq = multicore_fifo_pop_blocking();
+    }
+    multicore_fifo_clear_irq();
+    event_post(EVENT_SENSOR_FRAME, seq);
+}
+
+/**
+ * @brief Launch the sampling loop on core1.
+ */
+void sensor_core_start(void) {
+    sample_ring_init(&ring, frame_seq, frames, SENSOR_RING_SIZE, sizeof(sensor_frame));
+    frame = (sensor_frame){0};
+
+    // The launch handshake uses the FIFO, so the IRQ is enabled afterwards
+    multicore_launch_core1(sensor_core_main);
+    multicore_fifo_drain();
+    multicore_fifo_clear_irq();
+    irq_set_exclusive_handler(SIO_IRQ_PROC0, sensor_fifo_irq);
+    irq_set_enabled(SIO_IRQ_PROC0, true);
+}
+
+/**
+ * @brief Take the oldest unread frame.
+ *
+ * @param frame Output frame.
+ * @return false if no frame is waiting.
+ */
+bool sensor_next(sensor_frame *frame) {
+    return sample_ring_next(&ring, frame);
+}
+
+/**
+ * @brief Take the newest frame and discard the older unread ones.
+ *
+ * @param frame Output frame.
+ * @return false if no frame has arrived since the last call.
+ */
+bool sensor_latest(sensor_frame *frame) {
+    if (sample_ring_pending(&ring) == 0) {
+        return false;
+    }
+    sample_ring_skip(&ring);
+    return sample_ring_latest(&ring, frame);
+}
+
+/**
+ * @brief Discard all unread frames.
+ */
+void sensor_flush(void) {
+    sample_ring_skip(&ring);
+}
+
+/**
+ * @brief Number of frames overwritten before core0 took them.
+ *
+ * @return The overrun count since start.
+ */
+uint32_t sensor_overruns(void) {
+    return ring.lost;
+}
+
+/**
+ * @brief Read the frame timing statistics.
+ *
+ * @param stats Output statistics of the LiDAR channel.
+ */
+void sensor_get_timing(sampler_stats *stats) {
+    sampler_get_stats(lidar_channel, stats);
+}
+
+/**
+ * @brief Restart the frame timing statistics.
+ */
+void sensor_reset_timing(void) {
+    sampler_reset_stats(lidar_channel);
+}
@@ -0,0 +1,101 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file sensor_core.h
+ * @brief Sensor acquisition on core1, published to core0 as frames.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Once sensor_core_start() has run, core1 owns i2c0 (LiDAR) and i2c1
+ * (MPU6050); core0 must only read sensors through the frame functions.
+ */
+#ifndef SENSOR_CORE_H
+#define SENSOR_CORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sampler.h"
+
+// Frame period; matches the TF-Luna default frame rate (100 Hz)
+#define SENSOR_PERIOD_US (10000)
+
+// IMU read period; yaw is integrated once per frame against the IMU
+// read's own timestamp, so keep it at or below SENSOR_PERIOD_US
+#define SENSOR_IMU_PERIOD_US (SENSOR_PERIOD_US)
+
+// Frames kept for core0; a power of two
+#define SENSOR_RING_SIZE (64)
+
+/**
+ * @brief One set of sensor readings taken together on core1.
+ */
+typedef struct {
+    uint64_t time_us;       // Scheduled time of the frame; first, as sample_ring requires
+    uint32_t seq;           // Frame number since start
+    uint16_t distance;      // LiDAR distance in centimeters
+    int16_t tilt[3];        // Tilt angles from read_tilt_angle()
+    int32_t yaw_rate;       // Yaw rate in hundredths of a degree per second
+    uint64_t imu_time_us;   // Scheduled time of the IMU read of yaw_rate and tilt
+} sensor_frame;
+
+/**
+ * @brief Launch the sampling loop on core1.
+ *
+ * Core1 publishes a frame every SENSOR_PERIOD_US and signals it through
+ * the multicore FIFO; core0 turns the signal into EVENT_SENSOR_FRAME.
+ * The sensors must be initialized before this is called.
+ */
+void sensor_core_start(void);
+
+/**
+ * @brief Take the oldest unread frame.
+ *
+ * For consumers that need every frame, such as the sweep integration.
+ *
+ * @param frame Output frame.
+ * @return false if no frame is waiting.
+ */
+bool sensor_next(sensor_frame *frame);
+
+/**
+ * @brief Take the newest frame and discard the older unread ones.
+ *
+ * For consumers that only display the current value.
+ *
+ * @param frame Output frame.
+ * @return false if no frame has arrived since the last call.
+ */
+bool sensor_latest(sensor_frame *frame);
+
+/**
+ * @brief Discard all unread frames.
+ */
+void sensor_flush(void);
+
+/**
+ * @brief Number of frames overwritten before core0 took them.
+ *
+ * @return The overrun count since start.
+ */
+uint32_t sensor_overruns(void);
+
+/**
+ * @brief Read the frame timing statistics.
+ *
+ * @param stats Output statistics of the LiDAR channel.
+ */
+void sensor_get_timing(sampler_stats *stats);
+
+/**
+ * @brief Restart the frame timing statistics.
+ */
+void sensor_reset_timing(void);
+
+#endif // SENSOR_CORE_H
@@ -15,11 +15,28 @@
  */
 #include "spi_code.h"
 #include "pico/stdlib.h"
+#include "hardware/clocks.h"
 #include "oled.h"
+#include "clock_profile.h"
+#include "profile.h"
+#include "ram_code.h"
 
 // Constant for byte size
 #define BYTE_SIZE (8)
 
+// Hardware SPI bit rate, about what the fixed dividers gave at 125 MHz
+#define SPI_BAUD_HZ (1000 * 1000)
+
+// Bit-bang timing, with margin over the SH1107's 4-wire SPI minimums
+#define SPI_SETUP_NS (100)      // Data valid before the rising edge
+#define SPI_HIGH_NS (150)       // Clock high
+#define SPI_HOLD_NS (150)       // Data held after the falling edge, clock low
+
+// Bit-bang delays in processor cycles, set from the clock at init
+static uint32_t setup_cycles;
+static uint32_t high_cycles;
+static uint32_t hold_cycles;
+
 /**
  * @brief Writes data to the SPI module.
  *
@@ -27,7 +44,7 @@
  * @param data  Pointer to the data buffer.
  * @param len   Number of bytes to write.
  */
-void SPI_write(spi_hw_t *spi, const uint8_t *data, size_t len) {
+void RAM_FUNC(SPI_write)(spi_hw_t *spi, const uint8_t *data, size_t len) {
     for (size_t i = 0; i < len; ++i) {
         // Wait for transmit FIFO not full (TNF)
         while (!(spi->sr & SPI_SSPSR_TNF_BITS));
@@ -47,7 +64,7 @@ void SPI_write(spi_hw_t *spi, const uint8_t *data, size_t len) {
  *
  * @param data  The command to write.
  */
-void SPI_WriteCommand(const uint8_t data) {
+void RAM_FUNC(SPI_WriteCommand)(const uint8_t data) {
     // Set DC pin low to indicate command mode
     sio_hw->gpio_clr = SET_SPI_DC_PIN;
 
@@ -66,7 +83,7 @@ void SPI_WriteCommand(const uint8_t data) {
  *
  * @param data  The data to write.
  */
-void SPI_WriteData(const uint8_t data) {
+void RAM_FUNC(SPI_WriteData)(const uint8_t data) {
     // Set DC pin high to indicate data mode
     sio_hw->gpio_set = SET_SPI_DC_PIN;
 
@@ -83,19 +100,36 @@ void SPI_WriteData(const uint8_t data) {
 
 /**
  * @brief Initializes the SPI module with the specified configuration.
+ *
+ * The bit rate is clk_peri / (prescale * postdiv). Both are worked out from
+ * the current clk_peri for the fastest rate not above SPI_BAUD_HZ, so it
+ * holds at any clock profile.
  */
 void SPI_Module_Init() {
     // Get a pointer to the SPI hardware
     spi_hw_t *spi = spi0_hw;
+    uint32_t freq = clock_get_hz(clk_peri);
 
     // Disable the SPI
     spi->cr1 &= ~SPI_SSPCR1_SSE_BITS;
 
-    // Set prescalar and postdiv for baud rate
-    uint8_t prescalar = 2;
-    uint16_t postdiv = 63;
+    // Smallest even prescale that lets the post-divider reach the rate
+    uint32_t prescalar;
+    for (prescalar = 2; prescalar < 254; prescalar += 2) {
+        if (freq < (uint64_t)(prescalar + 2) * 256 * SPI_BAUD_HZ) {
+            break;
+        }
+    }
+
+    // Then the smallest post-divider that does not overshoot it
+    uint32_t postdiv;
+    for (postdiv = 1; postdiv < 256; postdiv++) {
+        if ((uint64_t)prescalar * postdiv * SPI_BAUD_HZ >= freq) {
+            break;
+        }
+    }
     spi->cpsr = prescalar;
-    spi->cr0 |= (postdiv - 1) << 8;
+    spi->cr0 = (postdiv - 1) << SPI_SSPCR0_SCR_LSB;
 
     // Configure data format (8 data bits, cpol, cpha)
     uint8_t data_bits = 8;
@@ -116,8 +150,16 @@ void SPI_Module_Init() {
 
 /**
  * @brief Initializes the SPI module for bit-banging mode.
+ *
+ * The delays between pin changes are converted to cycles of the current
+ * clk_sys, so a faster clock shortens the code between edges but not the
+ * edges themselves.
  */
 void SPI_Module_Init_BIT_BANGING() {
+    setup_cycles = clock_ns_to_cycles(SPI_SETUP_NS);
+    high_cycles = clock_ns_to_cycles(SPI_HIGH_NS);
+    hold_cycles = clock_ns_to_cycles(SPI_HOLD_NS);
+
     // Set GPIO functions for SPI pins
     iobank0_hw->io[SPI_SCK_PIN].ctrl = GPIO_FUNC_SIO << IO_BANK0_GPIO0_CTRL_FUNCSEL_LSB;
     iobank0_hw->io[SPI_TX_PIN].ctrl = GPIO_FUNC_SIO << IO_BANK0_GPIO0_CTRL_FUNCSEL_LSB;
@@ -148,7 +190,9 @@ void SPI_Module_Init_BIT_BANGING() {
  * 
  * @param data The byte of data to be sent.
  */
-void SPI_send_byte(uint8_t data) {
+void RAM_FUNC(SPI_send_byte)(uint8_t data) {
+    PROFILE_START(PROFILE_SPI_SEND_BYTE);
+
     // Reverse the bits of the data byte
     data = reverse(data);
 
@@ -166,27 +210,25 @@ void SPI_send_byte(uint8_t data) {
             sio_hw->gpio_clr = (1ul << SPI_TX_PIN);
         }
 
-        // Wait for a short duration
-        sleep_us(5);
+        // Let the data settle before the rising edge
+        busy_wait_at_least_cycles(setup_cycles);
 
         // Set the SPI clock signal high
         sio_hw->gpio_set = (1ul << SPI_SCK_PIN);
 
-        // Wait for a short duration
-        sleep_us(10);
+        // Hold the clock high
+        busy_wait_at_least_cycles(high_cycles);
 
         // Clear the SPI clock signal
         sio_hw->gpio_clr = (1ul << SPI_SCK_PIN);
 
-        // Wait for a short duration
-        sleep_us(5);
+        // Hold the data past the falling edge
+        busy_wait_at_least_cycles(hold_cycles);
 
         // Shift to the next bit
         data = data >> 1;
-
-        // Wait for a short duration
-        sleep_us(2);
     }
+    PROFILE_STOP(PROFILE_SPI_SEND_BYTE);
 }
 
 
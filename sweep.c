@@ -0,0 +1,328 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file sweep.c
+ * @brief Polar sweep scan: yaw-tagged LiDAR points and the room outline.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#include "sweep.h"
+#include <string.h>
+
+#define US_PER_SECOND (1000000)
+
+/**
+ * @brief Start a new sweep.
+ *
+ * @param scan      The sweep state to reset.
+ * @param gyro_bias Yaw rate measured at rest, subtracted from every sample.
+ * @param now_us    Current time in microseconds.
+ */
+void sweep_init(sweep_scan *scan, int32_t gyro_bias, uint64_t now_us) {
+    memset(scan, 0, sizeof(*scan));
+    scan->gyro_bias = gyro_bias;
+    scan->last_us = now_us;
+}
+
+/**
+ * @brief Integrate one gyroscope sample into the sweep yaw.
+ *
+ * The product rate * dt is accumulated without dividing so no truncation
+ * drift builds up over a long sweep.
+ *
+ * @param scan   The sweep state.
+ * @param rate   Yaw rate in hundredths of a degree per second.
+ * @param now_us Timestamp of the sample in microseconds.
+ */
+void sweep_update_yaw(sweep_scan *scan, int32_t rate, uint64_t now_us) {
+    int64_t dt = (int64_t)(now_us - scan->last_us);
+    scan->last_us = now_us;
+    scan->yaw_acc += (int64_t)(rate - scan->gyro_bias) * dt;
+}
+
+/**
+ * @brief Current integrated yaw.
+ *
+ * @param scan The sweep state.
+ * @return Yaw since sweep_init in hundredths of a degree.
+ */
+int32_t sweep_yaw(const sweep_scan *scan) {
+    return (int32_t)(scan->yaw_acc / US_PER_SECOND);
+}
+
+/**
+ * @brief Pair a LiDAR distance with the current yaw.
+ *
+ * @param scan     The sweep state.
+ * @param distance Distance in centimeters.
+ * @return true if the point was stored.
+ */
+bool sweep_add_sample(sweep_scan *scan, uint16_t distance) {
+    int32_t yaw = sweep_yaw(scan);
+    int32_t step = yaw - scan->last_stored_angle;
+
+    // Skip readings with no valid return
+    if (distance < SWEEP_MIN_RANGE_CM || distance > SWEEP_MAX_RANGE_CM) {
+        return false;
+    }
+
+    // Keep at most one point per SWEEP_MIN_STEP of rotation
+    if (scan->count > 0 && step < SWEEP_MIN_STEP && step > -SWEEP_MIN_STEP) {
+        return false;
+    }
+
+    scan->points[scan->head].angle = yaw;
+    scan->points[scan->head].distance = distance;
+    scan->head = (scan->head + 1) % SWEEP_MAX_POINTS;
+    if (scan->count < SWEEP_MAX_POINTS) {
+        scan->count++;
+    }
+    scan->last_stored_angle = yaw;
+    return true;
+}
+
+/**
+ * @brief Access a stored point, oldest first.
+ *
+ * @param scan  The sweep state.
+ * @param index Index in [0, scan->count).
+ * @return Pointer to the point.
+ */
+const sweep_point *sweep_point_at(const sweep_scan *scan, uint16_t index) {
+    uint16_t oldest = (scan->head + SWEEP_MAX_POINTS - scan->count) % SWEEP_MAX_POINTS;
+    return &scan->points[(oldest + index) % SWEEP_MAX_POINTS];
+}
+
+/**
+ * @brief Convert a scan point to Cartesian coordinates.
+ *
+ * @param point The scan point.
+ * @param x     Output X in hundredths of a centimeter.
+ * @param y     Output Y in hundredths of a centimeter.
+ */
+void sweep_point_xy(const sweep_point *point, int32_t *x, int32_t *y) {
+    int64_t r = (int64_t)point->distance * FX_SCALE;
+    *x = (int32_t)((r * fx_cos(point->angle)) / FX_TRIG_ONE);
+    *y = (int32_t)((r * fx_sin(point->angle)) / FX_TRIG_ONE);
+}
+
+/**
+ * @brief Build the room outline polygon from the stored points.
+ *
+ * The area comes from the shoelace formula over the points in sweep order,
+ * closed back to the first point. Coordinates are in hundredths of a
+ * centimeter, so twice the area is in 1e-4 cm^2.
+ *
+ * @param scan The sweep state.
+ * @return Area and perimeter of the closed polygon through all points.
+ */
+sweep_outline sweep_compute_outline(const sweep_scan *scan) {
+    sweep_outline outline = {0};
+    int64_t twice_area = 0;
+    int64_t perimeter = 0;
+    int32_t x0, y0, x_prev, y_prev;
+
+    if (scan->count < 3) {
+        return outline;
+    }
+
+    sweep_point_xy(sweep_point_at(scan, 0), &x0, &y0);
+    x_prev = x0;
+    y_prev = y0;
+
+    for (uint16_t i = 1; i <= scan->count; i++) {
+        int32_t x, y;
+
+        // The last edge closes the polygon back to the first point
+        if (i == scan->count) {
+            x = x0;
+            y = y0;
+        } else {
+            sweep_point_xy(sweep_point_at(scan, i), &x, &y);
+        }
+
+        int64_t dx = x - x_prev;
+        int64_t dy = y - y_prev;
+        twice_area += (int64_t)x_prev * y - (int64_t)x * y_prev;
+        perimeter += fx_isqrt64((uint64_t)(dx * dx + dy * dy));
+
+        x_prev = x;
+        y_prev = y;
+    }
+
+    // Sweeping clockwise gives a negative signed area
+    if (twice_area < 0) {
+        twice_area = -twice_area;
+    }
+
+    // 1e-4 cm^2 to 1e-2 cm^2, including the shoelace factor of one half
+    outline.area = (twice_area + FX_SCALE) / (2 * FX_SCALE);
+    outline.perimeter = (fx_length_t)perimeter;
+    outline.points = scan->count;
+    return outline;
+}
+
+/**
+ * @brief Reset a streaming integrator.
+ *
+ * @param integrator The integrator state.
+ */
+void sweep_integrator_init(sweep_integrator *integrator) {
+    memset(integrator, 0, sizeof(*integrator));
+}
+
+/**
+ * @brief Median distance of the filter window.
+ */
+static uint16_t window_median(const sweep_point *window) {
+    uint16_t sorted[SWEEP_MEDIAN_WINDOW];
+
+    // Insertion sort; the window is only a handful of samples
+    for (int i = 0; i < SWEEP_MEDIAN_WINDOW; i++) {
+        int j = i;
+        while (j > 0 && sorted[j - 1] > window[i].distance) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = window[i].distance;
+    }
+    return sorted[SWEEP_MEDIAN_WINDOW / 2];
+}
+
+/**
+ * @brief Length of the wall segment between two samples.
+ *
+ * By the law of cosines the segment is sqrt(r1^2 + r2^2 - 2 * r1 * r2 * cos(d)).
+ *
+ * @return Length in hundredths of a centimeter.
+ */
+static uint32_t chord_length(const sweep_point *from, const sweep_point *to) {
+    int64_t r1 = from->distance;
+    int64_t r2 = to->distance;
+
+    // Squared length in Q15 cm^2, clamped against rounding below zero
+    int64_t chord_q15 = (r1 * r1 + r2 * r2) * FX_TRIG_ONE - 2 * r1 * r2 * fx_cos(to->angle - from->angle);
+    if (chord_q15 < 0) {
+        chord_q15 = 0;
+    }
+    return fx_isqrt64((uint64_t)(chord_q15 * FX_SCALE * FX_SCALE / FX_TRIG_ONE));
+}
+
+/**
+ * @brief Add the step between two consecutive samples.
+ *
+ * The triangle between the device and the two samples has area
+ * r1 * r2 * sin(d) / 2, which reduces to r^2 * d / 2 for small steps; using
+ * the exact triangle bridges wide steps (gaps) with a straight wall instead
+ * of an arc. The perimeter only advances once the yaw has moved
+ * SWEEP_PERIMETER_STEP past the last perimeter vertex.
+ */
+static void integrate_step(sweep_integrator *integrator, const sweep_point *from, const sweep_point *to) {
+    int32_t step = to->angle - from->angle;
+    int32_t span = to->angle - integrator->anchor.angle;
+
+    if (step > SWEEP_MAX_STEP || step < -SWEEP_MAX_STEP) {
+        integrator->gaps++;
+    }
+
+    integrator->twice_area += (int64_t)from->distance * to->distance * fx_sin(step);
+
+    if (span >= SWEEP_PERIMETER_STEP || span <= -SWEEP_PERIMETER_STEP || integrator->closed) {
+        integrator->perimeter += chord_length(&integrator->anchor, to);
+        integrator->anchor = *to;
+    }
+}
+
+/**
+ * @brief Integrate one LiDAR/yaw pair.
+ *
+ * @param integrator The integrator state.
+ * @param angle      Yaw in hundredths of a degree.
+ * @param distance   Distance in centimeters.
+ * @return true once the sweep is closed.
+ */
+bool sweep_integrator_add(sweep_integrator *integrator, int32_t angle, uint16_t distance) {
+    if (integrator->closed) {
+        return true;
+    }
+
+    // Skip readings with no valid return
+    if (distance < SWEEP_MIN_RANGE_CM || distance > SWEEP_MAX_RANGE_CM) {
+        return false;
+    }
+
+    // Slide the filter window
+    for (int i = 0; i < SWEEP_MEDIAN_WINDOW - 1; i++) {
+        integrator->window[i] = integrator->window[i + 1];
+    }
+    integrator->window[SWEEP_MEDIAN_WINDOW - 1].angle = angle;
+    integrator->window[SWEEP_MEDIAN_WINDOW - 1].distance = distance;
+    if (integrator->window_count < SWEEP_MEDIAN_WINDOW) {
+        integrator->window_count++;
+    }
+    if (integrator->window_count < SWEEP_MEDIAN_WINDOW) {
+        return false;
+    }
+
+    // The filtered sample takes the median distance at the middle sample's yaw
+    sweep_point sample = integrator->window[SWEEP_MEDIAN_WINDOW / 2];
+    sample.distance = window_median(integrator->window);
+    if (sample.distance != integrator->window[SWEEP_MEDIAN_WINDOW / 2].distance) {
+        integrator->outliers++;
+    }
+
+    if (integrator->samples == 0) {
+        integrator->first = sample;
+        integrator->prev = sample;
+        integrator->anchor = sample;
+        integrator->samples = 1;
+        return false;
+    }
+
+    int32_t turned = sample.angle - integrator->first.angle;
+    if (turned >= FX_FULL_TURN || turned <= -FX_FULL_TURN) {
+        // Close with the wedge from the last sample inside the turn to the
+        // first sample one turn later. prev is short of a full turn, so this
+        // step is less than a full turn in the direction of rotation, and
+        // the sample that overshot is dropped
+        sweep_point closing = integrator->first;
+        closing.angle += (turned > 0) ? FX_FULL_TURN : -FX_FULL_TURN;
+        integrator->closed = true;
+        integrate_step(integrator, &integrator->prev, &closing);
+        return true;
+    }
+
+    integrate_step(integrator, &integrator->prev, &sample);
+    integrator->prev = sample;
+    integrator->samples++;
+    return false;
+}
+
+/**
+ * @brief Area and perimeter integrated so far.
+ *
+ * @param integrator The integrator state.
+ * @return The outline; final once the integrator is closed.
+ */
+sweep_outline sweep_integrator_result(const sweep_integrator *integrator) {
+    sweep_outline outline = {0};
+    int64_t twice_area = integrator->twice_area;
+
+    // Sweeping clockwise gives a negative signed area
+    if (twice_area < 0) {
+        twice_area = -twice_area;
+    }
+
+    // Q15 cm^2 to hundredths of a cm^2, including the factor of one half
+    outline.area = (twice_area * (FX_SCALE / 2) + FX_TRIG_ONE / 2) / FX_TRIG_ONE;
+    outline.perimeter = (fx_length_t)integrator->perimeter;
+    outline.points = integrator->samples;
+    return outline;
+}
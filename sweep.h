@@ -0,0 +1,199 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file sweep.h
+ * @brief Polar sweep scan: yaw-tagged LiDAR points and the room outline.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fixed_point.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Capacity of the scan point ring
+#define SWEEP_MAX_POINTS (400)
+
+// Minimum yaw change between stored points (one point per degree)
+#define SWEEP_MIN_STEP (FX_DEGREE)
+
+// Valid TF-Luna range; readings outside it are treated as no return
+#define SWEEP_MIN_RANGE_CM (20)
+#define SWEEP_MAX_RANGE_CM (1200)
+
+// Yaw step above which consecutive samples are counted as a coverage gap
+#define SWEEP_MAX_STEP (15 * FX_DEGREE)
+
+// Median filter length; rejects spikes up to half the window minus one long
+#define SWEEP_MEDIAN_WINDOW (5)
+
+// Yaw spacing of perimeter vertices; finer steps would sum LiDAR
+// quantization noise into the wall length
+#define SWEEP_PERIMETER_STEP (5 * FX_DEGREE)
+
+/**
+ * @brief One scan point: yaw angle and measured distance.
+ */
+typedef struct {
+    int32_t angle;      // Yaw in hundredths of a degree
+    uint16_t distance;  // Distance in centimeters
+} sweep_point;
+
+/**
+ * @brief State of a sweep in progress.
+ */
+typedef struct {
+    sweep_point points[SWEEP_MAX_POINTS];
+    uint16_t head;              // Next slot to write
+    uint16_t count;             // Number of valid points
+    int64_t yaw_acc;            // Integrated yaw in centidegree-microseconds per second
+    int32_t gyro_bias;          // Yaw rate at rest in centidegrees per second
+    int32_t last_stored_angle;  // Yaw of the most recently stored point
+    uint64_t last_us;           // Timestamp of the last yaw update
+} sweep_scan;
+
+/**
+ * @brief Room outline derived from a completed sweep.
+ */
+typedef struct {
+    fx_area_t area;         // Enclosed area in hundredths of a square centimeter
+    fx_length_t perimeter;  // Perimeter in hundredths of a centimeter
+    uint16_t points;        // Number of outline vertices
+} sweep_outline;
+
+/**
+ * @brief Streaming area/perimeter integrator for a sweep in progress.
+ *
+ * Holds only the last SWEEP_MEDIAN_WINDOW samples, so memory use does not
+ * depend on the sweep length.
+ */
+typedef struct {
+    sweep_point window[SWEEP_MEDIAN_WINDOW];  // Last raw samples for the median filter
+    uint8_t window_count;       // Number of valid entries in window
+    sweep_point first;          // First filtered sample of the sweep
+    sweep_point prev;           // Previous filtered sample
+    sweep_point anchor;         // Last perimeter vertex
+    uint32_t samples;           // Filtered samples integrated so far
+    int64_t twice_area;         // Signed twice the area in Q15 cm^2
+    int64_t perimeter;          // Perimeter in hundredths of a centimeter
+    uint16_t outliers;          // Samples replaced by the median filter
+    uint16_t gaps;              // Steps wider than SWEEP_MAX_STEP
+    bool closed;                // Set once a full turn has been integrated
+} sweep_integrator;
+
+/**
+ * @brief Start a new sweep.
+ *
+ * @param scan      The sweep state to reset.
+ * @param gyro_bias Yaw rate measured at rest, subtracted from every sample.
+ * @param now_us    Current time in microseconds.
+ */
+void sweep_init(sweep_scan *scan, int32_t gyro_bias, uint64_t now_us);
+
+/**
+ * @brief Integrate one gyroscope sample into the sweep yaw.
+ *
+ * @param scan   The sweep state.
+ * @param rate   Yaw rate in hundredths of a degree per second.
+ * @param now_us Timestamp of the sample in microseconds.
+ */
+void sweep_update_yaw(sweep_scan *scan, int32_t rate, uint64_t now_us);
+
+/**
+ * @brief Current integrated yaw.
+ *
+ * @param scan The sweep state.
+ * @return Yaw since sweep_init in hundredths of a degree.
+ */
+int32_t sweep_yaw(const sweep_scan *scan);
+
+/**
+ * @brief Pair a LiDAR distance with the current yaw.
+ *
+ * The point is stored only if the distance is in range and the yaw has
+ * moved at least SWEEP_MIN_STEP since the previous stored point.
+ *
+ * @param scan     The sweep state.
+ * @param distance Distance in centimeters.
+ * @return true if the point was stored.
+ */
+bool sweep_add_sample(sweep_scan *scan, uint16_t distance);
+
+/**
+ * @brief Access a stored point, oldest first.
+ *
+ * @param scan  The sweep state.
+ * @param index Index in [0, scan->count).
+ * @return Pointer to the point.
+ */
+const sweep_point *sweep_point_at(const sweep_scan *scan, uint16_t index);
+
+/**
+ * @brief Convert a scan point to Cartesian coordinates.
+ *
+ * @param point The scan point.
+ * @param x     Output X in hundredths of a centimeter.
+ * @param y     Output Y in hundredths of a centimeter.
+ */
+void sweep_point_xy(const sweep_point *point, int32_t *x, int32_t *y);
+
+/**
+ * @brief Build the room outline polygon from the stored points.
+ *
+ * The firmware uses the streaming integrator below; this batch version is
+ * the reference tools/kernel_bench times it against.
+ *
+ * @param scan The sweep state.
+ * @return Area and perimeter of the closed polygon through all points.
+ */
+sweep_outline sweep_compute_outline(const sweep_scan *scan);
+
+/**
+ * @brief Reset a streaming integrator.
+ *
+ * @param integrator The integrator state.
+ */
+void sweep_integrator_init(sweep_integrator *integrator);
+
+/**
+ * @brief Integrate one LiDAR/yaw pair.
+ *
+ * Each sample passes a SWEEP_MEDIAN_WINDOW median filter to drop short
+ * spikes, then adds the triangle between it, the previous sample and the
+ * device to the running area. When the yaw has advanced a full turn the
+ * closing wedge back to the first sample is added and the integrator
+ * closes; later samples are ignored.
+ *
+ * @param integrator The integrator state.
+ * @param angle      Yaw in hundredths of a degree.
+ * @param distance   Distance in centimeters.
+ * @return true once the sweep is closed.
+ */
+bool sweep_integrator_add(sweep_integrator *integrator, int32_t angle, uint16_t distance);
+
+/**
+ * @brief Area and perimeter integrated so far.
+ *
+ * @param integrator The integrator state.
+ * @return The outline; final once the integrator is closed.
+ */
+sweep_outline sweep_integrator_result(const sweep_integrator *integrator);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SWEEP_H
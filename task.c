@@ -0,0 +1,164 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file task.c
+ * @brief Cooperative task scheduler for core0.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#include "task.h"
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "event.h"
+#include "trace.h"
+#include "log.h"
+
+static task *tasks[TASK_MAX];
+static uint8_t task_count;
+
+static task *current;           // Innermost task with a step on the stack
+static uint64_t slice_start_us; // Start of the current task's slice
+
+/**
+ * @brief Close the current slice of a task and account for it.
+ */
+static void end_slice(task *t, uint64_t now_us) {
+    uint32_t us = (uint32_t)(now_us - slice_start_us);
+
+    t->stats.slices++;
+    t->stats.total_us += us;
+    if (us > t->stats.max_us) {
+        t->stats.max_us = us;
+    }
+    if (us > t->budget_us) {
+        t->stats.overruns++;
+    }
+}
+
+/**
+ * @brief Run one step of a task.
+ *
+ * A task stepped from inside another task's wait splits the outer task's
+ * slice, so each slice only covers the outer task's own work.
+ */
+static task_status step(task *t) {
+    task *outer = current;
+    uint64_t now_us = time_us_64();
+    task_status status;
+
+    if (outer != NULL) {
+        end_slice(outer, now_us);
+    }
+    current = t;
+    t->running = true;
+    slice_start_us = now_us;
+
+    TRACE_SPAN_BEGIN(t->trace_id, 0);
+    status = t->fn(t);
+    TRACE_SPAN_END(t->trace_id);
+
+    now_us = time_us_64();
+    end_slice(t, now_us);
+    t->running = false;
+    t->done = (status == TASK_DONE);
+    current = outer;
+    slice_start_us = now_us;
+    return status;
+}
+
+/**
+ * @brief Step every task that is not already on the stack.
+ *
+ * @return true if a task has more work ready.
+ */
+static bool poll_tasks(void) {
+    bool busy = false;
+
+    for (uint8_t i = 0; i < task_count; i++) {
+        if (!tasks[i]->running && !tasks[i]->done && step(tasks[i]) == TASK_YIELDED) {
+            busy = true;
+        }
+    }
+    return busy;
+}
+
+/**
+ * @brief Idle hook for event_wait(): run the other tasks, else sleep.
+ *
+ * The sleep is kept out of the waiting task's slice.
+ */
+static void task_idle(void) {
+    if (poll_tasks()) {
+        return;
+    }
+    if (current != NULL) {
+        end_slice(current, time_us_64());
+    }
+    event_sleep();
+    slice_start_us = time_us_64();
+}
+
+/**
+ * @brief Register a task; it is stepped in the order tasks were added.
+ *
+ * @param t The task.
+ * @return false if TASK_MAX tasks are registered already.
+ */
+bool task_add(task *t) {
+    if (task_count >= TASK_MAX) {
+        return false;
+    }
+    t->lc = 0;
+    t->running = false;
+    t->done = false;
+    t->stats = (task_stats){0};
+    tasks[task_count++] = t;
+    return true;
+}
+
+/**
+ * @brief Run the tasks forever, sleeping when none has work.
+ */
+void task_run(void) {
+    event_set_idle_hook(task_idle);
+
+    while (true) {
+        if (!poll_tasks()) {
+            event_sleep();
+        }
+    }
+}
+
+/**
+ * @brief Let the other tasks run in the middle of a long piece of work.
+ *
+ * Stepping them splits the caller's slice, as in task_idle().
+ */
+void task_pause(void) {
+    poll_tasks();
+}
+
+/**
+ * @brief Print the statistics of every task and restart them.
+ *
+ * @param elapsed_us Length of the window, for the CPU share.
+ */
+void task_report(uint64_t elapsed_us) {
+    for (uint8_t i = 0; i < task_count; i++) {
+        task_stats *s = &tasks[i]->stats;
+        uint32_t cpu_permille = elapsed_us ? (uint32_t)(s->total_us * 1000 / elapsed_us) : 0;
+
+        LOG_INFO("Task %-6s cpu %lu.%lu%%, max slice %lu us of %lu, %lu overruns\n\r",
+                 tasks[i]->name, (unsigned long)(cpu_permille / 10), (unsigned long)(cpu_permille % 10),
+                 (unsigned long)s->max_us, (unsigned long)tasks[i]->budget_us,
+                 (unsigned long)s->overruns);
+        *s = (task_stats){0};
+    }
+}
@@ -0,0 +1,121 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file task.h
+ * @brief Cooperative task scheduler for core0.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * A task is a function that does a bounded piece of work and returns. The
+ * TASK_ macros turn it into a stackless protothread: it can wait or yield in
+ * the middle and resume at the same line on its next step. Local variables
+ * do not survive a wait; keep state in statics or in a struct.
+ *
+ * Each task declares a budget for one slice, the work it does between two
+ * yield points. A blocking event_wait() inside a task is also a yield point:
+ * the other tasks run while it waits. Slices longer than the budget are
+ * counted as overruns.
+ */
+#ifndef TASK_H
+#define TASK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Maximum number of tasks
+#define TASK_MAX (8)
+
+/**
+ * @brief Result of one step of a task.
+ */
+typedef enum {
+    TASK_WAITING,   // Nothing to do until an event or a time
+    TASK_YIELDED,   // More work ready; run again before sleeping
+    TASK_DONE,      // Finished; never run again
+} task_status;
+
+typedef struct task task;
+
+/**
+ * @brief Step function of a task.
+ *
+ * @param t The task.
+ * @return What the task needs next.
+ */
+typedef task_status (*task_fn)(task *t);
+
+/**
+ * @brief Timing statistics of one task since the last reset.
+ */
+typedef struct {
+    uint32_t slices;        // Stretches of work between yield points
+    uint32_t overruns;      // Slices longer than the budget
+    uint32_t max_us;        // Longest slice
+    uint64_t total_us;      // Time spent in the task
+} task_stats;
+
+/**
+ * @brief One task. Define it statically with name, fn and budget_us set.
+ */
+struct task {
+    const char *name;
+    task_fn fn;
+    uint32_t budget_us;     // Longest acceptable slice
+    uint8_t trace_id;       // Span id in the trace, TRACE_TASK if unset
+    uint16_t lc;            // Line to resume at, used by the TASK_ macros
+    bool running;           // A step is on the stack
+    bool done;              // Returned TASK_DONE
+    task_stats stats;
+};
+
+// Start of the task body
+#define TASK_BEGIN(t) switch ((t)->lc) { case 0:
+
+// Return to the scheduler and resume here on the next step
+#define TASK_YIELD(t) \
+    do { (t)->lc = __LINE__; return TASK_YIELDED; case __LINE__:; } while (0)
+
+// Return to the scheduler until the condition holds
+#define TASK_WAIT_UNTIL(t, cond) \
+    do { (t)->lc = __LINE__; case __LINE__: if (!(cond)) return TASK_WAITING; } while (0)
+
+// End of the task body
+#define TASK_END(t) } (t)->lc = 0; return TASK_DONE
+
+/**
+ * @brief Register a task; it is stepped in the order tasks were added.
+ *
+ * @param t The task.
+ * @return false if TASK_MAX tasks are registered already.
+ */
+bool task_add(task *t);
+
+/**
+ * @brief Run the tasks forever, sleeping when none has work.
+ */
+void task_run(void);
+
+/**
+ * @brief Let the other tasks run in the middle of a long piece of work.
+ *
+ * For work inside a task that has no event to wait for. The caller's slice
+ * ends here and a new one starts on return, as around a blocking
+ * event_wait(), but nothing sleeps.
+ */
+void task_pause(void);
+
+/**
+ * @brief Print the statistics of every task and restart them.
+ *
+ * @param elapsed_us Length of the window, for the CPU share.
+ */
+void task_report(uint64_t elapsed_us);
+
+#endif // TASK_H
@@ -0,0 +1,400 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file fontgen.cpp
+ * @brief Builds subsetted, packed font tables for the firmware from fonts.c.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Usage: fontgen fonts.c out.c CHARSET UI_SOURCE...
+ *
+ * Reads the full ASCII tables of fonts.c and the UI sources, and writes
+ * out.c with only the fonts the UI draws with and only the glyphs each one
+ * needs. Every Paint_DrawString_EN, Paint_DrawChar and Paint_DrawNum call
+ * names its font as &FontN:
+ *   - text given as string literals adds their characters to that font;
+ *   - text from a variable adds every character of every literal in the
+ *     sources outside log and printf calls, plus CHARSET, the characters
+ *     run-time text can hold (digits and the like);
+ *   - Paint_DrawNum adds the digits, '.' and '-'.
+ *
+ * Glyphs are packed row after row with no padding, most significant bit
+ * leftmost as in the framebuffer. Each font gets a map from a character
+ * to its glyph; characters left out map to the space, glyph 0. The
+ * summary on stderr gives the glyphs and bytes kept of each font.
+ */
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Characters of the tables in fonts.c: ' ' to '~'
+#define FIRST_CHAR (' ')
+#define CHAR_COUNT (95)
+
+/**
+ * @brief One font of fonts.c, as the glyph rows it lists.
+ */
+struct font {
+    unsigned width = 0;
+    unsigned height = 0;
+    std::vector<uint8_t> table;     // CHAR_COUNT glyphs, each row padded to bytes
+};
+
+static std::string read_file(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+/**
+ * @brief Blank out comments, leaving string and character literals alone.
+ */
+static std::string strip_comments(const std::string &text) {
+    std::string out = text;
+    size_t i = 0;
+    while (i < out.size()) {
+        char c = out[i];
+        if (c == '"' || c == '\'') {
+            for (i++; i < out.size() && out[i] != c; i++) {
+                i += (out[i] == '\\');
+            }
+            i++;
+        } else if (out.compare(i, 2, "//") == 0) {
+            for (; i < out.size() && out[i] != '\n'; i++) {
+                out[i] = ' ';
+            }
+        } else if (out.compare(i, 2, "/*") == 0) {
+            size_t end = out.find("*/", i + 2);
+            end = (end == std::string::npos) ? out.size() : end + 2;
+            for (; i < end; i++) {
+                out[i] = out[i] == '\n' ? '\n' : ' ';
+            }
+        } else {
+            i++;
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief The characters of every literal in text, escapes decoded.
+ *
+ * @param text    Source without comments.
+ * @param strings Include string literals.
+ * @param chars   Include character literals.
+ */
+static std::set<char> literal_chars(const std::string &text, bool strings = true, bool chars = true) {
+    std::set<char> out;
+    for (size_t i = 0; i < text.size(); i++) {
+        char quote = text[i];
+        if (quote != '"' && quote != '\'') {
+            continue;
+        }
+        bool keep = quote == '"' ? strings : chars;
+        for (i++; i < text.size() && text[i] != quote; i++) {
+            char c = text[i];
+            if (c == '\\' && i + 1 < text.size()) {
+                c = text[++i];
+                c = c == 'n' ? '\n' : c == 't' ? '\t' : c == 'r' ? '\r' : c == '0' ? '\0' : c;
+            }
+            if (keep && c >= FIRST_CHAR && c < FIRST_CHAR + CHAR_COUNT) {
+                out.insert(c);
+            }
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief Split C source without comments into identifiers, numbers and
+ * single punctuation characters.
+ */
+static std::vector<std::string> tokens(const std::string &text) {
+    std::vector<std::string> out;
+    for (size_t i = 0; i < text.size();) {
+        if (std::isspace((unsigned char)text[i])) {
+            i++;
+        } else if (std::isalnum((unsigned char)text[i]) || text[i] == '_') {
+            size_t start = i;
+            while (i < text.size() && (std::isalnum((unsigned char)text[i]) || text[i] == '_')) {
+                i++;
+            }
+            out.push_back(text.substr(start, i - start));
+        } else {
+            out.push_back(std::string(1, text[i++]));
+        }
+    }
+    return out;
+}
+
+// The N of "FontN" followed by suffix, or -1
+static int font_name(const std::string &token, const std::string &suffix) {
+    if (token.size() <= 4 + suffix.size() || token.compare(0, 4, "Font") != 0 ||
+        token.compare(token.size() - suffix.size(), suffix.size(), suffix) != 0) {
+        return -1;
+    }
+    std::string digits = token.substr(4, token.size() - 4 - suffix.size());
+    if (digits.find_first_not_of("0123456789") != std::string::npos) {
+        return -1;
+    }
+    return std::stoi(digits);
+}
+
+/**
+ * @brief Read every FontN_Table and its sFONT FontN dimensions.
+ */
+static std::map<int, font> read_fonts(const std::string &path) {
+    std::vector<std::string> t = tokens(strip_comments(read_file(path)));
+    std::map<int, font> fonts;
+
+    for (size_t i = 0; i + 5 < t.size(); i++) {
+        int n = font_name(t[i], "_Table");
+        if (n >= 0 && t[i + 1] == "[" && t[i + 2] == "]" && t[i + 3] == "=" && t[i + 4] == "{") {
+            // FontN_Table[] = { 0x00, ... }
+            font &f = fonts[n];
+            for (i += 5; i < t.size() && t[i] != "}"; i++) {
+                if (t[i] != ",") {
+                    f.table.push_back((uint8_t)std::stoul(t[i], nullptr, 0));
+                }
+            }
+        } else if (t[i] == "sFONT" && i + 8 < t.size() && (n = font_name(t[i + 1], "")) >= 0 &&
+                   t[i + 2] == "=" && t[i + 3] == "{" && t[i + 5] == "," && t[i + 7] == ",") {
+            // sFONT FontN = { FontN_Table, width, height }
+            fonts[n].width = std::stoi(t[i + 6]);
+            fonts[n].height = std::stoi(t[i + 8]);
+        }
+    }
+
+    for (const auto &entry : fonts) {
+        const font &f = entry.second;
+        if (f.width == 0 || f.table.size() != (size_t)CHAR_COUNT * f.height * ((f.width + 7) / 8)) {
+            throw std::runtime_error("Font" + std::to_string(entry.first) + " in " + path +
+                                     " is not " + std::to_string(CHAR_COUNT) + " glyphs of its size");
+        }
+    }
+    return fonts;
+}
+
+/**
+ * @brief The arguments of every call to name in text, split at top-level commas.
+ */
+static std::vector<std::vector<std::string>> calls(const std::string &text, const std::string &name) {
+    std::vector<std::vector<std::string>> out;
+    std::regex call_re("\\b" + name + "\\s*\\(");
+
+    for (std::sregex_iterator it(text.begin(), text.end(), call_re), end; it != end; ++it) {
+        std::vector<std::string> args(1);
+        int depth = 0;
+        for (size_t i = it->position() + it->length(); i < text.size(); i++) {
+            char c = text[i];
+            if (c == '"' || c == '\'') {
+                size_t start = i;
+                for (i++; i < text.size() && text[i] != c; i++) {
+                    i += (text[i] == '\\');
+                }
+                args.back() += text.substr(start, i - start + 1);
+                continue;
+            }
+            if (c == ')' && depth == 0) {
+                break;
+            }
+            depth += (c == '(' || c == '[') - (c == ')' || c == ']');
+            if (c == ',' && depth == 0) {
+                args.emplace_back();
+            } else {
+                args.back() += c;
+            }
+        }
+        out.push_back(args);
+    }
+    return out;
+}
+
+/**
+ * @brief Blank out calls whose text never reaches the display: the serial
+ * log and printf.
+ */
+static std::string strip_logging(const std::string &text) {
+    std::string out = text;
+    std::regex call_re(R"(\b(LOG_[A-Z]+|printf)\s*\()");
+
+    for (std::sregex_iterator it(text.begin(), text.end(), call_re), end; it != end; ++it) {
+        int depth = 0;
+        for (size_t i = it->position() + it->length(); i < out.size(); i++) {
+            char c = out[i];
+            if (c == '"' || c == '\'') {
+                for (out[i++] = ' '; i < out.size() && out[i] != c; i++) {
+                    if (out[i] == '\\') {
+                        out[i++] = ' ';
+                    }
+                    out[i] = ' ';
+                }
+            } else if (c == ')' && depth == 0) {
+                break;
+            } else {
+                depth += (c == '(') - (c == ')');
+            }
+            out[i] = c == '\n' ? '\n' : ' ';
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief The font a call argument names, or -1 if it is not &FontN.
+ */
+static int font_number(const std::string &arg) {
+    std::smatch m;
+    if (std::regex_search(arg, m, std::regex(R"(^\s*&\s*Font(\d+)\s*$)"))) {
+        return std::stoi(m[1]);
+    }
+    return -1;
+}
+
+/**
+ * @brief Pack the glyphs of chars, space first, and their map.
+ */
+static void write_font(std::ostream &out, int number, const font &f, const std::set<char> &chars,
+                       size_t &kept_bytes) {
+    unsigned row_bytes = (f.width + 7) / 8;
+    unsigned glyph_bytes = (f.width * f.height + 7) / 8;
+    std::vector<char> order = { ' ' };
+    for (char c : chars) {
+        if (c != ' ') {
+            order.push_back(c);
+        }
+    }
+
+    out << "// Font" << number << ": " << f.width << " x " << f.height << ", " << order.size() << " of "
+        << CHAR_COUNT << " glyphs\n";
+    out << "static const uint8_t RAM_DATA(\"fonts\") Font" << number << "_Glyphs[] = {\n";
+    std::vector<uint8_t> map(CHAR_COUNT, 0);
+    for (size_t g = 0; g < order.size(); g++) {
+        char c = order[g];
+        map[c - FIRST_CHAR] = (uint8_t)g;
+        const uint8_t *rows = &f.table[(size_t)(c - FIRST_CHAR) * f.height * row_bytes];
+
+        std::vector<uint8_t> packed(glyph_bytes, 0);
+        unsigned bit = 0;
+        for (unsigned y = 0; y < f.height; y++) {
+            for (unsigned x = 0; x < f.width; x++, bit++) {
+                if (rows[y * row_bytes + x / 8] & (0x80 >> (x % 8))) {
+                    packed[bit / 8] |= 0x80 >> (bit % 8);
+                }
+            }
+        }
+        out << "    ";
+        for (uint8_t b : packed) {
+            char hex[8];
+            std::snprintf(hex, sizeof(hex), "0x%02X, ", b);
+            out << hex;
+        }
+        out << "// '" << (c == '\\' ? "\\\\" : std::string(1, c)) << "'\n";
+    }
+    out << "};\n\n";
+
+    out << "static const uint8_t RAM_DATA(\"fonts\") Font" << number << "_Map[FONT_MAP_SIZE] = {";
+    for (size_t i = 0; i < map.size(); i++) {
+        out << (i % 16 ? " " : "\n    ") << (unsigned)map[i] << ",";
+    }
+    out << "\n};\n\n";
+    out << "sFONT Font" << number << " = { Font" << number << "_Glyphs, " << f.width << ", " << f.height
+        << ", Font" << number << "_Map };\n\n";
+
+    kept_bytes = order.size() * glyph_bytes + map.size();
+    std::cerr << "Font" << number << ": " << order.size() << " of " << CHAR_COUNT << " glyphs, " << kept_bytes
+              << " bytes (" << f.table.size() << " in fonts.c)\n";
+}
+
+int main(int argc, char **argv) {
+    if (argc < 5) {
+        std::cerr << "usage: " << argv[0] << " fonts.c out.c CHARSET UI_SOURCE...\n";
+        return 2;
+    }
+
+    try {
+        std::map<int, font> fonts = read_fonts(argv[1]);
+
+        // Characters a string from a variable can hold
+        std::set<char> dynamic(argv[3], argv[3] + std::strlen(argv[3]));
+        std::vector<std::string> sources;
+        for (int i = 4; i < argc; i++) {
+            sources.push_back(strip_comments(read_file(argv[i])));
+            std::set<char> chars = literal_chars(strip_logging(sources.back()));
+            dynamic.insert(chars.begin(), chars.end());
+        }
+
+        std::map<int, std::set<char>> used;
+        for (const std::string &text : sources) {
+            for (const char *name : { "Paint_DrawString_EN", "Paint_DrawChar" }) {
+                for (const auto &args : calls(text, name)) {
+                    int n = args.size() >= 4 ? font_number(args[3]) : -1;
+                    if (n < 0) {
+                        continue;   // The declaration, or a font passed through
+                    }
+                    std::set<char> literal = literal_chars(args[2], true, true);
+                    used[n].insert(literal.empty() ? dynamic.begin() : literal.begin(),
+                                   literal.empty() ? dynamic.end() : literal.end());
+                }
+            }
+            for (const auto &args : calls(text, "Paint_DrawNum")) {
+                int n = args.size() >= 4 ? font_number(args[3]) : -1;
+                if (n >= 0) {
+                    for (char c : std::string("0123456789.-")) {
+                        used[n].insert(c);
+                    }
+                }
+            }
+        }
+
+        std::ostringstream out;
+        out << "// Generated by tools/fontgen from " << argv[1] << " and the UI sources; do not edit\n"
+            << "#include \"oled.h\"\n"
+            << "#include \"ram_code.h\"\n\n";
+        size_t total = 0, full = 0;
+        for (const auto &entry : used) {
+            auto f = fonts.find(entry.first);
+            if (f == fonts.end()) {
+                throw std::runtime_error("the UI draws with Font" + std::to_string(entry.first) +
+                                         ", which fonts.c does not have");
+            }
+            size_t kept;
+            write_font(out, entry.first, f->second, entry.second, kept);
+            total += kept;
+        }
+        for (const auto &entry : fonts) {
+            full += entry.second.table.size();
+        }
+        std::cerr << used.size() << " of " << fonts.size() << " fonts, " << total << " bytes (" << full
+                  << " in fonts.c)\n";
+
+        std::ofstream file(argv[2], std::ios::binary);
+        if (!(file << out.str())) {
+            throw std::runtime_error(std::string("cannot write ") + argv[2]);
+        }
+        return 0;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
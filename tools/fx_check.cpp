@@ -0,0 +1,145 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file fx_check.cpp
+ * @brief Checks the fixed-point geometry against the double formulas.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Usage: fx_check [random_triangles]
+ *
+ * Runs every 16-bit input through fx_area_circle, fx_cm_to_ft and
+ * fx_cm2_to_ft2 (the latter with the input as whole square centimeters,
+ * as hundredths and as the area of a square room), and fx_area_triangle
+ * over families of triangles with each side sweeping the 16-bit range plus
+ * random triangles (3M by default). Every result is rounded to the nearest
+ * hundredth, so it must be within half a hundredth of the double formula
+ * area.c used before, plus the rounding error of the double itself. Prints
+ * the worst error of each function and exits 1 if any is past the bound.
+ */
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+
+#include "fixed_point.h"
+
+// Error allowed on top of the half hundredth, relative to the result: the
+// double reference is itself only good to a few units in the last place
+#define DOUBLE_SLACK (1e-14)
+
+/**
+ * @brief Worst error of one function against its double reference.
+ */
+struct check {
+    const char *name;
+    uint64_t cases = 0;
+    uint64_t failures = 0;
+    double worst = 0;           // Largest |fixed - double| in hundredths
+    std::string worst_input;
+
+    explicit check(const char *n) : name(n) {}
+
+    void compare(int64_t fixed, double reference, const std::string &input) {
+        double error = std::fabs((double)fixed - reference);
+        cases++;
+        if (error > 0.5 + std::fabs(reference) * DOUBLE_SLACK) {
+            if (failures++ < 5) {
+                std::cerr << name << "(" << input << ") = " << fixed << ", double " << std::setprecision(15)
+                          << reference << "\n";
+            }
+        }
+        if (error > worst) {
+            worst = error;
+            worst_input = input;
+        }
+    }
+
+    bool report() const {
+        std::cout << std::left << std::setw(18) << name << std::right << std::setw(12) << cases << " cases, worst "
+                  << std::fixed << std::setprecision(4) << worst << " at " << worst_input << ", "
+                  << (failures ? std::to_string(failures) + " past the bound" : std::string("ok")) << "\n";
+        return failures == 0;
+    }
+};
+
+// Heron's formula in hundredths of a square centimeter, sides sorted so the
+// differences are exact (Kahan's arrangement), as area.c computed it in double
+static double heron(double a, double b, double c) {
+    if (a < b) {
+        std::swap(a, b);
+    }
+    if (b < c) {
+        std::swap(b, c);
+    }
+    if (a < b) {
+        std::swap(a, b);
+    }
+    if (c - (a - b) <= 0) {
+        return 0;
+    }
+    return 100.0 * 0.25 * std::sqrt((a + (b + c)) * (c - (a - b)) * (c + (a - b)) * (a + (b - c)));
+}
+
+static void triangle(check &t, uint16_t a, uint16_t b, uint16_t c) {
+    t.compare(fx_area_triangle(a, b, c), heron(a, b, c),
+              std::to_string(a) + ", " + std::to_string(b) + ", " + std::to_string(c));
+}
+
+int main(int argc, char **argv) {
+    uint64_t random_triangles = argc > 1 ? std::strtoull(argv[1], nullptr, 0) : 3000000;
+
+    check circle("fx_area_circle");
+    check feet("fx_cm_to_ft");
+    check square_feet("fx_cm2_to_ft2");
+    check tri("fx_area_triangle");
+
+    const double cm2_per_ft2 = (double)FX_CM2_PER_FT2_NUM / FX_CM2_PER_FT2_DEN;
+    for (uint32_t x = 0; x <= UINT16_MAX; x++) {
+        std::string input = std::to_string(x);
+        circle.compare(fx_area_circle((uint16_t)x), 100.0 * M_PI * x * x / 4.0, input);
+        feet.compare(fx_cm_to_ft(x), 100.0 * x * FX_CM_PER_FOOT_DEN / FX_CM_PER_FOOT_NUM, input);
+
+        fx_area_t whole = (fx_area_t)x * FX_SCALE;
+        fx_area_t room = fx_area_product((int32_t)x, (int32_t)x);
+        square_feet.compare(fx_cm2_to_ft2(x), x / cm2_per_ft2, input + " hundredths");
+        square_feet.compare(fx_cm2_to_ft2(-(fx_area_t)x), -(double)x / cm2_per_ft2, "-" + input + " hundredths");
+        square_feet.compare(fx_cm2_to_ft2(whole), whole / cm2_per_ft2, input + " cm^2");
+        square_feet.compare(fx_cm2_to_ft2(room), (double)room / cm2_per_ft2, input + " cm square");
+
+        // Each side across the whole range against small, equal and largest partners
+        if (x > 0) {
+            uint16_t s = (uint16_t)x;
+            triangle(tri, s, s, s);
+            triangle(tri, s, s, 1);
+            triangle(tri, 1, s, s);
+            triangle(tri, s, UINT16_MAX, UINT16_MAX);
+            triangle(tri, s, (uint16_t)(s / 2 + 1), (uint16_t)(s / 2 + 1));
+            triangle(tri, s, (uint16_t)(s / 2), (uint16_t)(s - s / 2));    // Degenerate, area 0
+            triangle(tri, s, 300, 400);
+        }
+    }
+
+    std::mt19937_64 rng(0x5353);
+    std::uniform_int_distribution<uint32_t> side(1, UINT16_MAX);
+    for (uint64_t i = 0; i < random_triangles; i++) {
+        triangle(tri, (uint16_t)side(rng), (uint16_t)side(rng), (uint16_t)side(rng));
+    }
+
+    bool ok = circle.report();
+    ok = feet.report() && ok;
+    ok = square_feet.report() && ok;
+    ok = tri.report() && ok;
+    return ok ? 0 : 1;
+}
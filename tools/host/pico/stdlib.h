@@ -0,0 +1,50 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file stdlib.h
+ * @brief The few Pico SDK calls event.c makes, for building it on the host.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * The tool that links event.c defines these: the clock is simulated and the
+ * repeating timer only fires when the tool fires it.
+ */
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct repeating_timer repeating_timer_t;
+typedef bool (*repeating_timer_callback_t)(repeating_timer_t *timer);
+
+struct repeating_timer {
+    int32_t delay_ms;
+    repeating_timer_callback_t callback;
+    void *user_data;
+};
+
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void *user_data,
+                            repeating_timer_t *out);
+void __sev(void);
+void __wfe(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_PICO_STDLIB_H
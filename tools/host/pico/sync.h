@@ -0,0 +1,36 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file sync.h
+ * @brief Critical sections for building event.c on the host, where a single
+ * thread runs everything and there is nothing to exclude.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#ifndef HOST_PICO_SYNC_H
+#define HOST_PICO_SYNC_H
+
+typedef struct {
+    int depth;
+} critical_section_t;
+
+static inline void critical_section_init(critical_section_t *crit) {
+    crit->depth = 0;
+}
+
+static inline void critical_section_enter_blocking(critical_section_t *crit) {
+    crit->depth++;
+}
+
+static inline void critical_section_exit(critical_section_t *crit) {
+    crit->depth--;
+}
+
+#endif // HOST_PICO_SYNC_H
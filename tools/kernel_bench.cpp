@@ -0,0 +1,208 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file kernel_bench.cpp
+ * @brief Times the firmware's SDK-free kernels on the host.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Usage: kernel_bench [out.txt]
+ *
+ * Built once per firmware variant with that variant's optimization flags
+ * (see CMakeLists.txt), so the kernels see the same inlining and layout
+ * decisions the compiler makes for the board. Prints one line per kernel:
+ * its name and the cycles per call, the best of several batches. Cycles
+ * are the host time-stamp counter where there is one, nanoseconds
+ * otherwise; the header line names the unit. size_report puts the lines
+ * of every variant side by side.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "fb_delta.h"
+#include "fixed_point.h"
+#include "frame.h"
+#include "occupancy.h"
+#include "scan_codec.h"
+#include "sweep.h"
+#include "walls.h"
+
+#ifndef BENCH_VARIANT
+#define BENCH_VARIANT "host"
+#endif
+
+// Batches per kernel; the fastest one is reported
+#define BATCHES (15)
+
+// Least time one batch should take, so the counter resolution does not matter
+#define BATCH_NS (2000000)
+
+// Keeps results alive so the compiler cannot drop the calls
+static volatile int64_t sink;
+
+#if defined(__x86_64__) || defined(__i386__)
+static const char *const unit = "tsc-cycles";
+static uint64_t ticks() { return __rdtsc(); }
+#else
+static const char *const unit = "ns";
+static uint64_t ticks() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+/**
+ * @brief Ticks per call of fn, the best of BATCHES batches.
+ *
+ * The batch size is doubled until one batch takes BATCH_NS.
+ */
+static double time_kernel(const std::function<void()> &fn) {
+    uint32_t calls = 1;
+    for (;;) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < calls; i++) {
+            fn();
+        }
+        if (std::chrono::steady_clock::now() - start >= std::chrono::nanoseconds(BATCH_NS) || calls >= (1u << 30)) {
+            break;
+        }
+        calls *= 2;
+    }
+
+    double best = INFINITY;
+    for (int b = 0; b < BATCHES; b++) {
+        uint64_t t0 = ticks();
+        for (uint32_t i = 0; i < calls; i++) {
+            fn();
+        }
+        best = std::min(best, (double)(ticks() - t0) / calls);
+    }
+    return best;
+}
+
+/**
+ * @brief A full turn in a 5 x 3.6 m room, fed through the sweep code the
+ * way the sampler does: 1 degree of yaw per 10 ms gyro sample, one LiDAR
+ * distance per sample.
+ */
+static void synthetic_sweep(sweep_scan *scan, int32_t start_angle) {
+    sweep_init(scan, 0, 0);
+    for (uint32_t i = 1; i <= 380; i++) {
+        sweep_update_yaw(scan, 10000, i * 10000ull);
+        double a = (sweep_yaw(scan) + start_angle) * M_PI / 18000.0;
+        double d = std::fmin(std::fabs(250.0 / std::cos(a)), std::fabs(180.0 / std::sin(a)));
+        sweep_add_sample(scan, (uint16_t)std::lround(std::fmin(d, 1200.0)));
+    }
+}
+
+int main(int argc, char **argv) {
+    std::ofstream file;
+    if (argc > 1) {
+        file.open(argv[1]);
+        if (!file) {
+            std::cerr << "cannot open " << argv[1] << "\n";
+            return 1;
+        }
+    }
+    std::ostream &out = (argc > 1) ? file : std::cout;
+
+    static sweep_scan scan, moved;
+    static occ_map map;
+    static wall_room room;
+    synthetic_sweep(&scan, 0);
+    synthetic_sweep(&moved, 3 * FX_DEGREE);
+
+    std::vector<std::pair<std::string, std::function<void()>>> kernels;
+
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    kernels.push_back({ "fx_isqrt64", [&] { x += 0x9E3779B97F4A7C15ull; sink = fx_isqrt64(x); } });
+    uint16_t side = 100;
+    kernels.push_back({ "fx_area_triangle", [&] { side = (uint16_t)(side % 400 + 1); sink = fx_area_triangle(300, 400, side + 100); } });
+    int32_t angle = 0;
+    kernels.push_back({ "fx_sin", [&] { angle = (angle + 37) % FX_FULL_TURN; sink = fx_sin(angle); } });
+
+    kernels.push_back({ "sweep_outline", [&] { sink = sweep_compute_outline(&scan).area; } });
+    kernels.push_back({ "sweep_integrator", [&] {
+        sweep_integrator integrator;
+        sweep_integrator_init(&integrator);
+        for (uint16_t i = 0; i < scan.count; i++) {
+            sweep_integrator_add(&integrator, scan.points[i].angle, scan.points[i].distance);
+        }
+        sink = sweep_integrator_result(&integrator).area;
+    } });
+    kernels.push_back({ "walls_extract", [&] { sink = walls_extract(&scan, &room) ? room.area : 0; } });
+
+    occ_pose origin = { 0, 0, 0 };
+    occ_init(&map);
+    occ_add_scan(&map, &scan, &origin);
+    kernels.push_back({ "occ_match_scan", [&] { sink = occ_match_scan(&map, &moved).score; } });
+    static occ_map scratch;
+    kernels.push_back({ "occ_add_scan", [&] {
+        occ_init(&scratch);
+        sink = occ_add_scan(&scratch, &scan, &origin);
+    } });
+
+    std::vector<uint8_t> encoded(SCAN_ENCODED_MAX(SWEEP_MAX_POINTS));
+    kernels.push_back({ "scan_encode", [&] {
+        scan_writer writer;
+        scan_writer_init(&writer, encoded.data(), encoded.size(), scan.count);
+        for (uint16_t i = 0; i < scan.count; i++) {
+            scan_writer_add(&writer, &scan.points[i]);
+        }
+        sink = scan_writer_finish(&writer);
+    } });
+    std::vector<sweep_point> block(SCAN_BLOCK_POINTS);
+    kernels.push_back({ "scan_decode", [&] {
+        scan_reader reader;
+        scan_reader_open(&reader, encoded.data(), encoded.size());
+        for (uint16_t b = 0; b < reader.blocks; b++) {
+            sink = scan_read_block(&reader, b, block.data());
+        }
+    } });
+
+    // A menu redraw: a few rows of text change on the 128 x 128 display
+    std::vector<uint8_t> before(2048), now(2048), delta(FB_DELTA_MAX(2048));
+    for (size_t i = 0; i < now.size(); i++) {
+        before[i] = (uint8_t)(i * 131);
+        now[i] = (i / 16) % 32 == 5 || (i / 16) % 32 == 6 ? (uint8_t)(i * 7) : before[i];
+    }
+    kernels.push_back({ "fb_delta_encode", [&] { sink = fb_delta_encode(now.data(), before.data(), now.size(), delta.data()); } });
+
+    std::vector<uint8_t> wire(FRAME_MAX_ENCODED);
+    std::vector<uint8_t> payload(FRAME_MAX_DATA, 0x5A);
+    kernels.push_back({ "frame_round_trip", [&] {
+        size_t n = frame_encode(FRAME_SCAN, 1, payload.data(), payload.size(), wire.data());
+        frame_decoder decoder;
+        frame f;
+        frame_decoder_init(&decoder);
+        for (size_t i = 0; i < n; i++) {
+            sink = frame_decode(&decoder, wire[i], &f);
+        }
+    } });
+
+    out << std::fixed << std::setprecision(1);
+    out << "# kernel_bench " << BENCH_VARIANT << ", " << unit << " per call\n";
+    for (const auto &k : kernels) {
+        out << k.first << ' ' << time_kernel(k.second) << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,225 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file ring_stress.cpp
+ * @brief Races a producer thread against a consumer on the sample ring.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Usage: ring_stress [seconds] [min_mops]
+ *
+ * The producer pushes sensor-frame-sized samples as fast as it can, each
+ * stamped with its sequence number and filled with words derived from it,
+ * into a ring of the sensor core's size. The consumer cycles through
+ * sample_ring_latest, sample_ring_since, sample_ring_snapshot and
+ * sample_ring_next and checks every copy: no sample is torn, latest never
+ * goes back and is no older than the newest push before the call, since
+ * and snapshot return unbroken runs that reach that push, since starts
+ * right after its time unless that sample was overwritten, and next takes
+ * samples in order with every gap counted in ring->lost.
+ *
+ * Runs for 2 seconds by default, prints the push and read rates and exits
+ * 1 on any inconsistency or if the producer and consumer together manage
+ * fewer than min_mops (1 by default) million operations per second.
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "sample_ring.h"
+
+// As SENSOR_RING_SIZE and sizeof(sensor_frame) in sensor_core.h
+#define RING_CAPACITY (64)
+#define CHECK_WORDS (5)
+
+// Longest run since and snapshot ask for, well below the capacity
+#define MAX_RUN (16)
+
+// The sequence words hold 2n + 2, so stop well before they wrap
+#define MAX_PUSHES (1u << 30)
+
+/**
+ * @brief A sample the size of a sensor frame, stamped with its number.
+ */
+struct sample {
+    uint64_t time_us;           // The sequence number, so stamps only grow
+    uint32_t seq;
+    uint32_t check[CHECK_WORDS];
+};
+static_assert(sizeof(sample) == 32, "sample should be the size of a sensor frame");
+
+static uint32_t check_word(uint32_t seq, uint32_t i) {
+    return (seq + i) * 0x9E3779B1u ^ (i << 28);
+}
+
+static sample make_sample(uint32_t seq) {
+    sample s;
+    s.time_us = seq;
+    s.seq = seq;
+    for (uint32_t i = 0; i < CHECK_WORDS; i++) {
+        s.check[i] = check_word(seq, i);
+    }
+    return s;
+}
+
+static sample_ring ring;
+static uint32_t ring_seq[RING_CAPACITY];
+static sample ring_data[RING_CAPACITY];
+static std::atomic<bool> stop;
+
+static uint32_t pushed() {
+    return __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Consumer-side checks; the first few failures are printed.
+ */
+struct checker {
+    uint64_t failures = 0;
+    uint64_t reads[4] = {};     // latest, since, snapshot, next
+
+    void fail(const std::string &what) {
+        if (failures++ < 10) {
+            std::cerr << what << "\n";
+        }
+    }
+
+    bool intact(const sample &s, const char *call) {
+        bool ok = s.time_us == s.seq;
+        for (uint32_t i = 0; i < CHECK_WORDS; i++) {
+            ok = ok && s.check[i] == check_word(s.seq, i);
+        }
+        if (!ok) {
+            fail(std::string(call) + ": torn sample " + std::to_string(s.seq));
+        }
+        return ok;
+    }
+
+    // An unbroken run of count samples from intact ones, reaching the push
+    // that was newest when the call began
+    void run(const sample *out, size_t count, uint32_t head_before, const char *call) {
+        for (size_t i = 0; i < count; i++) {
+            if (!intact(out[i], call)) {
+                return;
+            }
+            if (i > 0 && out[i].seq != out[i - 1].seq + 1) {
+                fail(std::string(call) + ": " + std::to_string(out[i].seq) + " follows " +
+                     std::to_string(out[i - 1].seq));
+                return;
+            }
+        }
+        if (count > 0 && out[count - 1].seq + 1 < head_before) {
+            fail(std::string(call) + ": ends at " + std::to_string(out[count - 1].seq) + " with " +
+                 std::to_string(head_before) + " pushed before the call");
+        }
+    }
+};
+
+static void produce() {
+    for (uint32_t n = 0; n < MAX_PUSHES && !stop.load(std::memory_order_relaxed); n++) {
+        sample s = make_sample(n);
+        sample_ring_push(&ring, &s);
+    }
+}
+
+static void consume(checker &c) {
+    std::mt19937 rng(0x41c3);
+    sample out[MAX_RUN];
+    uint32_t last_latest = 0;
+    uint32_t last_next = 0;
+    bool taken = false;
+
+    while (!stop.load(std::memory_order_relaxed)) {
+        uint32_t head = pushed();
+
+        sample latest;
+        if (sample_ring_latest(&ring, &latest) && c.intact(latest, "latest")) {
+            if (latest.seq < last_latest || latest.seq + 1 < head) {
+                c.fail("latest: " + std::to_string(latest.seq) + " after " + std::to_string(last_latest) +
+                       " with " + std::to_string(head) + " pushed before the call");
+            }
+            last_latest = latest.seq;
+        }
+        c.reads[0]++;
+
+        // Ask for the samples after one a little behind the newest
+        head = pushed();
+        uint32_t behind = rng() % (2 * MAX_RUN);
+        if (head > behind) {
+            uint32_t time = head - 1 - behind;
+            size_t max = 1 + rng() % MAX_RUN;
+            size_t count = sample_ring_since(&ring, time, out, max);
+            uint32_t head_after = pushed();
+            c.run(out, count, count == max ? 0 : head, "since");
+            if (count > 0 && out[0].seq != time + 1 && time + 1 + RING_CAPACITY > head_after) {
+                c.fail("since " + std::to_string(time) + ": starts at " + std::to_string(out[0].seq) +
+                       " though that sample was still in the ring");
+            }
+            if (count == 0 && time + 1 < head) {
+                c.fail("since " + std::to_string(time) + ": nothing with " + std::to_string(head) + " pushed");
+            }
+        }
+        c.reads[1]++;
+
+        head = pushed();
+        size_t want = 1 + rng() % MAX_RUN;
+        size_t count = sample_ring_snapshot(&ring, out, want);
+        if (count != want && head >= want) {
+            c.fail("snapshot: " + std::to_string(count) + " of " + std::to_string(want));
+        }
+        c.run(out, count, head, "snapshot");
+        c.reads[2]++;
+
+        uint32_t lost = ring.lost;
+        sample next;
+        if (sample_ring_next(&ring, &next) && c.intact(next, "next")) {
+            uint32_t expected = (taken ? last_next + 1 : 0) + (ring.lost - lost);
+            if (next.seq != expected) {
+                c.fail("next: " + std::to_string(next.seq) + " where " + std::to_string(expected) +
+                       " was due after " + std::to_string(ring.lost - lost) + " lost");
+            }
+            last_next = next.seq;
+            taken = true;
+        }
+        c.reads[3]++;
+    }
+}
+
+int main(int argc, char **argv) {
+    double seconds = argc > 1 ? std::strtod(argv[1], nullptr) : 2.0;
+    double min_mops = argc > 2 ? std::strtod(argv[2], nullptr) : 1.0;
+
+    sample_ring_init(&ring, ring_seq, ring_data, RING_CAPACITY, sizeof(sample));
+    checker c;
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread consumer(consume, std::ref(c));
+    std::thread producer(produce);
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    producer.join();
+    consumer.join();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t reads = c.reads[0] + c.reads[1] + c.reads[2] + c.reads[3];
+    double push_mops = pushed() / elapsed / 1e6;
+    double read_mops = reads / elapsed / 1e6;
+    std::cout << std::fixed << std::setprecision(2) << pushed() << " pushes (" << push_mops << " M/s), "
+              << reads << " reads (" << read_mops << " M/s: " << c.reads[0] << " latest, " << c.reads[1]
+              << " since, " << c.reads[2] << " snapshot, " << c.reads[3] << " next), " << ring.lost
+              << " lost to next, " << c.failures << " inconsistent\n";
+    return c.failures == 0 && push_mops + read_mops >= min_mops ? 0 : 1;
+}
@@ -0,0 +1,250 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file scan_tool.cpp
+ * @brief Converts scans between CSV and the encoding of scan_codec.h.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Usage:
+ *   scan_tool encode scan.csv scan.ssc    CSV of index,angle_deg,distance_cm
+ *   scan_tool decode scan.ssc [scan.csv]
+ *   scan_tool bench [points] [rounds]
+ *
+ * bench encodes synthetic sweeps, checks that every point decodes back
+ * unchanged, by block and by seeking, and that a flipped bit is caught by
+ * a block CRC; it prints the size per point and the codec throughput, and
+ * exits non-zero on any mismatch.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "scan_codec.h"
+
+/**
+ * @brief Encode points; the result is empty if there are too many.
+ */
+static std::vector<uint8_t> encode(const std::vector<sweep_point> &points) {
+    if (points.size() > UINT16_MAX) {
+        return {};
+    }
+    std::vector<uint8_t> out(SCAN_ENCODED_MAX(points.size()));
+    scan_writer writer;
+
+    scan_writer_init(&writer, out.data(), out.size(), (uint16_t)points.size());
+    for (const sweep_point &p : points) {
+        scan_writer_add(&writer, &p);
+    }
+    out.resize(scan_writer_finish(&writer));
+    return out;
+}
+
+/**
+ * @brief Decode every block.
+ *
+ * @param data    The encoding.
+ * @param points  Output points of the intact blocks.
+ * @param indices Output number of each of those points in the scan, or NULL.
+ * @return false if the header or any block is damaged.
+ */
+static bool decode(const std::vector<uint8_t> &data, std::vector<sweep_point> &points,
+                   std::vector<uint32_t> *indices = nullptr) {
+    scan_reader reader;
+    bool intact = true;
+
+    points.clear();
+    if (indices) {
+        indices->clear();
+    }
+    if (!scan_reader_open(&reader, data.data(), data.size())) {
+        return false;
+    }
+    std::vector<sweep_point> block(reader.block_points);
+    for (uint16_t b = 0; b < reader.blocks; b++) {
+        int n = scan_read_block(&reader, b, block.data());
+        if (n < 0) {
+            intact = false;
+            continue;
+        }
+        points.insert(points.end(), block.begin(), block.begin() + n);
+        for (int i = 0; indices && i < n; i++) {
+            indices->push_back((uint32_t)b * reader.block_points + i);
+        }
+    }
+    return intact;
+}
+
+/**
+ * @brief A sweep as the device records it: about one point per degree with
+ * some jitter in the step, and distances to the walls of a room with noise.
+ */
+static std::vector<sweep_point> synthetic_sweep(size_t count, std::mt19937 &rng) {
+    std::normal_distribution<double> noise(0.0, 2.0);
+    std::uniform_int_distribution<int> jitter(-15, 15);
+    std::vector<sweep_point> points;
+    int32_t angle = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        angle += 100 + jitter(rng);
+        double a = angle * M_PI / 18000.0;
+        double d = std::fmin(std::fabs(250.0 / std::cos(a)), std::fabs(180.0 / std::sin(a))) + noise(rng);
+        points.push_back({ angle, (uint16_t)std::lround(std::fmax(20.0, std::fmin(d, 1200.0))) });
+    }
+    return points;
+}
+
+static bool same(const sweep_point &a, const sweep_point &b) {
+    return a.angle == b.angle && a.distance == b.distance;
+}
+
+static int bench(size_t count, size_t rounds) {
+    std::mt19937 rng(12345);
+    std::vector<sweep_point> points = synthetic_sweep(count, rng);
+    std::vector<sweep_point> decoded;
+    std::vector<uint8_t> data;
+
+    // Round trip, including the extremes of both channels
+    std::vector<sweep_point> extremes = { { INT32_MIN, 0 }, { INT32_MAX, UINT16_MAX }, { INT32_MIN, UINT16_MAX },
+                                          { 0, 0 }, { INT32_MAX, 0 } };
+    for (const std::vector<sweep_point> *set : { &points, &extremes }) {
+        data = encode(*set);
+        if (data.empty() || !decode(data, decoded) || decoded.size() != set->size() ||
+            !std::equal(decoded.begin(), decoded.end(), set->begin(), same)) {
+            std::cerr << "round trip failed for " << set->size() << " points\n";
+            return 1;
+        }
+    }
+
+    // Seeking to single points
+    data = encode(points);
+    scan_reader reader;
+    scan_reader_open(&reader, data.data(), data.size());
+    for (size_t i = 0; i < count; i += 7) {
+        sweep_point p;
+        if (!scan_read_point(&reader, (uint16_t)i, &p) || !same(p, points[i])) {
+            std::cerr << "seek to point " << i << " failed\n";
+            return 1;
+        }
+    }
+
+    // A flipped bit in each block must be caught by that block alone
+    for (uint16_t b = 0; b < reader.blocks; b++) {
+        std::vector<uint8_t> damaged = data;
+        uint32_t offset;
+        std::memcpy(&offset, &damaged[SCAN_HEADER_SIZE + 4 * b], 4);
+        size_t at = (size_t)(reader.blocks_start - data.data()) + offset + 1;
+        damaged[at] ^= 0x10;
+        if (decode(damaged, decoded) || decoded.size() + SCAN_BLOCK_POINTS < count) {
+            std::cerr << "damage in block " << b << " not contained\n";
+            return 1;
+        }
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    size_t bytes = 0;
+    for (size_t r = 0; r < rounds; r++) {
+        bytes += encode(points).size();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; r++) {
+        decode(data, decoded);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    double encode_s = std::chrono::duration<double>(t1 - t0).count();
+    double decode_s = std::chrono::duration<double>(t2 - t1).count();
+    double total_points = (double)count * rounds;
+    std::cout << count << " points: " << data.size() << " bytes, " << (double)data.size() / count
+              << " bytes per point (raw " << sizeof(int32_t) + sizeof(uint16_t) << ")\n"
+              << "encode " << total_points / encode_s / 1e6 << " Mpoints/s, "
+              << bytes / encode_s / 1e6 << " MB/s out\n"
+              << "decode " << total_points / decode_s / 1e6 << " Mpoints/s\n"
+              << "round trip, seek and damage checks passed\n";
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    std::string mode = argc > 1 ? argv[1] : "";
+
+    if (mode == "bench") {
+        size_t count = argc > 2 ? std::stoul(argv[2]) : SWEEP_MAX_POINTS;
+        size_t rounds = argc > 3 ? std::stoul(argv[3]) : 20000;
+        if (count == 0 || count > UINT16_MAX) {
+            std::cerr << "points must be 1 to " << UINT16_MAX << "\n";
+            return 2;
+        }
+        return bench(count, rounds);
+    }
+
+    if (mode == "encode" && argc == 4) {
+        std::ifstream in(argv[2]);
+        std::vector<sweep_point> points;
+        std::string line;
+        if (!in) {
+            std::cerr << "cannot open " << argv[2] << "\n";
+            return 1;
+        }
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            double index, angle, distance;
+            char comma1, comma2;
+            // The header and any malformed line are skipped
+            if (fields >> index >> comma1 >> angle >> comma2 >> distance) {
+                points.push_back({ (int32_t)std::lround(angle * 100.0), (uint16_t)std::lround(distance) });
+            }
+        }
+        std::vector<uint8_t> data = encode(points);
+        std::ofstream out(argv[3], std::ios::binary);
+        if (data.empty() || !out.write((const char *)data.data(), data.size())) {
+            std::cerr << "cannot encode to " << argv[3] << "\n";
+            return 1;
+        }
+        std::cerr << points.size() << " points, " << data.size() << " bytes\n";
+        return 0;
+    }
+
+    if (mode == "decode" && (argc == 3 || argc == 4)) {
+        std::ifstream in(argv[2], std::ios::binary);
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::vector<sweep_point> points;
+        std::vector<uint32_t> indices;
+        bool intact = decode(data, points, &indices);
+
+        std::ofstream file;
+        if (argc == 4) {
+            file.open(argv[3]);
+        }
+        std::ostream &out = (argc == 4) ? file : std::cout;
+        out << "index,angle_deg,distance_cm\n";
+        for (size_t i = 0; i < points.size(); i++) {
+            out << indices[i] << ',' << points[i].angle / 100.0 << ',' << points[i].distance << '\n';
+        }
+        if (!intact) {
+            std::cerr << "damaged scan; " << points.size() << " points recovered\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    std::cerr << "usage: " << argv[0] << " encode scan.csv scan.ssc\n"
+              << "       " << argv[0] << " decode scan.ssc [scan.csv]\n"
+              << "       " << argv[0] << " bench [points] [rounds]\n";
+    return 2;
+}
@@ -0,0 +1,108 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file serial_link.cpp
+ * @brief Host end of the framed USB link, over a raw POSIX tty.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#include "serial_link.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+serial_link::serial_link(const char *path) {
+    fd_ = open(path, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (fd_ < 0) {
+        throw std::runtime_error(std::string("cannot open ") + path + ": " + std::strerror(errno));
+    }
+
+    // No echo, no line editing, no CR/LF translation: the frames are binary.
+    // The baud rate means nothing to a CDC device and is left alone.
+    struct termios tio;
+    if (tcgetattr(fd_, &tio) == 0) {
+        cfmakeraw(&tio);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(fd_, TCSANOW, &tio);
+        tcflush(fd_, TCIFLUSH);
+    }
+    frame_decoder_init(&decoder_);
+}
+
+serial_link::serial_link(int fd) : fd_(fd) {
+    frame_decoder_init(&decoder_);
+}
+
+serial_link::~serial_link() {
+    close(fd_);
+}
+
+void serial_link::send(uint8_t type, uint8_t seq, const void *data, size_t length) {
+    uint8_t out[FRAME_MAX_ENCODED];
+    size_t n = frame_encode(type, seq, data, length, out);
+
+    if (n == 0) {
+        throw std::runtime_error("frame data too long");
+    }
+    for (size_t done = 0; done < n;) {
+        ssize_t w = write(fd_, out + done, n - done);
+        if (w < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            throw std::runtime_error(std::string("write: ") + std::strerror(errno));
+        }
+        done += (size_t)w;
+    }
+}
+
+bool serial_link::receive(frame &out, int timeout_ms) {
+    while (true) {
+        while (pos_ < len_) {
+            switch (frame_decode(&decoder_, buf_[pos_++], &out)) {
+            case FRAME_READY:
+                return true;
+            case FRAME_BAD:
+                bad_++;
+                break;
+            default:
+                break;
+            }
+        }
+
+        struct pollfd pfd = { fd_, POLLIN, 0 };
+        int ready = poll(&pfd, 1, timeout_ms);
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ready <= 0) {
+            return false;
+        }
+        ssize_t r = read(fd_, buf_, sizeof(buf_));
+        if (r < 0 && (errno == EINTR || errno == EAGAIN)) {
+            continue;
+        }
+        // End of file or an error such as EIO once the other end hangs up
+        if (r <= 0) {
+            return false;
+        }
+        pos_ = 0;
+        len_ = (size_t)r;
+    }
+}
@@ -0,0 +1,59 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file serial_link.h
+ * @brief Host end of the framed USB link, over a raw POSIX tty.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#ifndef SERIAL_LINK_H
+#define SERIAL_LINK_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "frame.h"
+
+/**
+ * @brief A tty carrying frames in both directions.
+ *
+ * Construction throws std::runtime_error if the tty cannot be opened.
+ */
+class serial_link {
+public:
+    // Open a tty device, such as /dev/ttyACM0, and put it in raw mode
+    explicit serial_link(const char *path);
+
+    // Take over an open descriptor, such as a pseudo-terminal master
+    explicit serial_link(int fd);
+
+    ~serial_link();
+    serial_link(const serial_link &) = delete;
+    serial_link &operator=(const serial_link &) = delete;
+
+    // Encode and write one frame; throws std::runtime_error on a write error
+    void send(uint8_t type, uint8_t seq, const void *data = nullptr, size_t length = 0);
+
+    // Wait up to timeout_ms for the next valid frame; false on timeout or hangup
+    bool receive(frame &out, int timeout_ms);
+
+    // Frames dropped for a bad CRC or bad encoding
+    size_t bad_frames() const { return bad_; }
+
+private:
+    int fd_;
+    frame_decoder decoder_;
+    uint8_t buf_[4096];
+    size_t pos_ = 0;    // Next byte of buf_ to decode
+    size_t len_ = 0;    // Bytes read into buf_
+    size_t bad_ = 0;
+};
+
+#endif // SERIAL_LINK_H
@@ -0,0 +1,263 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file size_report.cpp
+ * @brief Tabulates section sizes and kernel timings of the firmware variants.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Usage: size_report report.md NAME MAP BENCH [NAME MAP BENCH]...
+ *
+ * MAP is a variant's ESD_FINAL*.elf.map from the linker, BENCH the output
+ * of kernel_bench built with that variant's flags; either may be "-" or
+ * missing, which leaves its cells empty. Writes two Markdown tables, to
+ * report.md and stdout: the output sections and the flash and RAM they take
+ * for every variant, then every kernel's cycles per call. The first variant
+ * is the baseline the others are compared against.
+ */
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// RP2040 memory map
+#define FLASH_BASE (0x10000000u)
+#define FLASH_END (0x11000000u)
+#define SRAM_BASE (0x20000000u)
+#define SRAM_END (0x20042000u)
+
+// Sections with their own column; the rest count only in the totals
+static const char *const columns[] = { ".text", ".rodata", ".data", ".bss" };
+
+/**
+ * @brief One firmware variant as read from its files.
+ */
+struct variant {
+    std::string name;
+    bool have_map = false;
+    std::map<std::string, uint32_t> sections;   // Size of each output section
+    uint32_t flash = 0;                         // Image bytes in flash
+    uint32_t ram = 0;                           // Static RAM, without heap and stacks
+    bool have_bench = false;
+    std::string unit;
+    std::map<std::string, double> kernels;      // Cycles per call
+    std::vector<std::string> order;             // Kernels as listed
+};
+
+static bool in_flash(uint32_t address) { return address >= FLASH_BASE && address < FLASH_END; }
+static bool in_ram(uint32_t address) { return address >= SRAM_BASE && address < SRAM_END; }
+
+/**
+ * @brief Read the output sections of a GNU ld map file.
+ *
+ * An output section starts at column 0 after "Linker script and memory
+ * map"; a long name puts its address and size on the next line. The heap
+ * and stack reservations are left out of the RAM total since they do not
+ * change with the code.
+ */
+static bool read_map(const std::string &path, variant &v) {
+    std::ifstream in(path);
+    std::string line, pending;
+    bool started = false;
+
+    if (!in) {
+        return false;
+    }
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!started) {
+            started = line.rfind("Linker script and memory map", 0) == 0;
+            continue;
+        }
+
+        std::istringstream fields(line);
+        std::string name;
+        if (!line.empty() && line[0] == '.') {
+            fields >> name;
+        } else if (!pending.empty() && !line.empty() && (line[0] == ' ' || line[0] == '\t')) {
+            name = pending;
+        } else {
+            pending.clear();
+            continue;
+        }
+        pending.clear();
+
+        std::string address_text, size_text, load, address_word, load_text;
+        if (!(fields >> address_text >> size_text)) {
+            // Only the name on this line; the address may follow
+            pending = (line[0] == '.') ? name : "";
+            continue;
+        }
+        uint32_t address, size, lma;
+        try {
+            address = (uint32_t)std::stoul(address_text, nullptr, 16);
+            size = (uint32_t)std::stoul(size_text, nullptr, 16);
+        } catch (const std::exception &) {
+            continue;
+        }
+        lma = address;
+        if (fields >> load >> address_word >> load_text && load == "load") {
+            lma = (uint32_t)std::stoul(load_text, nullptr, 16);
+        }
+        if (size == 0 || !(in_flash(address) || in_ram(address))) {
+            continue;   // Empty, or debug information
+        }
+
+        v.sections[name] += size;
+        if (in_flash(lma)) {
+            v.flash += size;
+        }
+        if (in_ram(address) && name != ".heap" && name.rfind(".stack", 0) != 0) {
+            v.ram += size;
+        }
+    }
+    v.have_map = started;
+    return started;
+}
+
+/**
+ * @brief Read kernel_bench output: a "#" header naming the unit, then
+ * "kernel cycles" lines.
+ */
+static bool read_bench(const std::string &path, variant &v) {
+    std::ifstream in(path);
+    std::string line;
+
+    if (!in) {
+        return false;
+    }
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        if (line.rfind("#", 0) == 0) {
+            size_t comma = line.find(", ");
+            if (comma != std::string::npos) {
+                v.unit = line.substr(comma + 2, line.find(' ', comma + 2) - comma - 2);
+            }
+            continue;
+        }
+        std::string kernel;
+        double cycles;
+        if (fields >> kernel >> cycles) {
+            v.kernels[kernel] = cycles;
+            v.order.push_back(kernel);
+        }
+    }
+    v.have_bench = !v.kernels.empty();
+    return v.have_bench;
+}
+
+// A value and its change from the baseline, as "1234 (-5.2%)"
+static std::string compared(double value, double base, bool have_base) {
+    std::ostringstream s;
+    s << std::fixed << std::setprecision(0) << value;
+    if (have_base && base > 0) {
+        s << " (" << std::showpos << std::setprecision(1) << (value - base) * 100.0 / base << "%)";
+    }
+    return s.str();
+}
+
+static void write_report(std::ostream &out, const std::vector<variant> &variants) {
+    const variant &base = variants.front();
+
+    out << "## Sections (bytes)\n\n| variant |";
+    for (const char *c : columns) {
+        out << ' ' << c << " |";
+    }
+    out << " flash | RAM |\n|---|";
+    for (size_t i = 0; i < sizeof(columns) / sizeof(columns[0]) + 2; i++) {
+        out << "---:|";
+    }
+    out << '\n';
+    for (const variant &v : variants) {
+        out << "| " << v.name << " |";
+        for (const char *c : columns) {
+            auto it = v.sections.find(c);
+            out << ' ' << (v.have_map ? std::to_string(it == v.sections.end() ? 0u : it->second) : "-") << " |";
+        }
+        if (v.have_map) {
+            bool compare = base.have_map && &v != &base;
+            out << ' ' << compared(v.flash, base.flash, compare) << " | "
+                << compared(v.ram, base.ram, compare) << " |\n";
+        } else {
+            out << " - | - |\n";
+        }
+    }
+
+    // Kernels in the order of the first variant that has them
+    std::vector<std::string> kernels;
+    std::string unit;
+    for (const variant &v : variants) {
+        if (v.have_bench && kernels.empty()) {
+            unit = v.unit;
+            kernels = v.order;
+        }
+    }
+    if (kernels.empty()) {
+        return;
+    }
+    out << "\n## Kernels (host " << (unit.empty() ? "cycles" : unit) << " per call)\n\n| kernel |";
+    for (const variant &v : variants) {
+        out << ' ' << v.name << " |";
+    }
+    out << "\n|---|";
+    for (size_t i = 0; i < variants.size(); i++) {
+        out << "---:|";
+    }
+    out << '\n';
+    for (const std::string &k : kernels) {
+        out << "| " << k << " |";
+        auto b = base.kernels.find(k);
+        for (const variant &v : variants) {
+            auto it = v.kernels.find(k);
+            if (it == v.kernels.end()) {
+                out << " - |";
+            } else {
+                bool compare = b != base.kernels.end() && &v != &base;
+                out << ' ' << compared(it->second, compare ? b->second : 0.0, compare) << " |";
+            }
+        }
+        out << '\n';
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 5 || (argc - 2) % 3 != 0) {
+        std::cerr << "usage: " << argv[0] << " report.md NAME MAP BENCH [NAME MAP BENCH]...\n";
+        return 2;
+    }
+
+    std::vector<variant> variants;
+    for (int i = 2; i < argc; i += 3) {
+        variant v;
+        v.name = argv[i];
+        if (std::string(argv[i + 1]) != "-" && !read_map(argv[i + 1], v)) {
+            std::cerr << v.name << ": no map in " << argv[i + 1] << "\n";
+        }
+        if (std::string(argv[i + 2]) != "-" && !read_bench(argv[i + 2], v)) {
+            std::cerr << v.name << ": no timings in " << argv[i + 2] << "\n";
+        }
+        variants.push_back(v);
+    }
+
+    std::ofstream file(argv[1]);
+    if (!file) {
+        std::cerr << "cannot open " << argv[1] << "\n";
+        return 1;
+    }
+    write_report(file, variants);
+    write_report(std::cout, variants);
+    return 0;
+}
@@ -0,0 +1,294 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file ssm_export.cpp
+ * @brief Downloads the measurement journal, a sweep or the map over USB.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Usage: ssm_export /dev/ttyACM0 journal|scan|scan:ID|map [out.csv]
+ *
+ * "scan" is the last completed sweep, "scan:ID" the sweep stored with
+ * journal record ID; both are written as CSV, as is the journal. "map" is
+ * the occupancy grid of the last finished Map measurement, written as text:
+ * "OCCMAP <size> <cell_cm> <poses>", one "POSE x y heading" line per sweep,
+ * one line of hex cells per row from the top down, and "END".
+ *
+ * The board's USB port enumerates as a CDC serial device. Frames are
+ * checked by their CRC and sequence numbers, and each block of a scan by
+ * its own CRC; the summary on stderr gives the count, the throughput and
+ * anything lost. Without a board, tools/ssm_fakedev serves the same
+ * protocol on a pseudo-terminal.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "frame.h"
+#include "journal.h"
+#include "occupancy.h"
+#include "scan_codec.h"
+#include "serial_link.h"
+
+static_assert(sizeof(journal_record) == JOURNAL_RECORD_SIZE, "journal_record must match the firmware");
+
+// Longest wait for the next frame before giving up
+#define RECEIVE_TIMEOUT_MS (2000)
+
+/**
+ * @brief Write one journal record as a CSV row.
+ */
+static void write_record(std::ostream &out, uint32_t id, const journal_record &r) {
+    char shape[JOURNAL_SHAPE_LEN + 1] = {0};
+    std::memcpy(shape, r.shape, JOURNAL_SHAPE_LEN);
+
+    out << id << ',' << r.time_ms << ",\"" << shape << "\"," << (unsigned)r.steps << ','
+        << r.result[0] / 100.0 << ',' << r.result[1] / 100.0 << ',' << r.tilt[0] << ',' << r.tilt[1] << ','
+        << (r.scan_sector ? 1 : 0) << ",\"";
+    for (unsigned i = 0; i < r.steps && i < JOURNAL_MAX_VALUES; i++) {
+        out << (i ? " " : "") << r.values[i];
+    }
+    out << "\"\n";
+}
+
+/**
+ * @brief Place one scan or map frame's bytes in the data received so far.
+ *
+ * @return The number of bytes in the frame.
+ */
+static uint32_t add_chunk(std::vector<uint8_t> &scan, const frame &f) {
+    uint32_t offset;
+    uint32_t total;
+
+    if (f.length < 8) {
+        return 0;
+    }
+    std::memcpy(&offset, f.data, 4);
+    std::memcpy(&total, f.data + 4, 4);
+    uint32_t count = f.length - 8u;
+    if (offset + count > total) {
+        return 0;
+    }
+    scan.resize(total);
+    std::memcpy(&scan[offset], f.data + 8, count);
+    return count;
+}
+
+/**
+ * @brief Decode an encoded scan and write its points as CSV rows.
+ *
+ * @return The number of points lost to damaged blocks, or -1 if the scan
+ *         header is unreadable.
+ */
+static long write_scan(std::ostream &out, const std::vector<uint8_t> &scan) {
+    scan_reader reader;
+    long lost = 0;
+
+    if (!scan_reader_open(&reader, scan.data(), scan.size())) {
+        return -1;
+    }
+    std::vector<sweep_point> points(reader.block_points);
+    for (uint16_t block = 0; block < reader.blocks; block++) {
+        int n = scan_read_block(&reader, block, points.data());
+        uint32_t first = (uint32_t)block * reader.block_points;
+        if (n < 0) {
+            lost += std::min<long>(reader.block_points, reader.count - first);
+            continue;
+        }
+        for (int i = 0; i < n; i++) {
+            out << first + i << ',' << points[i].angle / 100.0 << ',' << points[i].distance << '\n';
+        }
+    }
+    return lost;
+}
+
+/**
+ * @brief Write the export form of an occupancy map (occupancy.h) as text.
+ *
+ * @return false if the map is truncated or its sizes do not match.
+ */
+static bool write_map(std::ostream &out, const std::vector<uint8_t> &map) {
+    static const char hex[] = "0123456789ABCDEF";
+
+    if (map.size() < OCC_EXPORT_HEADER) {
+        return false;
+    }
+    uint32_t size = map[0] | (map[1] << 8);
+    uint32_t cell_cm = map[2];
+    uint32_t poses = map[3];
+    size_t cells = OCC_EXPORT_HEADER + poses * sizeof(occ_pose);
+    if (map.size() != cells + (size_t)size * size / 2) {
+        return false;
+    }
+
+    out << "OCCMAP " << size << ' ' << cell_cm << ' ' << poses << '\n';
+    for (uint32_t i = 0; i < poses; i++) {
+        occ_pose pose;
+        std::memcpy(&pose, &map[OCC_EXPORT_HEADER + i * sizeof(occ_pose)], sizeof(pose));
+        out << "POSE " << pose.x << ' ' << pose.y << ' ' << pose.heading << '\n';
+    }
+    std::string row(size, '0');
+    for (uint32_t gy = size; gy-- > 0;) {
+        for (uint32_t gx = 0; gx < size; gx++) {
+            uint32_t index = gy * size + gx;
+            uint8_t byte = map[cells + index / 2];
+            row[gx] = hex[(index & 1) ? (byte >> 4) : (byte & 0x0F)];
+        }
+        out << row << '\n';
+    }
+    out << "END\n";
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3 || argc > 4) {
+        std::cerr << "usage: " << argv[0] << " /dev/ttyACM0 journal|scan|scan:ID|map [out.csv]\n";
+        return 2;
+    }
+
+    std::string what = argv[2];
+    uint8_t request;
+    uint32_t record_id = 0;
+    bool by_id = false;
+    if (what == "journal") {
+        request = FRAME_GET_JOURNAL;
+    } else if (what == "scan") {
+        request = FRAME_GET_SCAN;
+    } else if (what.rfind("scan:", 0) == 0) {
+        request = FRAME_GET_SCAN;
+        record_id = (uint32_t)std::stoul(what.substr(5));
+        by_id = true;
+    } else if (what == "map") {
+        request = FRAME_GET_MAP;
+    } else {
+        std::cerr << "unknown export \"" << what << "\"; use journal, scan, scan:ID or map\n";
+        return 2;
+    }
+
+    std::ofstream file;
+    if (argc == 4) {
+        file.open(argv[3]);
+        if (!file) {
+            std::cerr << "cannot open " << argv[3] << "\n";
+            return 1;
+        }
+    }
+    std::ostream &out = (argc == 4) ? file : std::cout;
+
+    try {
+        serial_link link(argv[1]);
+        auto start = std::chrono::steady_clock::now();
+        link.send(request, 0, by_id ? &record_id : nullptr, by_id ? 4 : 0);
+
+        if (request == FRAME_GET_JOURNAL) {
+            out << "id,time_ms,shape,steps,area_cm2,area_ft2,tilt_x,tilt_y,scan,values\n";
+        } else if (request == FRAME_GET_SCAN) {
+            out << "index,angle_deg,distance_cm\n";
+        }
+
+        frame f;
+        std::vector<uint8_t> scan;
+        std::vector<uint8_t> map;
+        uint32_t items = 0;
+        uint32_t gaps = 0;      // Frames missing from the sequence
+        size_t bytes = 0;
+        bool first = true;
+        uint8_t expect = 0;
+        bool ended = false;
+
+        while (!ended) {
+            if (!link.receive(f, RECEIVE_TIMEOUT_MS)) {
+                std::cerr << "no reply from " << argv[1] << " after " << items << " items\n";
+                return 1;
+            }
+            // The device numbers every frame it sends, so count from the first
+            if (f.seq != expect && !first) {
+                gaps += (uint8_t)(f.seq - expect);
+            }
+            first = false;
+            expect = f.seq + 1;
+            bytes += f.length;
+
+            switch (f.type) {
+            case FRAME_RECORD:
+                if (f.length == 4 + sizeof(journal_record)) {
+                    uint32_t id;
+                    journal_record r;
+                    std::memcpy(&id, f.data, 4);
+                    std::memcpy(&r, f.data + 4, sizeof(r));
+                    write_record(out, id, r);
+                    items++;
+                }
+                break;
+            case FRAME_SCAN:
+                items += add_chunk(scan, f);
+                break;
+            case FRAME_MAP:
+                items += add_chunk(map, f);
+                break;
+            case FRAME_END: {
+                uint32_t sent = 0;
+                uint8_t status = f.length >= 5 ? f.data[4] : FRAME_STATUS_OK;
+                std::memcpy(&sent, f.data, f.length >= 4 ? 4 : 0);
+                if (status == FRAME_STATUS_NO_DATA) {
+                    std::cerr << "nothing to export\n";
+                } else if (status != FRAME_STATUS_OK) {
+                    std::cerr << "request refused, status " << (unsigned)status << "\n";
+                    return 1;
+                }
+                if (sent != items) {
+                    std::cerr << "device sent " << sent << " items, " << items << " received\n";
+                    gaps += (sent > items);
+                }
+                ended = true;
+                break;
+            }
+            default:
+                break;
+            }
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (request == FRAME_GET_SCAN && !scan.empty()) {
+            long lost = write_scan(out, scan);
+            if (lost < 0) {
+                std::cerr << "scan header damaged\n";
+                return 1;
+            }
+            scan_reader reader;
+            scan_reader_open(&reader, scan.data(), scan.size());
+            std::cerr << reader.count << " points in " << scan.size() << " bytes ("
+                      << (reader.count ? (double)scan.size() / reader.count : 0.0) << " bytes per point), "
+                      << lost << " lost to damaged blocks\n";
+            gaps += (lost > 0);
+        }
+        if (request == FRAME_GET_MAP && !map.empty() && !write_map(out, map)) {
+            std::cerr << "map incomplete or malformed\n";
+            return 1;
+        }
+        const char *unit = (request == FRAME_GET_JOURNAL) ? "records"
+                         : (request == FRAME_GET_SCAN)    ? "scan bytes"
+                                                          : "map bytes";
+        std::cerr << items << " " << unit << ", "
+                  << bytes << " bytes in " << seconds * 1000.0 << " ms ("
+                  << (seconds > 0 ? bytes / seconds / 1024.0 : 0.0) << " KiB/s), "
+                  << link.bad_frames() << " bad frames, " << gaps << " lost\n";
+        return (gaps == 0 && link.bad_frames() == 0) ? 0 : 1;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,408 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file ssm_fakedev.cpp
+ * @brief Stand-in for the board's USB link on a pseudo-terminal.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Usage: ssm_fakedev [records]
+ *
+ * Opens a pseudo-terminal, prints the path of its slave end and answers
+ * requests on it as usb_link.c does, from a synthetic journal of the given
+ * number of records (100 by default) and a synthetic sweep of a 4 m by
+ * 3 m room, which also stands in for the sweep of every record; the map is
+ * built by occupancy.c from two sweeps of the same room. Remote
+ * control commands run a simulated menu: a capture step reads a made-up
+ * distance and a sweep completes at once. Starting the display mirror
+ * sends a burst of frames of a menu with a moving cursor. Point the host
+ * tools at the
+ * printed path:
+ *   ./ssm_fakedev > dev.txt & ./ssm_export "$(head -1 dev.txt)" journal
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "fb_delta.h"
+#include "frame.h"
+#include "journal.h"
+#include "occupancy.h"
+#include "scan_codec.h"
+#include "serial_link.h"
+#include "sweep.h"
+#include "ui_fsm.h"
+
+static_assert(sizeof(journal_record) == JOURNAL_RECORD_SIZE, "journal_record must match the firmware");
+
+/**
+ * @brief A journal of made-up measurements.
+ */
+static std::vector<journal_record> make_journal(uint32_t count) {
+    static const char *const shapes[] = { "Rectangle", "Circle", "Triangle", "Sweep" };
+    std::vector<journal_record> journal(count);
+
+    for (uint32_t i = 0; i < count; i++) {
+        journal_record &r = journal[i];
+        std::memset(&r, 0, sizeof(r));
+        r.time_ms = 60000 + i * 4500;
+        std::strncpy(r.shape, shapes[i % 4], JOURNAL_SHAPE_LEN - 1);
+        r.steps = (i % 4 == 3) ? 0 : 2;
+        for (uint8_t k = 0; k < r.steps; k++) {
+            r.values[k] = (uint16_t)(200 + (i * 37 + k * 91) % 500);
+        }
+        r.result[0] = (int32_t)(120000 + i * 1234);
+        r.result[1] = (int32_t)(r.result[0] / 929.03);
+        r.tilt[0] = (int16_t)(i % 7) - 3;
+        r.tilt[1] = (int16_t)(i % 5) - 2;
+        r.scan_sector = (i % 4 == 3) ? 1 : 0;
+        r.commit = 0;
+    }
+    return journal;
+}
+
+/**
+ * @brief A sweep from the middle of a 400 x 300 cm room, about one point
+ * per degree, encoded as the firmware stores it.
+ */
+static std::vector<uint8_t> make_scan() {
+    std::vector<uint8_t> scan(SCAN_ENCODED_MAX(360));
+    scan_writer writer;
+
+    scan_writer_init(&writer, scan.data(), scan.size(), 360);
+    for (int i = 0; i < 360; i++) {
+        int32_t angle = i * 100 + (i * 7919) % 23 - 11;
+        double a = angle * M_PI / 18000.0;
+        double dx = std::fabs(200.0 / std::cos(a));
+        double dy = std::fabs(150.0 / std::sin(a));
+        sweep_point point = { angle, (uint16_t)std::lround(std::fmin(dx, dy)) };
+        scan_writer_add(&writer, &point);
+    }
+    scan.resize(scan_writer_finish(&writer));
+    return scan;
+}
+
+/**
+ * @brief Sweep of the 400 x 300 cm room from (x, y) cm off its middle, fed
+ * through the sweep code at 1 degree per 10 ms gyro sample.
+ */
+static void sweep_room(sweep_scan *scan, double x, double y) {
+    sweep_init(scan, 0, 0);
+    for (uint32_t i = 1; i <= 360; i++) {
+        sweep_update_yaw(scan, 10000, i * 10000ull);
+        double a = sweep_yaw(scan) * M_PI / 18000.0;
+        double c = std::cos(a), s = std::sin(a);
+        double dx = std::fabs(((c > 0 ? 200.0 : -200.0) - x) / c);
+        double dy = std::fabs(((s > 0 ? 150.0 : -150.0) - y) / s);
+        sweep_add_sample(scan, (uint16_t)std::lround(std::fmin(dx, dy)));
+    }
+}
+
+/**
+ * @brief An occupancy map of the room from its middle and from 60 cm east
+ * and 40 cm south of it.
+ */
+static void make_map(occ_map *map) {
+    static sweep_scan scan;
+    occ_pose poses[] = { { 0, 0, 0 }, { 60, -40, 0 } };
+
+    occ_init(map);
+    for (const occ_pose &pose : poses) {
+        sweep_room(&scan, pose.x, pose.y);
+        occ_add_scan(map, &scan, &pose);
+    }
+}
+
+/**
+ * @brief Distances each shape captures, as area.c's plans; 0 for a sweep.
+ * Returns -1 for a name that is not measured.
+ */
+static int shape_steps(const std::string &shape) {
+    static const struct {
+        const char *name;
+        int steps;
+    } shapes[] = { { "Distance", 1 }, { "Circle", 1 }, { "Rectangle", 2 }, { "Triangle", 3 }, { "Sweep", 0 },
+                   { "Map", 0 }, { "shape1", 6 }, { "shape2", 8 }, { "shape3", 8 }, { "shape4", 12 },
+                   { "shape5", 3 }, { "walls", 0 } };
+    for (const auto &s : shapes) {
+        if (shape == s.name) {
+            return s.steps;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief The simulated user interface the remote control drives.
+ */
+struct fake_ui {
+    uint8_t state = UI_STATE_MENU;
+    std::string shape = "Distance";
+    uint8_t step = 0;
+    uint8_t steps = 0;
+    uint16_t values[JOURNAL_MAX_VALUES] = {};
+};
+
+/**
+ * @brief The device end of the link: one sequence number for every frame.
+ */
+struct fake_link {
+    serial_link &link;
+    uint8_t seq = 0;
+
+    void send(uint8_t type, const void *data = nullptr, size_t length = 0) {
+        link.send(type, seq++, data, length);
+    }
+};
+
+static void send_result(fake_link &out, fake_ui &ui) {
+    uint8_t data[8 + JOURNAL_SHAPE_LEN];
+    int32_t result[2] = { 0, 0 };
+
+    // A sweep of the room, or the product of the captured distances
+    if (ui.steps == 0) {
+        result[0] = 1200000;
+    } else {
+        result[0] = 100;
+        for (uint8_t i = 0; i < ui.steps && i < 2; i++) {
+            result[0] *= ui.values[i];
+        }
+    }
+    result[1] = (int32_t)(result[0] / 929.03);
+    std::memcpy(data, result, sizeof(result));
+    size_t length = std::min<size_t>(ui.shape.size(), JOURNAL_SHAPE_LEN);
+    std::memcpy(data + 8, ui.shape.data(), length);
+    out.send(FRAME_RESULT, data, 8 + length);
+    ui.state = UI_STATE_RESULT;
+}
+
+/**
+ * @brief Send frames of the display mirror as mirror.c does: a keyframe,
+ * then the changed rows of a menu whose cursor steps down every frame.
+ */
+static void send_mirror(fake_link &out, uint32_t count) {
+    const uint8_t row_bytes = 16, height = 128;
+    std::vector<uint8_t> screen(row_bytes * height, 0), host(screen.size(), 0);
+    std::vector<uint8_t> packet(sizeof(fb_delta_header) + FB_DELTA_MAX(screen.size()));
+    uint8_t data[FRAME_MAX_DATA];
+
+    // Menu text stands in as a dotted pattern on every 12th row band
+    for (int line = 0; line < 8; line++) {
+        for (int y = 14 + line * 12; y < 22 + line * 12; y++) {
+            for (int x = 2; x < 12; x++) {
+                screen[y * row_bytes + x] = (uint8_t)(0x55 << (y & 1)) | (uint8_t)(line * 17 + x);
+            }
+        }
+    }
+    for (uint32_t n = 0; n < count; n++) {
+        int first = 0, end = height;
+        if (n > 0) {
+            // Clear the old cursor and draw the new one, as menu.c does
+            int was = 14 + (int)((n - 1) % 8) * 12, now = 14 + (int)(n % 8) * 12;
+            for (int y = 0; y < 8; y++) {
+                screen[(was + y) * row_bytes] = 0;
+                screen[(now + y) * row_bytes] = 0x3C;
+            }
+            first = std::min(was, now);
+            end = std::max(was, now) + 8;
+        }
+        fb_delta_header h = { 1000000 + n * 33000, 1, row_bytes, height, (uint8_t)first, (uint8_t)(end - first),
+                              (uint8_t)(n == 0 ? FB_DELTA_KEYFRAME : 0), 0 };
+        std::memcpy(packet.data(), &h, sizeof(h));
+        uint16_t total = (uint16_t)(sizeof(h) + fb_delta_encode(&screen[first * row_bytes], &host[first * row_bytes],
+                                                                (end - first) * row_bytes, &packet[sizeof(h)]));
+        std::memcpy(&host[first * row_bytes], &screen[first * row_bytes], (end - first) * row_bytes);
+
+        uint16_t number = (uint16_t)(n + 1);
+        for (uint16_t offset = 0; offset < total;) {
+            uint16_t chunk = (uint16_t)std::min<size_t>(FRAME_MAX_DATA - 6, total - offset);
+            std::memcpy(data, &number, 2);
+            std::memcpy(data + 2, &offset, 2);
+            std::memcpy(data + 4, &total, 2);
+            std::memcpy(data + 6, &packet[offset], chunk);
+            out.send(FRAME_MIRROR, data, 6 + chunk);
+            offset += chunk;
+        }
+    }
+}
+
+/**
+ * @brief Answer a remote control command as remote.c does, then send the
+ * notices the UI would.
+ *
+ * @return false if the frame is not a command.
+ */
+static bool command(fake_link &out, fake_ui &ui, const frame &request) {
+    uint8_t reply[FRAME_MAX_DATA] = { request.seq, FRAME_STATUS_OK };
+    size_t length = 2;
+    bool finished = false;  // A sweep ran to its result
+
+    switch (request.type) {
+    case FRAME_CMD_PING:
+        std::memcpy(reply + 2, request.data, request.length);
+        length += request.length;
+        break;
+    case FRAME_CMD_PRESS:
+        if (request.length < 1 || request.data[0] > 1) {
+            reply[1] = FRAME_STATUS_BAD_ARG;
+        }
+        break;
+    case FRAME_CMD_MEASURE: {
+        std::string shape((const char *)request.data, request.length);
+        int steps = shape_steps(shape);
+        if (steps < 0) {
+            reply[1] = FRAME_STATUS_BAD_ARG;
+        } else if (ui.state == UI_STATE_MEASURE) {
+            reply[1] = FRAME_STATUS_BUSY;
+        } else {
+            ui.state = UI_STATE_MEASURE;
+            ui.shape = shape;
+            ui.step = 0;
+            ui.steps = (uint8_t)steps;
+            finished = (steps == 0);
+        }
+        break;
+    }
+    case FRAME_CMD_STATUS:
+        reply[2] = ui.state;
+        reply[3] = (ui.state == UI_STATE_MEASURE) ? ui.step : 0;
+        reply[4] = (ui.state == UI_STATE_MEASURE) ? ui.steps : 0;
+        std::memcpy(reply + 5, ui.shape.data(), ui.shape.size());
+        length = 5 + ui.shape.size();
+        break;
+    case FRAME_CMD_MIRROR:
+        if (request.length < 1 || request.data[0] > 1) {
+            reply[1] = FRAME_STATUS_BAD_ARG;
+        }
+        break;
+    default:
+        return false;
+    }
+    out.send(FRAME_REPLY, reply, length);
+
+    if (request.type == FRAME_CMD_MIRROR && reply[1] == FRAME_STATUS_OK && request.data[0] == 1) {
+        send_mirror(out, 120);
+    }
+
+    // Red captures or leaves the result, holding Yellow cancels
+    bool pressed = request.type == FRAME_CMD_PRESS && reply[1] == FRAME_STATUS_OK;
+    bool red = pressed && request.data[0] == 1;
+    bool hold = pressed && request.data[0] == 0 && request.length >= 2 && request.data[1] == 1;
+    if (ui.state == UI_STATE_MEASURE && ui.steps > 0 && hold) {
+        ui.state = UI_STATE_MENU;
+        out.send(FRAME_CANCELLED);
+    } else if (ui.state == UI_STATE_MEASURE && ui.steps > 0 && red) {
+        uint16_t distance = (uint16_t)(150 + (ui.step * 83) % 300);
+        uint8_t data[4] = { (uint8_t)(ui.step + 1), ui.steps };
+        ui.values[ui.step++] = distance;
+        std::memcpy(data + 2, &distance, 2);
+        out.send(FRAME_CAPTURED, data, sizeof(data));
+        finished = (ui.step == ui.steps);
+    } else if (ui.state == UI_STATE_RESULT && red) {
+        ui.state = UI_STATE_MENU;
+    }
+    if (finished) {
+        send_result(out, ui);
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    uint32_t records = (argc > 1) ? (uint32_t)std::strtoul(argv[1], nullptr, 10) : 100;
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        std::perror("posix_openpt");
+        return 1;
+    }
+    const char *path = ptsname(master);
+
+    // Hold the slave open so a client closing it does not hang up the
+    // master, and make it raw so nothing is echoed or translated
+    int slave = open(path, O_RDWR | O_NOCTTY);
+    struct termios tio;
+    if (slave < 0 || tcgetattr(slave, &tio) != 0) {
+        std::perror(path);
+        return 1;
+    }
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+
+    std::cout << path << std::endl;
+
+    std::vector<journal_record> journal = make_journal(records);
+    std::vector<uint8_t> scan = make_scan();
+    static occ_map map;
+    make_map(&map);
+    serial_link link(master);
+    fake_link out{ link };
+    fake_ui ui;
+    frame request;
+
+    while (true) {
+        if (!link.receive(request, -1) || command(out, ui, request)) {
+            continue;
+        }
+
+        uint32_t sent = 0;
+        uint8_t status = FRAME_STATUS_OK;
+        uint8_t data[FRAME_MAX_DATA];
+
+        if (request.type == FRAME_GET_JOURNAL) {
+            for (uint32_t i = 0; i < journal.size(); i++) {
+                uint32_t id = i;
+                std::memcpy(data, &id, 4);
+                std::memcpy(data + 4, &journal[i], sizeof(journal_record));
+                out.send(FRAME_RECORD, data, 4 + sizeof(journal_record));
+                sent++;
+            }
+        } else if (request.type == FRAME_GET_SCAN) {
+            uint32_t id = 0;
+            std::memcpy(&id, request.data, request.length >= 4 ? 4 : 0);
+            if (request.length >= 4 && (id >= journal.size() || !journal[id].scan_sector)) {
+                status = FRAME_STATUS_NO_DATA;
+            }
+            uint32_t total = status == FRAME_STATUS_OK ? (uint32_t)scan.size() : 0;
+            for (uint32_t offset = 0; offset < total; offset += FRAME_SCAN_CHUNK) {
+                uint32_t count = (uint32_t)std::min<size_t>(FRAME_SCAN_CHUNK, total - offset);
+                std::memcpy(data, &offset, 4);
+                std::memcpy(data + 4, &total, 4);
+                std::memcpy(data + 8, &scan[offset], count);
+                out.send(FRAME_SCAN, data, 8 + count);
+                sent += count;
+            }
+        } else if (request.type == FRAME_GET_MAP) {
+            uint32_t total = occ_export_size(&map);
+            for (uint32_t offset = 0; offset < total; offset += FRAME_MAP_CHUNK) {
+                uint32_t count = (uint32_t)occ_export_read(&map, offset, data + 8, FRAME_MAP_CHUNK);
+                std::memcpy(data, &offset, 4);
+                std::memcpy(data + 4, &total, 4);
+                out.send(FRAME_MAP, data, 8 + count);
+                sent += count;
+            }
+        } else {
+            status = FRAME_STATUS_UNKNOWN;
+        }
+
+        std::memcpy(data, &sent, 4);
+        data[4] = status;
+        out.send(FRAME_END, data, 5);
+    }
+}
@@ -0,0 +1,242 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file ssm_mirror.cpp
+ * @brief Records the SS Mapper's OLED over USB as a sequence of PNG files.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Usage: ssm_mirror /dev/ttyACM0 outdir [seconds]
+ *
+ * Turns the display mirror on, rebuilds every frame from the compressed
+ * deltas, writes outdir/frame_00000.png and on, and turns the mirror off
+ * after the given time (10 s by default). The summary gives the frame rate
+ * by the device clock, the OLED updates folded together because the link
+ * was busy, and the bytes per frame against the raw framebuffer. A lost or
+ * damaged packet asks the device for a fresh keyframe.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "fb_delta.h"
+#include "frame.h"
+#include "serial_link.h"
+
+// Longest wait for one frame before checking the clock again
+#define POLL_MS (100)
+
+using steady = std::chrono::steady_clock;
+
+/**
+ * @brief Writes 1-bit grayscale PNG files, stored without compression.
+ *
+ * The framebuffer is one bit per pixel, most significant bit leftmost and
+ * 1 for a lit pixel, which is PNG's own layout; stored deflate blocks keep
+ * the writer free of zlib.
+ */
+class png_writer {
+public:
+    png_writer() {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            crc_table_[n] = c;
+        }
+    }
+
+    bool write(const std::string &path, const uint8_t *image, uint32_t row_bytes, uint32_t height) {
+        std::vector<uint8_t> raw;
+        for (uint32_t y = 0; y < height; y++) {
+            raw.push_back(0);   // No filter
+            raw.insert(raw.end(), image + y * row_bytes, image + (y + 1) * row_bytes);
+        }
+
+        std::vector<uint8_t> ihdr, idat = { 0x78, 0x01 };
+        put32(ihdr, row_bytes * 8);
+        put32(ihdr, height);
+        ihdr.insert(ihdr.end(), { 1, 0, 0, 0, 0 });  // 1 bit, grayscale
+        for (size_t at = 0; at < raw.size() || at == 0; at += 65535) {
+            size_t n = std::min<size_t>(65535, raw.size() - at);
+            idat.push_back(at + n == raw.size() ? 1 : 0);
+            idat.insert(idat.end(), { (uint8_t)n, (uint8_t)(n >> 8), (uint8_t)~n, (uint8_t)(~n >> 8) });
+            idat.insert(idat.end(), raw.begin() + at, raw.begin() + at + n);
+        }
+        put32(idat, adler32(raw));
+
+        std::ofstream out(path, std::ios::binary);
+        static const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        out.write((const char *)signature, sizeof(signature));
+        chunk(out, "IHDR", ihdr);
+        chunk(out, "IDAT", idat);
+        chunk(out, "IEND", {});
+        return (bool)out;
+    }
+
+private:
+    static void put32(std::vector<uint8_t> &v, uint32_t x) {
+        v.insert(v.end(), { (uint8_t)(x >> 24), (uint8_t)(x >> 16), (uint8_t)(x >> 8), (uint8_t)x });
+    }
+
+    static uint32_t adler32(const std::vector<uint8_t> &data) {
+        uint32_t a = 1, b = 0;
+        for (uint8_t byte : data) {
+            a = (a + byte) % 65521;
+            b = (b + a) % 65521;
+        }
+        return (b << 16) | a;
+    }
+
+    void chunk(std::ofstream &out, const char *type, const std::vector<uint8_t> &data) {
+        std::vector<uint8_t> body(type, type + 4);
+        body.insert(body.end(), data.begin(), data.end());
+        uint32_t crc = 0xFFFFFFFFu;
+        for (uint8_t byte : body) {
+            crc = crc_table_[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+        }
+        std::vector<uint8_t> head, tail;
+        put32(head, (uint32_t)data.size());
+        put32(tail, crc ^ 0xFFFFFFFFu);
+        out.write((const char *)head.data(), 4);
+        out.write((const char *)body.data(), body.size());
+        out.write((const char *)tail.data(), 4);
+    }
+
+    uint32_t crc_table_[256];
+};
+
+int main(int argc, char **argv) {
+    if (argc < 3 || argc > 4) {
+        std::cerr << "usage: " << argv[0] << " /dev/ttyACM0 outdir [seconds]\n";
+        return 2;
+    }
+    std::string dir = argv[2];
+    double seconds = argc > 3 ? std::stod(argv[3]) : 10.0;
+    mkdir(dir.c_str(), 0777);
+
+    try {
+        serial_link link(argv[1]);
+        png_writer png;
+        uint8_t seq = 0;
+        uint8_t on = 1;
+        link.send(FRAME_CMD_MIRROR, seq++, &on, 1);
+
+        std::vector<uint8_t> image;
+        std::vector<uint8_t> packet;
+        uint16_t packet_number = 0;
+        uint32_t received = 0;          // Bytes of the packet so far
+        bool synced = false;            // A keyframe has been applied
+        uint32_t frames = 0;
+        uint32_t updates = 0;
+        uint32_t folded = 0;            // Updates that reached the host inside a later one
+        uint32_t resyncs = 0;
+        size_t bytes = 0;
+        uint32_t first_us = 0, last_us = 0;
+
+        auto start = steady::now();
+        while (std::chrono::duration<double>(steady::now() - start).count() < seconds) {
+            frame f;
+            if (!link.receive(f, POLL_MS)) {
+                continue;
+            }
+            if (f.type == FRAME_REPLY && f.length >= 2 && f.data[1] != FRAME_STATUS_OK) {
+                std::cerr << "the device refused the mirror, status " << (unsigned)f.data[1]
+                          << (f.data[1] == FRAME_STATUS_UNKNOWN ? " (built without SSM_MIRROR)" : "") << "\n";
+                return 1;
+            }
+            if (f.type != FRAME_MIRROR || f.length < 6) {
+                continue;
+            }
+            bytes += f.length;
+
+            uint16_t number, offset, total;
+            std::memcpy(&number, f.data, 2);
+            std::memcpy(&offset, f.data + 2, 2);
+            std::memcpy(&total, f.data + 4, 2);
+            if (offset == 0) {
+                packet.assign(total, 0);
+                packet_number = number;
+                received = 0;
+            }
+            if (number != packet_number || offset != received || offset + f.length - 6u > packet.size()) {
+                // A chunk went missing; what the host has no longer matches
+                if (synced) {
+                    link.send(FRAME_CMD_MIRROR, seq++, &on, 1);
+                    resyncs++;
+                    synced = false;
+                }
+                received = 0;
+                continue;
+            }
+            std::memcpy(&packet[offset], f.data + 6, f.length - 6u);
+            received += f.length - 6u;
+            if (received < total || total < sizeof(fb_delta_header)) {
+                continue;
+            }
+
+            fb_delta_header h;
+            std::memcpy(&h, packet.data(), sizeof(h));
+            if (h.flags & FB_DELTA_KEYFRAME) {
+                image.assign((size_t)h.row_bytes * h.height, 0);
+                synced = true;
+            }
+            if (!synced || (size_t)(h.first_row + h.rows) * h.row_bytes > image.size() ||
+                !fb_delta_apply(&image[(size_t)h.first_row * h.row_bytes], (size_t)h.rows * h.row_bytes,
+                                packet.data() + sizeof(h), total - sizeof(h))) {
+                if (synced) {
+                    link.send(FRAME_CMD_MIRROR, seq++, &on, 1);
+                    resyncs++;
+                    synced = false;
+                }
+                continue;
+            }
+
+            char name[32];
+            std::snprintf(name, sizeof(name), "/frame_%05u.png", frames);
+            if (!png.write(dir + name, image.data(), h.row_bytes, h.height)) {
+                std::cerr << "cannot write " << dir + name << "\n";
+                return 1;
+            }
+            if (frames == 0) {
+                first_us = h.time_us;
+            }
+            last_us = h.time_us;
+            frames++;
+            updates += h.updates;
+            folded += h.updates > 1 ? h.updates - 1u : 0u;
+        }
+
+        uint8_t off = 0;
+        link.send(FRAME_CMD_MIRROR, seq++, &off, 1);
+
+        double device_s = (last_us - first_us) / 1e6;
+        size_t raw = image.size();
+        std::cerr << frames << " frames in " << dir << ", " << (frames > 1 && device_s > 0 ? (frames - 1) / device_s : 0.0)
+                  << " fps by the device clock; " << updates << " OLED updates, "
+                  << folded << " folded into later frames\n"
+                  << (frames ? (double)bytes / frames : 0.0) << " bytes per frame against " << raw << " raw, "
+                  << link.bad_frames() << " bad frames, " << resyncs << " resyncs\n";
+        return frames > 0 ? 0 : 1;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
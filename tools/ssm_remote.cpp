@@ -0,0 +1,322 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file ssm_remote.cpp
+ * @brief Drives the SS Mapper's remote control over USB and times it.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Usage: ssm_remote /dev/ttyACM0 COMMAND...
+ *   ping [count] [depth]       round trips, depth commands in flight at once
+ *   press yellow|red [long]    press a button
+ *   measure SHAPE              run a measurement, pressing Red for every
+ *                              capture step, and print the result
+ *   status                     what the UI is doing
+ *   -                          read commands from stdin, one per line
+ *
+ * ping prints the latency percentiles and the command rate; measure prints
+ * how long after each press its capture was reported, and the whole
+ * measurement. The exit status is non-zero if any command failed.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "frame.h"
+#include "serial_link.h"
+#include "ui_fsm.h"
+
+// Longest wait for a reply
+#define REPLY_TIMEOUT_MS (2000)
+
+// Longest wait for a measurement to report back; a sweep takes a while
+#define MEASURE_TIMEOUT_MS (120000)
+
+// Most commands a ping keeps in flight
+#define MAX_DEPTH (64)
+
+using steady = std::chrono::steady_clock;
+
+static const char *const state_names[] = { "menu", "irregular menu", "measure", "result", "stats", "history" };
+
+static double ms_since(steady::time_point t) {
+    return std::chrono::duration<double, std::milli>(steady::now() - t).count();
+}
+
+/**
+ * @brief The host end of the remote control.
+ *
+ * Measurement notices that arrive while waiting for a reply are kept for
+ * next_notice(), so nothing is lost by interleaving.
+ */
+class remote {
+public:
+    explicit remote(const char *path) : link_(path) {}
+
+    // Send a command; returns its sequence number
+    uint8_t send(uint8_t type, const void *data = nullptr, size_t length = 0) {
+        link_.send(type, seq_, data, length);
+        return seq_++;
+    }
+
+    // Wait for the reply to the command with sequence number seq
+    bool reply(uint8_t seq, frame &out) {
+        frame f;
+        while (link_.receive(f, REPLY_TIMEOUT_MS)) {
+            if (f.type == FRAME_REPLY && f.length >= 2) {
+                if (f.data[0] == seq) {
+                    out = f;
+                    return true;
+                }
+            } else if (f.type == FRAME_CAPTURED || f.type == FRAME_RESULT || f.type == FRAME_CANCELLED) {
+                notices_.push_back(f);
+            }
+        }
+        return false;
+    }
+
+    // Send a command and wait for its reply; throws if none comes
+    uint8_t call(uint8_t type, const void *data = nullptr, size_t length = 0, frame *out = nullptr) {
+        frame f;
+        if (!reply(send(type, data, length), f)) {
+            throw std::runtime_error("no reply from the device");
+        }
+        if (out) {
+            *out = f;
+        }
+        return f.data[1];
+    }
+
+    // Wait for the next measurement notice
+    bool next_notice(frame &out, int timeout_ms) {
+        auto start = steady::now();
+        while (notices_.empty()) {
+            frame f;
+            int left = timeout_ms - (int)ms_since(start);
+            if (left <= 0 || !link_.receive(f, left)) {
+                return false;
+            }
+            if (f.type == FRAME_CAPTURED || f.type == FRAME_RESULT || f.type == FRAME_CANCELLED) {
+                notices_.push_back(f);
+            }
+        }
+        out = notices_.front();
+        notices_.pop_front();
+        return true;
+    }
+
+    bool has_ending() const {
+        return std::any_of(notices_.begin(), notices_.end(), [](const frame &f) {
+            return f.type == FRAME_RESULT || f.type == FRAME_CANCELLED;
+        });
+    }
+
+    size_t bad_frames() const { return link_.bad_frames(); }
+
+private:
+    serial_link link_;
+    uint8_t seq_ = 0;
+    std::deque<frame> notices_;
+};
+
+static bool report_status(const char *what, uint8_t status) {
+    static const char *const names[] = { "ok", "no data", "unknown command", "busy", "bad argument" };
+    if (status != FRAME_STATUS_OK) {
+        std::cerr << what << ": " << (status < 5 ? names[status] : "error " + std::to_string(status)) << "\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Time round trips with up to depth commands in flight.
+ */
+static bool ping(remote &r, uint32_t count, uint32_t depth) {
+    std::vector<steady::time_point> sent_at(256);
+    std::vector<double> latency;
+    uint32_t sent = 0;
+    uint8_t oldest = 0;
+
+    depth = std::max<uint32_t>(1, std::min<uint32_t>(depth, MAX_DEPTH));
+    auto start = steady::now();
+    while (latency.size() < count) {
+        // Keep the pipeline full; the device answers in order
+        while (sent < count && sent - latency.size() < depth) {
+            sent_at[(uint8_t)sent] = steady::now();
+            uint8_t seq = r.send(FRAME_CMD_PING, &sent, 4);
+            if (sent == 0) {
+                oldest = seq;
+            }
+            sent++;
+        }
+        frame f;
+        uint32_t echo = 0;
+        uint32_t expect = (uint32_t)latency.size();
+        if (!r.reply((uint8_t)(oldest + expect), f)) {
+            std::cerr << "ping " << expect << ": no reply\n";
+            return false;
+        }
+        std::memcpy(&echo, f.data + 2, f.length >= 6 ? 4 : 0);
+        if (f.data[1] != FRAME_STATUS_OK || f.length != 6 || echo != expect) {
+            std::cerr << "ping " << expect << ": bad echo\n";
+            return false;
+        }
+        latency.push_back(std::chrono::duration<double, std::micro>(steady::now() - sent_at[(uint8_t)expect]).count());
+    }
+    double seconds = ms_since(start) / 1000.0;
+
+    std::sort(latency.begin(), latency.end());
+    auto pct = [&](double p) { return latency[std::min(latency.size() - 1, (size_t)(p * latency.size()))]; };
+    std::cout << count << " pings, depth " << depth << ": min " << latency.front() << " us, median " << pct(0.5)
+              << " us, p99 " << pct(0.99) << " us, max " << latency.back() << " us, "
+              << count / seconds << " commands/s\n";
+    return true;
+}
+
+static bool press(remote &r, const std::string &button, bool hold) {
+    if (button != "yellow" && button != "red") {
+        std::cerr << "press: yellow or red\n";
+        return false;
+    }
+    uint8_t data[2] = { (uint8_t)(button == "red"), (uint8_t)hold };
+    return report_status("press", r.call(FRAME_CMD_PRESS, data, sizeof(data)));
+}
+
+static bool status(remote &r) {
+    frame f;
+    if (!report_status("status", r.call(FRAME_CMD_STATUS, nullptr, 0, &f)) || f.length < 5) {
+        return false;
+    }
+    uint8_t state = f.data[2];
+    std::cout << "state " << (state < 6 ? state_names[state] : "?") << ", step " << (unsigned)f.data[3]
+              << " of " << (unsigned)f.data[4] << ", shape \"" << std::string((const char *)f.data + 5, f.length - 5)
+              << "\"\n";
+    return true;
+}
+
+/**
+ * @brief Run a measurement to its result.
+ *
+ * Once the UI has taken the measurement, the status tells how many
+ * distances it captures; each is triggered by a remote Red press and
+ * reported back as soon as it is taken. A sweep captures on its own.
+ */
+static bool measure(remote &r, const std::string &shape) {
+    auto start = steady::now();
+    if (!report_status("measure", r.call(FRAME_CMD_MEASURE, shape.data(), shape.size()))) {
+        return false;
+    }
+
+    int steps = -1;
+    for (int poll = 0; poll < 100 && steps < 0 && !r.has_ending(); poll++) {
+        frame f;
+        if (r.call(FRAME_CMD_STATUS, nullptr, 0, &f) == FRAME_STATUS_OK && f.length >= 5 &&
+            f.data[2] == UI_STATE_MEASURE) {
+            steps = f.data[4];
+        }
+    }
+
+    frame f;
+    for (int step = 0; step < steps; step++) {
+        auto pressed = steady::now();
+        uint8_t red[1] = { 1 };
+        if (!report_status("press", r.call(FRAME_CMD_PRESS, red, sizeof(red)))) {
+            return false;
+        }
+        if (!r.next_notice(f, MEASURE_TIMEOUT_MS) || f.type != FRAME_CAPTURED || f.length < 4) {
+            std::cerr << "measure: " << (f.type == FRAME_CANCELLED ? "cancelled" : "no capture reported") << "\n";
+            return false;
+        }
+        uint16_t distance;
+        std::memcpy(&distance, f.data + 2, 2);
+        std::cout << "step " << (unsigned)f.data[0] << "/" << (unsigned)f.data[1] << ": " << distance << " cm, "
+                  << ms_since(pressed) << " ms after the press\n";
+    }
+
+    if (!r.next_notice(f, MEASURE_TIMEOUT_MS) || f.type != FRAME_RESULT || f.length < 8) {
+        std::cerr << "measure: " << (f.type == FRAME_CANCELLED ? "cancelled" : "no result reported") << "\n";
+        return false;
+    }
+    int32_t result[2];
+    std::memcpy(result, f.data, sizeof(result));
+    std::cout << std::string((const char *)f.data + 8, f.length - 8) << ": " << result[0] / 100.0 << ", "
+              << result[1] / 100.0 << " in " << ms_since(start) << " ms\n";
+    return true;
+}
+
+/**
+ * @brief Run one command line.
+ */
+static bool run(remote &r, const std::vector<std::string> &args) {
+    const std::string &cmd = args[0];
+
+    if (cmd == "ping" && args.size() <= 3) {
+        return ping(r, args.size() > 1 ? std::stoul(args[1]) : 1000, args.size() > 2 ? std::stoul(args[2]) : 1);
+    }
+    if (cmd == "press" && (args.size() == 2 || (args.size() == 3 && args[2] == "long"))) {
+        return press(r, args[1], args.size() == 3);
+    }
+    if (cmd == "measure" && args.size() >= 2) {
+        // Shapes may contain spaces
+        std::string shape = args[1];
+        for (size_t i = 2; i < args.size(); i++) {
+            shape += " " + args[i];
+        }
+        return measure(r, shape);
+    }
+    if (cmd == "status" && args.size() == 1) {
+        return status(r);
+    }
+    std::cerr << "unknown command \"" << cmd << "\"\n";
+    return false;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " /dev/ttyACM0 ping [count] [depth] | press yellow|red [long]"
+                  << " | measure SHAPE | status | -\n";
+        return 2;
+    }
+
+    try {
+        remote r(argv[1]);
+        bool ok = true;
+
+        if (std::string(argv[2]) == "-") {
+            std::string line;
+            while (std::getline(std::cin, line)) {
+                std::istringstream words(line);
+                std::vector<std::string> args;
+                for (std::string w; words >> w;) {
+                    args.push_back(w);
+                }
+                if (!args.empty() && args[0][0] != '#') {
+                    ok = run(r, args) && ok;
+                }
+            }
+        } else {
+            ok = run(r, std::vector<std::string>(argv + 2, argv + argc));
+        }
+        if (r.bad_frames() > 0) {
+            std::cerr << r.bad_frames() << " bad frames\n";
+        }
+        return (ok && r.bad_frames() == 0) ? 0 : 1;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
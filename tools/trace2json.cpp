@@ -0,0 +1,168 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file trace2json.cpp
+ * @brief Converts a capture of the binary trace UART to Chrome trace JSON.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Usage: trace2json capture.bin [trace.json]
+ *
+ * Capture the trace UART raw, for example with
+ *   stty -F /dev/ttyUSB0 921600 raw && cat /dev/ttyUSB0 > capture.bin
+ * and open the JSON in chrome://tracing or ui.perfetto.dev. Damaged blocks
+ * are skipped; the converter resynchronizes on the next valid block.
+ */
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#include "trace.h"
+
+static_assert(sizeof(trace_record) == 8, "trace_record must match the wire format");
+
+#define TRACE_NAME(id, name) name,
+static const char *const names[TRACE_ID_COUNT] = {
+    TRACE_IDS(TRACE_NAME)
+};
+#undef TRACE_NAME
+
+/**
+ * @brief Check the Fletcher-16 checksum that follows a block.
+ */
+static bool block_valid(const uint8_t *block, size_t length) {
+    uint16_t sum1 = 0;
+    uint16_t sum2 = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        sum1 = (sum1 + block[i]) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+    return block[length] == sum1 && block[length + 1] == sum2;
+}
+
+/**
+ * @brief Write one record as a trace event.
+ *
+ * @param out     The JSON output.
+ * @param r       The record.
+ * @param time_us Unwrapped time of the record.
+ */
+static void write_event(std::ostream &out, const trace_record &r, uint64_t time_us) {
+    const char *name = r.id < TRACE_ID_COUNT ? names[r.id] : "unknown";
+    int core = (r.kind & TRACE_CORE1) ? 1 : 0;
+
+    out << ",\n{\"name\":\"" << name << "\",\"pid\":1,\"tid\":" << core << ",\"ts\":" << time_us;
+    switch (r.kind & TRACE_KIND_MASK) {
+    case TRACE_BEGIN:
+        out << ",\"ph\":\"B\",\"args\":{\"arg\":" << r.arg << "}}";
+        break;
+    case TRACE_END:
+        out << ",\"ph\":\"E\"}";
+        break;
+    case TRACE_INSTANT:
+        out << ",\"ph\":\"i\",\"s\":\"t\",\"args\":{\"arg\":" << r.arg << "}}";
+        break;
+    default:
+        out << ",\"ph\":\"C\",\"args\":{\"value\":" << (int16_t)r.arg << "}}";
+        break;
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "usage: " << argv[0] << " capture.bin [trace.json]\n";
+        return 2;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in) {
+        std::cerr << "cannot open " << argv[1] << "\n";
+        return 1;
+    }
+    std::vector<uint8_t> capture((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    std::ofstream file;
+    if (argc == 3) {
+        file.open(argv[2]);
+        if (!file) {
+            std::cerr << "cannot open " << argv[2] << "\n";
+            return 1;
+        }
+    }
+    std::ostream &out = (argc == 3) ? file : std::cout;
+
+    out << "{\"traceEvents\":[\n"
+        << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"core0\"}},\n"
+        << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"core1\"}}";
+
+    size_t pos = 0;
+    size_t blocks = 0;
+    size_t records = 0;
+    size_t skipped = 0;     // Bytes outside valid blocks
+    size_t gaps = 0;        // Breaks in the block sequence
+    int last_seq = -1;
+    bool have_time = false;
+    uint32_t last_time = 0;
+    uint64_t time_us = 0;
+
+    while (pos + TRACE_BLOCK_HEADER + 2 <= capture.size()) {
+        const uint8_t *block = &capture[pos];
+        uint8_t count = block[2];
+        size_t length = TRACE_BLOCK_HEADER + count * sizeof(trace_record);
+
+        if (block[0] != TRACE_MAGIC_0 || block[1] != TRACE_MAGIC_1 || count == 0 ||
+            count > TRACE_BLOCK_RECORDS) {
+            pos++;
+            skipped++;
+            continue;
+        }
+        // A header cut off at the end of the capture, or one matched by chance
+        if (pos + length + 2 > capture.size() || !block_valid(block, length)) {
+            pos++;
+            skipped++;
+            continue;
+        }
+
+        if (last_seq >= 0 && block[3] != (uint8_t)(last_seq + 1)) {
+            gaps++;
+        }
+        last_seq = block[3];
+
+        for (uint8_t i = 0; i < count; i++) {
+            trace_record r;
+            std::memcpy(&r, block + TRACE_BLOCK_HEADER + i * sizeof(trace_record), sizeof(r));
+
+            // The records carry 32 bits of microseconds, which wrap every 71
+            // minutes; the two cores' records interleave, so allow small
+            // steps backwards
+            if (!have_time) {
+                time_us = r.time_us;
+                have_time = true;
+            } else {
+                time_us += (int32_t)(r.time_us - last_time);
+            }
+            last_time = r.time_us;
+            write_event(out, r, time_us);
+            records++;
+        }
+        blocks++;
+        pos += length + 2;
+    }
+
+    out << "\n]}\n";
+
+    std::cerr << blocks << " blocks, " << records << " records, " << skipped
+              << " bytes skipped, " << gaps << " sequence gaps\n";
+    return 0;
+}
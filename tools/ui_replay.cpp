@@ -0,0 +1,285 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file ui_replay.cpp
+ * @brief Replays scripted events through the event queue and UI state machine.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Usage: ui_replay SCRIPT [EXPECTED]
+ *
+ * Runs event.c and ui_fsm.c as the firmware does, on a simulated clock.
+ * Each script line is a batch of events separated by ';', all posted before
+ * the UI takes any, so coalescing and a full queue behave as when the UI
+ * falls behind; the queue is then drained through ui_fsm_step. Events:
+ *   press|release|double yellow|red     a button edge
+ *   long yellow|red|both                a long press
+ *   tick [count]                        fire the tick timer, 10 ms apart
+ *   frame SEQ                           core1 published sensor frames
+ *   done | cancel                       the running measurement finished
+ *   remote ENTRY                        the host started a measurement
+ *   wait MS                             advance the clock
+ *   menu SHAPES IRR_ENTRY IRR_COUNT HISTORY_ENTRY
+ *                                       restart with another menu layout
+ * '#' starts a comment. Every event taken is one trace line: its time, the
+ * event, and the state, action and menu selections after it; the queue
+ * statistics end the trace.
+ *
+ * Without EXPECTED the trace goes to stdout. With it, the trace is compared
+ * line by line, the first difference is printed and the exit status is 1
+ * if there is one; 2 on a bad script.
+ */
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "button.h"
+#include "event.h"
+#include "ui_fsm.h"
+#include "pico/stdlib.h"
+
+// The menu of menu.c: 8 entries with "Irregular menu" at 4 and "History"
+// at 7, and 6 irregular shapes
+#define DEFAULT_SHAPES (8)
+#define DEFAULT_IRR_ENTRY (4)
+#define DEFAULT_IRR_COUNT (6)
+#define DEFAULT_HISTORY_ENTRY (7)
+
+static const char *const state_names[] = { "menu", "irr_menu", "measure", "result", "stats", "history" };
+static const char *const action_names[] = {
+    "none", "next", "show_irr_menu", "next_irr", "measure", "measure_irr", "measure_step",
+    "show_result", "show_menu", "show_stats", "reset_stats", "show_history", "history_older",
+};
+static const char *const event_names[] = {
+    "none", "tick", "press", "release", "long", "double", "done", "cancel", "frame", "remote",
+};
+
+// Simulated clock and the timer event_init() starts
+static uint64_t now_us;
+static repeating_timer_t *tick_timer;
+
+extern "C" {
+
+uint32_t time_us_32(void) {
+    return (uint32_t)now_us;
+}
+
+uint64_t time_us_64(void) {
+    return now_us;
+}
+
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void *user_data,
+                            repeating_timer_t *out) {
+    out->delay_ms = delay_ms;
+    out->callback = callback;
+    out->user_data = user_data;
+    tick_timer = out;
+    return true;
+}
+
+void __sev(void) {
+}
+
+void __wfe(void) {
+}
+
+}
+
+struct bad_script : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+static uint32_t parse_button(std::istream &in, bool both) {
+    std::string name;
+    in >> name;
+    if (name == "yellow") {
+        return GPIO10;
+    }
+    if (name == "red") {
+        return GPIO11;
+    }
+    if (both && name == "both") {
+        return BUTTON_BOTH;
+    }
+    throw bad_script("bad button '" + name + "'");
+}
+
+static uint32_t parse_number(std::istream &in, bool optional, uint32_t fallback) {
+    std::string word;
+    if (!(in >> word)) {
+        if (optional) {
+            return fallback;
+        }
+        throw bad_script("missing number");
+    }
+    char *end;
+    unsigned long value = std::strtoul(word.c_str(), &end, 0);
+    if (*end != '\0') {
+        throw bad_script("bad number '" + word + "'");
+    }
+    return (uint32_t)value;
+}
+
+static std::string describe(const event &e) {
+    std::string name = e.type < sizeof(event_names) / sizeof(event_names[0]) ? event_names[e.type] : "?";
+    switch (e.type) {
+    case EVENT_BUTTON_PRESS:
+    case EVENT_BUTTON_RELEASE:
+    case EVENT_BUTTON_LONG:
+    case EVENT_BUTTON_DOUBLE:
+        return name + " " + (e.data == GPIO10 ? "yellow" : e.data == GPIO11 ? "red" : e.data == BUTTON_BOTH ? "both" : "?");
+    case EVENT_MEASURE_DONE:
+    case EVENT_MEASURE_CANCEL:
+        return name;
+    default:
+        return name + " " + std::to_string(e.data);
+    }
+}
+
+/**
+ * @brief Post one event of a script line, or apply a "wait" or "menu".
+ */
+static void post(const std::string &command, std::istream &in, ui_fsm *fsm) {
+    if (command == "press") {
+        event_post(EVENT_BUTTON_PRESS, parse_button(in, false));
+    } else if (command == "release") {
+        event_post(EVENT_BUTTON_RELEASE, parse_button(in, false));
+    } else if (command == "double") {
+        event_post(EVENT_BUTTON_DOUBLE, parse_button(in, false));
+    } else if (command == "long") {
+        event_post(EVENT_BUTTON_LONG, parse_button(in, true));
+    } else if (command == "tick") {
+        for (uint32_t count = parse_number(in, true, 1); count > 0; count--) {
+            now_us += (uint64_t)EVENT_TICK_MS * 1000;
+            tick_timer->callback(tick_timer);
+        }
+    } else if (command == "frame") {
+        event_post(EVENT_SENSOR_FRAME, parse_number(in, false, 0));
+    } else if (command == "done") {
+        event_post(EVENT_MEASURE_DONE, 0);
+    } else if (command == "cancel") {
+        event_post(EVENT_MEASURE_CANCEL, 0);
+    } else if (command == "remote") {
+        event_post(EVENT_REMOTE_MEASURE, parse_number(in, false, 0));
+    } else if (command == "wait") {
+        now_us += (uint64_t)parse_number(in, false, 0) * 1000;
+    } else if (command == "menu") {
+        uint8_t shapes = (uint8_t)parse_number(in, false, 0);
+        uint8_t irr_entry = (uint8_t)parse_number(in, false, 0);
+        uint8_t irr_count = (uint8_t)parse_number(in, false, 0);
+        uint8_t history_entry = (uint8_t)parse_number(in, false, 0);
+        if (shapes == 0 || irr_count == 0) {
+            throw bad_script("empty menu");
+        }
+        ui_fsm_init(fsm, shapes, irr_entry, irr_count, history_entry);
+    } else {
+        throw bad_script("unknown event '" + command + "'");
+    }
+    std::string extra;
+    if (in >> extra) {
+        throw bad_script("unexpected '" + extra + "'");
+    }
+}
+
+static std::vector<std::string> replay(std::istream &script) {
+    std::vector<std::string> trace;
+    ui_fsm fsm;
+
+    now_us = 0;
+    event_init();
+    ui_fsm_init(&fsm, DEFAULT_SHAPES, DEFAULT_IRR_ENTRY, DEFAULT_IRR_COUNT, DEFAULT_HISTORY_ENTRY);
+
+    std::string line;
+    for (uint32_t number = 1; std::getline(script, line); number++) {
+        line = line.substr(0, line.find('#'));
+        try {
+            std::istringstream batch(line);
+            std::string item;
+            while (std::getline(batch, item, ';')) {
+                std::istringstream in(item);
+                std::string command;
+                if (in >> command) {
+                    post(command, in, &fsm);
+                }
+            }
+        } catch (const bad_script &error) {
+            throw bad_script("line " + std::to_string(number) + ": " + error.what());
+        }
+
+        event e;
+        while (event_poll(&e)) {
+            ui_action action = ui_fsm_step(&fsm, &e);
+            std::ostringstream out;
+            out << e.time_us << " " << describe(e) << " -> " << state_names[fsm.state] << " "
+                << action_names[action] << " " << (int)fsm.selected << "/" << (int)fsm.irr_selected;
+            trace.push_back(out.str());
+        }
+    }
+
+    event_stats stats;
+    event_get_stats(&stats);
+    trace.push_back("posted " + std::to_string(stats.posted) + " dropped " + std::to_string(stats.dropped) +
+                    " max_depth " + std::to_string(stats.max_depth));
+    return trace;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "usage: ui_replay SCRIPT [EXPECTED]\n";
+        return 2;
+    }
+    std::ifstream script(argv[1]);
+    if (!script) {
+        std::cerr << "ui_replay: cannot open " << argv[1] << "\n";
+        return 2;
+    }
+
+    std::vector<std::string> trace;
+    try {
+        trace = replay(script);
+    } catch (const bad_script &error) {
+        std::cerr << argv[1] << ": " << error.what() << "\n";
+        return 2;
+    }
+
+    if (argc == 2) {
+        for (const std::string &line : trace) {
+            std::cout << line << "\n";
+        }
+        return 0;
+    }
+
+    std::ifstream expected_file(argv[2]);
+    if (!expected_file) {
+        std::cerr << "ui_replay: cannot open " << argv[2] << "\n";
+        return 2;
+    }
+    std::vector<std::string> expected;
+    for (std::string line; std::getline(expected_file, line);) {
+        expected.push_back(line);
+    }
+    for (size_t i = 0; i < trace.size() || i < expected.size(); i++) {
+        const std::string none = "(end of trace)";
+        const std::string &want = i < expected.size() ? expected[i] : none;
+        const std::string &got = i < trace.size() ? trace[i] : none;
+        if (want != got) {
+            std::cout << argv[1] << ": trace line " << i + 1 << " differs\n  expected: " << want
+                      << "\n  got:      " << got << "\n";
+            return 1;
+        }
+    }
+    std::cout << argv[1] << ": " << trace.size() << " trace lines match\n";
+    return 0;
+}
@@ -0,0 +1,237 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file walls_bench.cpp
+ * @brief Runs the wall extraction over synthetic rooms and checks the result.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Usage: walls_bench [rooms] [limit_us]
+ *
+ * Builds rectangular and L-shaped rooms of random size, placement and
+ * rotation (200 of each by default, from a fixed seed), ray-casts a sweep
+ * of one distance per degree with +-2 cm of noise through the sweep code,
+ * and runs walls_extract on it. A room passes when every true corner has
+ * an extracted corner within CORNER_TOLERANCE_CM, there are no extra
+ * corners, the area is within AREA_TOLERANCE and, for a rectangle, it is
+ * classified as one with width and length within SIDE_TOLERANCE_CM. A wall
+ * hit by fewer than WALLS_MIN_INLIERS rays cannot be found, so rooms with
+ * such a wall are counted apart and only checked for a consistent result:
+ * as many corners as walls.
+ *
+ * Prints the pass rate, worst area error and run time of each kind of
+ * room, and exits 1 if fewer than MIN_PASS_RATE of the rooms checked of a
+ * kind pass, any result is inconsistent or any one extraction takes longer
+ * than limit_us (5000 by default).
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "sweep.h"
+#include "walls.h"
+
+#define CORNER_TOLERANCE_CM (10.0)
+#define SIDE_TOLERANCE_CM (4.0)
+#define AREA_TOLERANCE (0.02)
+#define NOISE_CM (2)
+#define MIN_PASS_RATE (0.95)
+#define TIMED_RUNS (3)
+
+// Closest a room's walls come to the device
+#define WALL_MARGIN_CM (50.0)
+
+struct point {
+    double x, y;
+};
+
+/**
+ * @brief Results of one kind of room.
+ */
+struct tally {
+    const char *name;
+    uint32_t rooms = 0;
+    uint32_t passed = 0;
+    uint32_t unseen = 0;        // Rooms with a wall too short in view to be found
+    uint32_t inconsistent = 0;  // Extractions with corners not matching the walls
+    double worst_area = 0;      // Largest relative area error of an extracted room
+    double total_us = 0;        // Over every room, checked or not
+    double worst_us = 0;
+
+    explicit tally(const char *n) : name(n) {}
+};
+
+// Distance along the ray from the origin at angle a to the polygon, and
+// the index of the edge it hits
+static double ray_cast(const std::vector<point> &room, double a, size_t *edge) {
+    double ux = std::cos(a), uy = std::sin(a);
+    double best = INFINITY;
+    for (size_t i = 0; i < room.size(); i++) {
+        point p = room[i], q = room[(i + 1) % room.size()];
+        double ex = q.x - p.x, ey = q.y - p.y;
+        double denom = ux * ey - uy * ex;
+        if (std::fabs(denom) < 1e-12) {
+            continue;
+        }
+        double t = (p.x * ey - p.y * ex) / denom;      // Along the ray
+        double s = (p.x * uy - p.y * ux) / denom;      // Along the edge
+        if (t > 0 && s >= 0 && s <= 1 && t < best) {
+            best = t;
+            *edge = i;
+        }
+    }
+    return best;
+}
+
+static double polygon_area(const std::vector<point> &room) {
+    double twice = 0;
+    for (size_t i = 0; i < room.size(); i++) {
+        point p = room[i], q = room[(i + 1) % room.size()];
+        twice += p.x * q.y - q.x * p.y;
+    }
+    return std::fabs(twice) / 2;
+}
+
+// The room as seen from the device at (dx, dy), turned by angle
+static std::vector<point> place(const std::vector<point> &room, double dx, double dy, double angle) {
+    std::vector<point> placed;
+    double c = std::cos(angle), s = std::sin(angle);
+    for (point p : room) {
+        double x = p.x - dx, y = p.y - dy;
+        placed.push_back({ x * c - y * s, x * s + y * c });
+    }
+    return placed;
+}
+
+/**
+ * @brief One turn at 1 degree per 10 ms gyro sample, the way the sampler
+ * feeds the sweep code.
+ *
+ * @return The fewest rays that hit any one wall.
+ */
+static uint32_t sweep_room(const std::vector<point> &room, std::mt19937_64 &rng, sweep_scan *scan) {
+    std::uniform_int_distribution<int> noise(-NOISE_CM, NOISE_CM);
+    std::vector<uint32_t> hits(room.size());
+    sweep_init(scan, 0, 0);
+    for (uint32_t i = 1; i <= 360; i++) {
+        sweep_update_yaw(scan, 10000, i * 10000ull);
+        size_t edge = 0;
+        double d = ray_cast(room, sweep_yaw(scan) * M_PI / 18000.0, &edge);
+        long cm = std::lround(d) + noise(rng);
+        sweep_add_sample(scan, (uint16_t)std::clamp<long>(cm, 0, UINT16_MAX));
+        hits[edge]++;
+    }
+    return *std::min_element(hits.begin(), hits.end());
+}
+
+static bool check_room(const std::vector<point> &room, bool rectangle, double width, double length,
+                       std::mt19937_64 &rng, tally &t) {
+    static sweep_scan scan;
+    static wall_room walls;
+    uint32_t fewest_hits = sweep_room(room, rng, &scan);
+
+    // The fastest of a few runs, so a preempted run does not count
+    bool found = false;
+    double us = INFINITY;
+    for (int run = 0; run < TIMED_RUNS; run++) {
+        auto start = std::chrono::steady_clock::now();
+        found = walls_extract(&scan, &walls);
+        us = std::min(us, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    t.total_us += us;
+    t.worst_us = std::max(t.worst_us, us);
+
+    // Whatever was found, corner i must be where walls i and i + 1 meet
+    if (found && walls.wall_count != walls.corner_count) {
+        t.inconsistent++;
+    }
+    if (fewest_hits < WALLS_MIN_INLIERS) {
+        t.unseen++;
+        return false;
+    }
+    t.rooms++;
+    if (!found || walls.corner_count != room.size()) {
+        return false;
+    }
+
+    for (point p : room) {
+        double nearest = INFINITY;
+        for (uint8_t i = 0; i < walls.corner_count; i++) {
+            nearest = std::min(nearest, std::hypot(walls.corner_x[i] - p.x, walls.corner_y[i] - p.y));
+        }
+        if (nearest > CORNER_TOLERANCE_CM) {
+            return false;
+        }
+    }
+
+    double expected = polygon_area(room);
+    double error = std::fabs(walls.area / (double)FX_SCALE - expected) / expected;
+    t.worst_area = std::max(t.worst_area, error);
+    if (error > AREA_TOLERANCE) {
+        return false;
+    }
+    if (rectangle) {
+        double w = walls.width / (double)FX_SCALE, l = walls.length / (double)FX_SCALE;
+        bool sides = (std::fabs(w - width) <= SIDE_TOLERANCE_CM && std::fabs(l - length) <= SIDE_TOLERANCE_CM) ||
+                     (std::fabs(w - length) <= SIDE_TOLERANCE_CM && std::fabs(l - width) <= SIDE_TOLERANCE_CM);
+        return walls.is_rectangle && sides;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    uint32_t rooms = argc > 1 ? (uint32_t)std::strtoul(argv[1], nullptr, 0) : 200;
+    double limit_us = argc > 2 ? std::strtod(argv[2], nullptr) : 5000;
+
+    std::mt19937_64 rng(0x57a11);
+    std::uniform_real_distribution<double> unit(0, 1);
+    std::uniform_real_distribution<double> turn(0, 2 * M_PI);
+    tally rects("rectangle"), ells("L-shaped");
+
+    for (uint32_t r = 0; r < rooms; r++) {
+        double w = 200 + 600 * unit(rng), l = 200 + 600 * unit(rng);
+        std::vector<point> room = { { 0, 0 }, { w, 0 }, { w, l }, { 0, l } };
+        double dx = WALL_MARGIN_CM + (w - 2 * WALL_MARGIN_CM) * unit(rng);
+        double dy = WALL_MARGIN_CM + (l - 2 * WALL_MARGIN_CM) * unit(rng);
+        rects.passed += check_room(place(room, dx, dy, turn(rng)), true, w, l, rng, rects);
+    }
+
+    for (uint32_t r = 0; r < rooms; r++) {
+        // An outer rectangle with one corner cut away; from anywhere in the
+        // elbow, where the two arms overlap, every wall is in view
+        double w = 350 + 400 * unit(rng), l = 350 + 400 * unit(rng);
+        double cw = w * (0.35 + 0.2 * unit(rng)), cl = l * (0.35 + 0.2 * unit(rng));
+        std::vector<point> room = { { 0, 0 }, { w, 0 }, { w, l - cl }, { w - cw, l - cl }, { w - cw, l }, { 0, l } };
+        double dx = WALL_MARGIN_CM + (w - cw - 2 * WALL_MARGIN_CM) * unit(rng);
+        double dy = WALL_MARGIN_CM + (l - cl - 2 * WALL_MARGIN_CM) * unit(rng);
+        ells.passed += check_room(place(room, dx, dy, turn(rng)), false, 0, 0, rng, ells);
+    }
+
+    bool ok = true;
+    for (const tally *t : { &rects, &ells }) {
+        double rate = t->rooms ? (double)t->passed / t->rooms : 0;
+        std::cout << std::left << std::setw(10) << t->name << std::right << std::fixed << std::setprecision(1)
+                  << " " << t->passed << "/" << t->rooms << " passed (" << rate * 100 << "%), "
+                  << t->unseen << " with a wall out of view, worst area error "
+                  << std::setprecision(2) << t->worst_area * 100 << "%, " << std::setprecision(0)
+                  << t->total_us / (t->rooms + t->unseen) << " us mean, " << t->worst_us << " us worst\n";
+        if (t->inconsistent) {
+            std::cout << "  " << t->inconsistent << " with fewer corners than walls\n";
+        }
+        ok = ok && rate >= MIN_PASS_RATE && t->worst_us <= limit_us && t->inconsistent == 0;
+    }
+    return ok ? 0 : 1;
+}
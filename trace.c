@@ -0,0 +1,182 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file trace.c
+ * @brief Binary event trace streamed over a spare UART by DMA.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * The rings are single producer (their core, with interrupts masked for the
+ * few stores of one record) and single consumer (the drain task on core0).
+ */
+#include "trace.h"
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/uart.h"
+#include "hardware/dma.h"
+#include "hardware/sync.h"
+#include "task.h"
+
+// UART1 TX on GPIO8, away from the stdio console on UART0
+#define TRACE_UART (uart1)
+#define TRACE_TX_PIN (8)
+#define TRACE_BAUD (921600)
+
+// Records buffered per core; a power of two
+#define TRACE_RING_SIZE (256)
+
+// Longest acceptable drain step: packing one block
+#define TRACE_TASK_BUDGET_US (1000)
+
+/**
+ * @brief Records of one core waiting to be sent.
+ */
+typedef struct {
+    trace_record records[TRACE_RING_SIZE];
+    volatile uint32_t head;     // Records written, by the owning core
+    volatile uint32_t tail;     // Records sent, by the drain task
+    uint32_t dropped;           // Records lost since the last TRACE_DROPPED
+} trace_ring;
+
+static trace_ring rings[2];
+
+static uint8_t block[TRACE_BLOCK_HEADER + TRACE_BLOCK_RECORDS * sizeof(trace_record) + 2];
+static uint8_t block_seq;
+static int dma_channel = -1;
+
+static task_status trace_step(task *t);
+static task trace_task = { .name = "trace", .fn = trace_step, .budget_us = TRACE_TASK_BUDGET_US,
+                           .trace_id = TRACE_TASK_TRACE };
+
+/**
+ * @brief Append a record to a ring; the caller has interrupts masked.
+ */
+static bool ring_put(trace_ring *ring, uint8_t kind, uint8_t id, uint16_t arg) {
+    uint32_t head = ring->head;
+    trace_record *r;
+
+    if (head - ring->tail >= TRACE_RING_SIZE) {
+        return false;
+    }
+    r = &ring->records[head % TRACE_RING_SIZE];
+    r->time_us = time_us_32();
+    r->kind = kind;
+    r->id = id;
+    r->arg = arg;
+    __dmb();
+    ring->head = head + 1;
+    return true;
+}
+
+/**
+ * @brief Append a record to the calling core's ring.
+ *
+ * @param kind TRACE_BEGIN, TRACE_END, TRACE_INSTANT or TRACE_COUNTER.
+ * @param id   A trace_id.
+ * @param arg  Argument or counter value.
+ */
+void trace_record_event(uint8_t kind, uint8_t id, uint16_t arg) {
+    uint core = get_core_num();
+    trace_ring *ring = &rings[core];
+    uint8_t core_bit = core ? TRACE_CORE1 : 0;
+    uint32_t irq = save_and_disable_interrupts();
+
+    if (ring->dropped > 0 &&
+        ring_put(ring, TRACE_INSTANT | core_bit, TRACE_DROPPED,
+                 ring->dropped > 0xFFFF ? 0xFFFF : ring->dropped)) {
+        ring->dropped = 0;
+    }
+    if (!ring_put(ring, kind | core_bit, id, arg)) {
+        ring->dropped++;
+    }
+    restore_interrupts(irq);
+}
+
+/**
+ * @brief Move records from a ring into the block being packed.
+ *
+ * @return The new record count of the block.
+ */
+static uint8_t drain_ring(trace_ring *ring, uint8_t count) {
+    uint32_t tail = ring->tail;
+    uint32_t head = ring->head;
+
+    __dmb();
+    while (tail != head && count < TRACE_BLOCK_RECORDS) {
+        memcpy(&block[TRACE_BLOCK_HEADER + count * sizeof(trace_record)],
+               &ring->records[tail % TRACE_RING_SIZE], sizeof(trace_record));
+        tail++;
+        count++;
+    }
+    __dmb();
+    ring->tail = tail;
+    return count;
+}
+
+/**
+ * @brief Drain task: send one block whenever the DMA channel is free.
+ *
+ * The event tick wakes the core often enough that one block per step keeps
+ * up with both rings.
+ */
+static task_status trace_step(task *t) {
+    uint8_t count;
+    uint16_t length;
+    uint16_t sum1 = 0;
+    uint16_t sum2 = 0;
+
+    if (dma_channel_is_busy(dma_channel)) {
+        return TASK_WAITING;
+    }
+
+    count = drain_ring(&rings[0], 0);
+    count = drain_ring(&rings[1], count);
+    if (count == 0) {
+        return TASK_WAITING;
+    }
+
+    block[0] = TRACE_MAGIC_0;
+    block[1] = TRACE_MAGIC_1;
+    block[2] = count;
+    block[3] = block_seq++;
+    length = TRACE_BLOCK_HEADER + count * sizeof(trace_record);
+
+    // Fletcher-16 lets the host resynchronize on a damaged stream
+    for (uint16_t i = 0; i < length; i++) {
+        sum1 = (sum1 + block[i]) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+    block[length] = sum1;
+    block[length + 1] = sum2;
+
+    dma_channel_transfer_from_buffer_now(dma_channel, block, length + 2);
+    return TASK_WAITING;
+}
+
+/**
+ * @brief Set up the trace UART and DMA channel and register the drain task.
+ */
+void trace_init(void) {
+    dma_channel_config config;
+
+    uart_init(TRACE_UART, TRACE_BAUD);
+    gpio_set_function(TRACE_TX_PIN, GPIO_FUNC_UART);
+
+    // Bytes from the block buffer to the UART data register, paced by its TX FIFO
+    dma_channel = dma_claim_unused_channel(true);
+    config = dma_channel_get_default_config(dma_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, uart_get_dreq(TRACE_UART, true));
+    dma_channel_configure(dma_channel, &config, &uart_get_hw(TRACE_UART)->dr, block, 0, false);
+
+    task_add(&trace_task);
+}
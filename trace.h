@@ -0,0 +1,113 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file trace.h
+ * @brief Binary event trace streamed over a spare UART by DMA.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * Each core appends 8-byte records to its own ring. A task on core0 packs
+ * them into checksummed blocks and hands each block to DMA, so recording an
+ * event costs a few stores instead of a formatted printf. The wire format
+ * below is shared with tools/trace2json.cpp, which turns a capture into
+ * Chrome trace JSON; keep this header free of SDK includes.
+ *
+ * The trace points compile to nothing unless SSM_TRACE is set to 1.
+ */
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+#ifndef SSM_TRACE
+#define SSM_TRACE 0
+#endif
+
+// Block framing: magic, record count, sequence number, records, Fletcher-16
+#define TRACE_MAGIC_0 ('T')
+#define TRACE_MAGIC_1 ('R')
+#define TRACE_BLOCK_HEADER (4)
+#define TRACE_BLOCK_RECORDS (64)
+
+// Record kinds, in the low bits of trace_record.kind
+#define TRACE_BEGIN (0)         // Start of a span
+#define TRACE_END (1)           // End of the innermost span with the same id
+#define TRACE_INSTANT (2)       // Point event; arg is event specific
+#define TRACE_COUNTER (3)       // Sampled value; arg is the value, signed
+#define TRACE_KIND_MASK (0x03)
+#define TRACE_CORE1 (0x80)      // Set when the record came from core1
+
+/**
+ * @brief Names of the traced spans, events and counters.
+ *
+ * X(id, name) for each; the name is what the trace viewer shows.
+ */
+#define TRACE_IDS(X)                    \
+    X(TRACE_TASK, "task")               \
+    X(TRACE_TASK_UI, "ui")              \
+    X(TRACE_TASK_STATS, "stats")        \
+    X(TRACE_TASK_TRACE, "trace")        \
+    X(TRACE_TASK_LOG, "log")            \
+    X(TRACE_TASK_USB, "usb")            \
+    X(TRACE_I2C, "i2c")                 \
+    X(TRACE_FLUSH, "oled_flush")        \
+    X(TRACE_EVENT, "event")             \
+    X(TRACE_DROPPED, "dropped")         \
+    X(TRACE_DISTANCE, "distance_cm")    \
+    X(TRACE_TILT_X, "tilt_x")           \
+    X(TRACE_TILT_Y, "tilt_y")
+
+#define TRACE_ENUM(id, name) id,
+typedef enum {
+    TRACE_IDS(TRACE_ENUM)
+    TRACE_ID_COUNT,
+} trace_id;
+#undef TRACE_ENUM
+
+/**
+ * @brief One record on the wire, little-endian.
+ */
+typedef struct {
+    uint32_t time_us;   // Low 32 bits of time_us_64()
+    uint8_t kind;       // TRACE_BEGIN..TRACE_COUNTER, plus TRACE_CORE1
+    uint8_t id;         // A trace_id
+    uint16_t arg;       // Span or event argument, or the counter value
+} trace_record;
+
+#if SSM_TRACE
+#define TRACE_SPAN_BEGIN(id, arg) trace_record_event(TRACE_BEGIN, (id), (arg))
+#define TRACE_SPAN_END(id) trace_record_event(TRACE_END, (id), 0)
+#define TRACE_INSTANT_EVENT(id, arg) trace_record_event(TRACE_INSTANT, (id), (arg))
+#define TRACE_COUNTER_VALUE(id, value) trace_record_event(TRACE_COUNTER, (id), (uint16_t)(value))
+#else
+#define TRACE_SPAN_BEGIN(id, arg) do {} while (0)
+#define TRACE_SPAN_END(id) do {} while (0)
+#define TRACE_INSTANT_EVENT(id, arg) do {} while (0)
+#define TRACE_COUNTER_VALUE(id, value) do {} while (0)
+#endif
+
+/**
+ * @brief Set up the trace UART and DMA channel and register the drain task.
+ */
+void trace_init(void);
+
+/**
+ * @brief Append a record to the calling core's ring.
+ *
+ * Safe from interrupt handlers. A full ring drops the record; the drops are
+ * reported with a TRACE_DROPPED event once there is room again.
+ *
+ * @param kind TRACE_BEGIN, TRACE_END, TRACE_INSTANT or TRACE_COUNTER.
+ * @param id   A trace_id.
+ * @param arg  Argument or counter value.
+ */
+void trace_record_event(uint8_t kind, uint8_t id, uint16_t arg);
+
+#endif // TRACE_H
@@ -0,0 +1,38 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file tusb_config.h
+ * @brief TinyUSB configuration: a device with one CDC interface.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * The MCU and OS options come from the SDK's tinyusb_device library.
+ */
+#ifndef TUSB_CONFIG_H
+#define TUSB_CONFIG_H
+
+#define CFG_TUSB_RHPORT0_MODE (OPT_MODE_DEVICE)
+
+#define CFG_TUD_ENDPOINT0_SIZE (64)
+
+// Classes in use
+#define CFG_TUD_CDC (1)
+#define CFG_TUD_MSC (0)
+#define CFG_TUD_HID (0)
+#define CFG_TUD_MIDI (0)
+#define CFG_TUD_VENDOR (0)
+
+// Requests are a few bytes; the transmit FIFO holds several full frames so
+// the bulk endpoint stays busy between task steps
+#define CFG_TUD_CDC_RX_BUFSIZE (256)
+#define CFG_TUD_CDC_TX_BUFSIZE (2048)
+#define CFG_TUD_CDC_EP_BUFSIZE (64)
+
+#endif // TUSB_CONFIG_H
@@ -0,0 +1,173 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file ui_fsm.c
+ * @brief State machine for the menu and measurement flow.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#include "ui_fsm.h"
+#include "button.h"
+
+/**
+ * @brief Start at the main menu with the first entry selected.
+ *
+ * @param fsm           The state machine.
+ * @param shape_count   Number of main menu entries.
+ * @param irr_entry     Main menu entry that opens the irregular menu.
+ * @param irr_count     Number of irregular menu entries.
+ * @param history_entry Main menu entry that opens the history.
+ */
+void ui_fsm_init(ui_fsm *fsm, uint8_t shape_count, uint8_t irr_entry, uint8_t irr_count,
+                 uint8_t history_entry) {
+    fsm->state = UI_STATE_MENU;
+    fsm->selected = 0;
+    fsm->shape_count = shape_count;
+    fsm->irr_entry = irr_entry;
+    fsm->irr_selected = 0;
+    fsm->irr_count = irr_count;
+    fsm->history_entry = history_entry;
+    fsm->select_armed = false;
+}
+
+/**
+ * @brief Start the measurement of a menu entry for the host.
+ *
+ * @param fsm   The state machine, not measuring.
+ * @param entry Main menu entry, or shape_count plus an irregular menu entry.
+ * @return The measure action, or none for an entry that is not a measurement.
+ */
+static ui_action remote_measure(ui_fsm *fsm, uint32_t entry) {
+    bool irregular = entry >= fsm->shape_count;
+
+    if (irregular ? entry - fsm->shape_count >= fsm->irr_count
+                  : entry == fsm->irr_entry || entry == fsm->history_entry) {
+        return UI_ACTION_NONE;
+    }
+    if (irregular) {
+        fsm->selected = fsm->irr_entry;
+        fsm->irr_selected = (uint8_t)(entry - fsm->shape_count);
+    } else {
+        fsm->selected = (uint8_t)entry;
+    }
+    fsm->select_armed = false;
+    fsm->state = UI_STATE_MEASURE;
+    return irregular ? UI_ACTION_MEASURE_IRR : UI_ACTION_MEASURE;
+}
+
+/**
+ * @brief Apply one event.
+ *
+ * Yellow (GPIO10) moves the cursor and Red (GPIO11) selects or leaves a
+ * screen. In the main menu Red selects on release, so holding both buttons
+ * to open the hidden stats page does not start a measurement on the way.
+ * While a measurement runs every event is handed to it until it reports
+ * done or cancelled. A measurement the host starts is taken from any other
+ * screen, as if its menu entry had been selected.
+ *
+ * @param fsm The state machine.
+ * @param e   The event.
+ * @return The action for the new state.
+ */
+ui_action ui_fsm_step(ui_fsm *fsm, const event *e) {
+    bool yellow = (e->type == EVENT_BUTTON_PRESS && e->data == GPIO10);
+    bool red = (e->type == EVENT_BUTTON_PRESS && e->data == GPIO11);
+    bool red_release = (e->type == EVENT_BUTTON_RELEASE && e->data == GPIO11);
+
+    if (e->type == EVENT_REMOTE_MEASURE && fsm->state != UI_STATE_MEASURE) {
+        return remote_measure(fsm, e->data);
+    }
+
+    switch (fsm->state) {
+    case UI_STATE_MENU:
+        if (e->type == EVENT_BUTTON_LONG && e->data == BUTTON_BOTH) {
+            fsm->state = UI_STATE_STATS;
+            fsm->select_armed = false;
+            return UI_ACTION_SHOW_STATS;
+        }
+        if (yellow) {
+            fsm->selected = (fsm->selected + 1) % fsm->shape_count;
+            return UI_ACTION_NEXT;
+        }
+        // Only a release whose press was seen here selects
+        if (red) {
+            fsm->select_armed = true;
+            break;
+        }
+        if (!red_release || !fsm->select_armed) {
+            break;
+        }
+        fsm->select_armed = false;
+        if (fsm->selected == fsm->irr_entry) {
+            fsm->state = UI_STATE_IRR_MENU;
+            fsm->irr_selected = 0;
+            return UI_ACTION_SHOW_IRR_MENU;
+        }
+        if (fsm->selected == fsm->history_entry) {
+            fsm->state = UI_STATE_HISTORY;
+            return UI_ACTION_SHOW_HISTORY;
+        }
+        fsm->state = UI_STATE_MEASURE;
+        return UI_ACTION_MEASURE;
+
+    case UI_STATE_IRR_MENU:
+        if (yellow) {
+            fsm->irr_selected = (fsm->irr_selected + 1) % fsm->irr_count;
+            return UI_ACTION_NEXT_IRR;
+        }
+        if (red) {
+            fsm->state = UI_STATE_MEASURE;
+            return UI_ACTION_MEASURE_IRR;
+        }
+        break;
+
+    case UI_STATE_MEASURE:
+        if (e->type == EVENT_MEASURE_DONE) {
+            fsm->state = UI_STATE_RESULT;
+            return UI_ACTION_SHOW_RESULT;
+        }
+        if (e->type == EVENT_MEASURE_CANCEL) {
+            fsm->state = UI_STATE_MENU;
+            return UI_ACTION_SHOW_MENU;
+        }
+        return UI_ACTION_MEASURE_STEP;
+
+    case UI_STATE_RESULT:
+        if (red) {
+            fsm->state = UI_STATE_MENU;
+            return UI_ACTION_SHOW_MENU;
+        }
+        break;
+
+    case UI_STATE_STATS:
+        if (red) {
+            fsm->state = UI_STATE_MENU;
+            return UI_ACTION_SHOW_MENU;
+        }
+        if (yellow) {
+            return UI_ACTION_SHOW_STATS;
+        }
+        if (e->type == EVENT_BUTTON_LONG && e->data == GPIO10) {
+            return UI_ACTION_RESET_STATS;
+        }
+        break;
+
+    case UI_STATE_HISTORY:
+        if (red) {
+            fsm->state = UI_STATE_MENU;
+            return UI_ACTION_SHOW_MENU;
+        }
+        if (yellow) {
+            return UI_ACTION_HISTORY_OLDER;
+        }
+        break;
+    }
+    return UI_ACTION_NONE;
+}
@@ -0,0 +1,101 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file ui_fsm.h
+ * @brief State machine for the menu and measurement flow.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * The transitions only read events and return the action to perform; they
+ * touch no hardware, so a recorded event sequence always gives the same
+ * action sequence.
+ */
+#ifndef UI_FSM_H
+#define UI_FSM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "event.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Screens of the user interface.
+ */
+typedef enum {
+    UI_STATE_MENU,          // Main menu
+    UI_STATE_IRR_MENU,      // Irregular shape menu
+    UI_STATE_MEASURE,       // A measurement flow is running
+    UI_STATE_RESULT,        // Final value on screen
+    UI_STATE_STATS,         // Hidden profiling page
+    UI_STATE_HISTORY,       // Stored measurements, a page at a time
+} ui_state;
+
+/**
+ * @brief Work the caller performs after a transition.
+ */
+typedef enum {
+    UI_ACTION_NONE,
+    UI_ACTION_NEXT,             // Move the main menu cursor
+    UI_ACTION_SHOW_IRR_MENU,    // Draw the irregular shape menu
+    UI_ACTION_NEXT_IRR,         // Move the irregular menu cursor
+    UI_ACTION_MEASURE,          // Run the selected main menu measurement
+    UI_ACTION_MEASURE_IRR,      // Run the selected irregular shape measurement
+    UI_ACTION_MEASURE_STEP,     // Hand the event to the running measurement
+    UI_ACTION_SHOW_RESULT,      // Draw the final value
+    UI_ACTION_SHOW_MENU,        // Draw the main menu
+    UI_ACTION_SHOW_STATS,       // Draw the profiling page
+    UI_ACTION_RESET_STATS,      // Clear the profiling statistics and redraw them
+    UI_ACTION_SHOW_HISTORY,     // Draw the newest page of stored measurements
+    UI_ACTION_HISTORY_OLDER,    // Draw the next older page, wrapping to the newest
+} ui_action;
+
+/**
+ * @brief State machine state and menu selections.
+ */
+typedef struct {
+    ui_state state;
+    uint8_t selected;       // Main menu entry under the cursor
+    uint8_t shape_count;    // Number of main menu entries
+    uint8_t irr_entry;      // Main menu entry that opens the irregular menu
+    uint8_t irr_selected;   // Irregular menu entry under the cursor
+    uint8_t irr_count;      // Number of irregular menu entries
+    uint8_t history_entry;  // Main menu entry that opens the history
+    bool select_armed;      // Red was pressed in the main menu; its release selects
+} ui_fsm;
+
+/**
+ * @brief Start at the main menu with the first entry selected.
+ *
+ * @param fsm           The state machine.
+ * @param shape_count   Number of main menu entries.
+ * @param irr_entry     Main menu entry that opens the irregular menu.
+ * @param irr_count     Number of irregular menu entries.
+ * @param history_entry Main menu entry that opens the history.
+ */
+void ui_fsm_init(ui_fsm *fsm, uint8_t shape_count, uint8_t irr_entry, uint8_t irr_count,
+                 uint8_t history_entry);
+
+/**
+ * @brief Apply one event.
+ *
+ * @param fsm The state machine.
+ * @param e   The event.
+ * @return The action for the new state.
+ */
+ui_action ui_fsm_step(ui_fsm *fsm, const event *e);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UI_FSM_H
@@ -0,0 +1,131 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file usb_descriptors.c
+ * @brief USB descriptors of the export link, read by TinyUSB.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#include <string.h>
+#include "tusb.h"
+#include "pico/unique_id.h"
+
+// Raspberry Pi vendor ID and the Pico SDK's CDC product ID
+#define USB_VID (0x2E8A)
+#define USB_PID (0x000A)
+
+enum {
+    ITF_NUM_CDC,
+    ITF_NUM_CDC_DATA,
+    ITF_NUM_TOTAL,
+};
+
+#define EPNUM_CDC_NOTIF (0x81)
+#define EPNUM_CDC_OUT (0x02)
+#define EPNUM_CDC_IN (0x82)
+
+#define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_CDC_DESC_LEN)
+
+// Longest string descriptor, in characters
+#define STRING_MAX (31)
+
+// String indexes used in the descriptors
+enum {
+    STRID_LANGID,
+    STRID_MANUFACTURER,
+    STRID_PRODUCT,
+    STRID_SERIAL,
+    STRID_CDC,
+    STRID_COUNT,
+};
+
+static const tusb_desc_device_t desc_device = {
+    .bLength = sizeof(tusb_desc_device_t),
+    .bDescriptorType = TUSB_DESC_DEVICE,
+    .bcdUSB = 0x0200,
+    // Interface association, as CDC has two interfaces
+    .bDeviceClass = TUSB_CLASS_MISC,
+    .bDeviceSubClass = MISC_SUBCLASS_COMMON,
+    .bDeviceProtocol = MISC_PROTOCOL_IAD,
+    .bMaxPacketSize0 = CFG_TUD_ENDPOINT0_SIZE,
+    .idVendor = USB_VID,
+    .idProduct = USB_PID,
+    .bcdDevice = 0x0100,
+    .iManufacturer = STRID_MANUFACTURER,
+    .iProduct = STRID_PRODUCT,
+    .iSerialNumber = STRID_SERIAL,
+    .bNumConfigurations = 1,
+};
+
+static const uint8_t desc_configuration[] = {
+    TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0x00, 100),
+    TUD_CDC_DESCRIPTOR(ITF_NUM_CDC, STRID_CDC, EPNUM_CDC_NOTIF, 8, EPNUM_CDC_OUT, EPNUM_CDC_IN, 64),
+};
+
+static const char *const strings[STRID_COUNT] = {
+    [STRID_MANUFACTURER] = "Jithendra H S",
+    [STRID_PRODUCT] = "SS Mapper",
+    [STRID_CDC] = "SS Mapper export",
+};
+
+static uint16_t desc_string[STRING_MAX + 1];
+
+/**
+ * @brief Device descriptor, on GET DEVICE DESCRIPTOR.
+ */
+const uint8_t *tud_descriptor_device_cb(void) {
+    return (const uint8_t *)&desc_device;
+}
+
+/**
+ * @brief Configuration descriptor, on GET CONFIGURATION DESCRIPTOR.
+ */
+const uint8_t *tud_descriptor_configuration_cb(uint8_t index) {
+    (void)index;
+    return desc_configuration;
+}
+
+/**
+ * @brief String descriptor as UTF-16, on GET STRING DESCRIPTOR.
+ *
+ * The serial number is the flash chip's unique ID, so several boards on one
+ * host get stable, distinct device names.
+ */
+const uint16_t *tud_descriptor_string_cb(uint8_t index, uint16_t langid) {
+    char serial[2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES + 1];
+    const char *str;
+    size_t length;
+    (void)langid;
+
+    if (index == STRID_LANGID) {
+        desc_string[1] = 0x0409;    // English (United States)
+        length = 1;
+    } else {
+        if (index >= STRID_COUNT) {
+            return NULL;
+        }
+        if (index == STRID_SERIAL) {
+            pico_get_unique_board_id_string(serial, sizeof(serial));
+            str = serial;
+        } else {
+            str = strings[index];
+        }
+        length = strlen(str);
+        if (length > STRING_MAX) {
+            length = STRING_MAX;
+        }
+        for (size_t i = 0; i < length; i++) {
+            desc_string[1 + i] = (uint8_t)str[i];
+        }
+    }
+
+    desc_string[0] = (uint16_t)((TUSB_DESC_STRING << 8) | (2 * length + 2));
+    return desc_string;
+}
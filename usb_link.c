@@ -0,0 +1,353 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file usb_link.c
+ * @brief Bulk export and remote control over USB CDC.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#include "usb_link.h"
+#include <string.h>
+#include "pico/stdlib.h"
+#include "tusb.h"
+#include "frame.h"
+#include "journal.h"
+#include "area.h"
+#include "scan_codec.h"
+#include "remote.h"
+#include "mirror.h"
+#include "task.h"
+#include "trace.h"
+
+// Longest acceptable step: refilling the CDC transmit FIFO
+#define USB_TASK_BUDGET_US (2000)
+
+/**
+ * @brief What the link is sending.
+ */
+typedef enum {
+    EXPORT_IDLE,
+    EXPORT_JOURNAL,
+    EXPORT_SCAN,
+    EXPORT_MAP,
+    EXPORT_END,         // Only the end frame is left
+} export_kind;
+
+typedef struct {
+    export_kind kind;
+    uint32_t next;      // Next record id, scan or map byte to send
+    uint32_t total;     // Record id past the newest, or scan or map bytes to send
+    uint32_t sent;      // Records, scan or map bytes sent
+    uint8_t status;     // Status in the end frame
+} export_job;
+
+/**
+ * @brief A queued short message.
+ */
+typedef struct {
+    uint8_t type;
+    uint8_t length;
+    uint8_t data[USB_LINK_MAX_MESSAGE];
+} usb_message;
+
+static export_job job;
+static frame_decoder decoder;
+static frame request;
+static uint8_t tx[FRAME_MAX_ENCODED];
+static uint8_t tx_seq;          // Sequence number of the next frame
+
+// Ring of messages waiting for the transmit FIFO
+static usb_message outbox[USB_LINK_OUTBOX];
+static uint8_t outbox_head;     // Next message to send
+static uint8_t outbox_count;
+
+// Encoded copy of the sweep being exported, so a new sweep cannot change
+// it midway; large enough for any sweep the journal holds
+static uint8_t scan_data[JOURNAL_SCAN_MAX];
+
+_Static_assert(SCAN_ENCODED_MAX(SWEEP_MAX_POINTS) <= sizeof(scan_data), "a full sweep must fit the export buffer");
+
+static task_status usb_step(task *t);
+static task usb_task = { .name = "usb", .fn = usb_step, .budget_us = USB_TASK_BUDGET_US,
+                         .trace_id = TRACE_TASK_USB };
+
+/**
+ * @brief Queue one frame if the transmit FIFO has room for the largest.
+ *
+ * @return false if the FIFO is too full; try again on a later step.
+ */
+static bool send_frame(uint8_t type, const void *data, size_t length) {
+    if (tud_cdc_write_available() < FRAME_MAX_ENCODED) {
+        return false;
+    }
+    size_t n = frame_encode(type, tx_seq++, data, length, tx);
+    tud_cdc_write(tx, n);
+    return true;
+}
+
+/**
+ * @brief Start answering a request, dropping any export in progress.
+ */
+static void start_job(const frame *f) {
+    memset(&job, 0, sizeof(job));
+
+    switch (f->type) {
+    case FRAME_GET_JOURNAL: {
+        // The ids of the oldest and newest records now; records appended
+        // during the export are left for the next one
+        journal_record record;
+        uint32_t count = journal_count();
+        job.kind = EXPORT_JOURNAL;
+        if (count > 0) {
+            journal_read(count - 1, &record, &job.next);
+            journal_read(0, &record, &job.total);
+            job.total++;
+        }
+        break;
+    }
+    case FRAME_GET_SCAN:
+        if (f->length >= 4) {
+            journal_record record;
+            uint32_t id;
+            memcpy(&id, f->data, 4);
+            if (journal_find(id, &record)) {
+                job.total = journal_read_scan(&record, scan_data, sizeof(scan_data));
+            }
+        } else {
+            job.total = area_encode_scan(scan_data, sizeof(scan_data));
+        }
+        job.kind = job.total > 0 ? EXPORT_SCAN : EXPORT_END;
+        job.status = job.total > 0 ? FRAME_STATUS_OK : FRAME_STATUS_NO_DATA;
+        break;
+    case FRAME_GET_MAP: {
+        const occ_map *map = area_last_map();
+        job.total = map ? occ_export_size(map) : 0;
+        job.kind = job.total > 0 ? EXPORT_MAP : EXPORT_END;
+        job.status = job.total > 0 ? FRAME_STATUS_OK : FRAME_STATUS_NO_DATA;
+        break;
+    }
+    default:
+        job.kind = EXPORT_END;
+        job.status = FRAME_STATUS_UNKNOWN;
+        break;
+    }
+}
+
+/**
+ * @brief Send the next journal record, oldest first.
+ *
+ * Records are walked by id, which an append does not shift as it does
+ * positions. A record that fails its CRC, was never committed or has been
+ * overwritten since the export started is left out; the end frame counts
+ * only the records sent.
+ */
+static bool send_record(void) {
+    uint8_t data[4 + sizeof(journal_record)];
+    journal_record record;
+
+    if (!journal_find(job.next, &record)) {
+        job.next++;
+        return true;
+    }
+    memcpy(data, &job.next, 4);
+    memcpy(data + 4, &record, sizeof(record));
+    if (!send_frame(FRAME_RECORD, data, sizeof(data))) {
+        return false;
+    }
+    job.next++;
+    job.sent++;
+    return true;
+}
+
+/**
+ * @brief Send the next chunk of the encoded scan.
+ */
+static bool send_scan_chunk(void) {
+    uint8_t data[FRAME_MAX_DATA];
+    uint32_t count = job.total - job.next;
+
+    if (count > FRAME_SCAN_CHUNK) {
+        count = FRAME_SCAN_CHUNK;
+    }
+    memcpy(data, &job.next, 4);
+    memcpy(data + 4, &job.total, 4);
+    memcpy(data + 8, &scan_data[job.next], count);
+    if (!send_frame(FRAME_SCAN, data, 8 + count)) {
+        return false;
+    }
+    job.next += count;
+    job.sent += count;
+    return true;
+}
+
+/**
+ * @brief Send the next chunk of the occupancy map.
+ *
+ * The map is read in place, as it is too large to copy; if a new map is
+ * started before the export is done, the export ends with
+ * FRAME_STATUS_BUSY.
+ */
+static bool send_map_chunk(void) {
+    uint8_t data[FRAME_MAX_DATA];
+    const occ_map *map = area_last_map();
+    uint32_t count = job.total - job.next;
+
+    if (map == NULL) {
+        job.kind = EXPORT_END;
+        job.status = FRAME_STATUS_BUSY;
+        return true;
+    }
+    if (count > FRAME_MAP_CHUNK) {
+        count = FRAME_MAP_CHUNK;
+    }
+    memcpy(data, &job.next, 4);
+    memcpy(data + 4, &job.total, 4);
+    occ_export_read(map, job.next, data + 8, count);
+    if (!send_frame(FRAME_MAP, data, 8 + count)) {
+        return false;
+    }
+    job.next += count;
+    job.sent += count;
+    return true;
+}
+
+/**
+ * @brief Fill the transmit FIFO with as much of the export as fits.
+ */
+static void run_job(void) {
+    while (job.kind != EXPORT_IDLE) {
+        bool queued;
+
+        if (job.kind != EXPORT_END && job.next < job.total) {
+            switch (job.kind) {
+            case EXPORT_JOURNAL:
+                queued = send_record();
+                break;
+            case EXPORT_SCAN:
+                queued = send_scan_chunk();
+                break;
+            default:
+                queued = send_map_chunk();
+                break;
+            }
+        } else {
+            uint8_t end[5];
+            memcpy(end, &job.sent, 4);
+            end[4] = job.status;
+            queued = send_frame(FRAME_END, end, sizeof(end));
+            if (queued) {
+                job.kind = EXPORT_IDLE;
+            }
+        }
+        if (!queued) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Move queued messages to the transmit FIFO, oldest first.
+ */
+static void send_outbox(void) {
+    while (outbox_count > 0) {
+        const usb_message *m = &outbox[outbox_head];
+        if (!send_frame(m->type, m->data, m->length)) {
+            return;
+        }
+        outbox_head = (outbox_head + 1) % USB_LINK_OUTBOX;
+        outbox_count--;
+    }
+}
+
+/**
+ * @brief Send as much of the display mirror as fits the transmit FIFO.
+ */
+static void send_mirror(void) {
+    uint8_t data[FRAME_MAX_DATA];
+
+    while (tud_cdc_write_available() >= FRAME_MAX_ENCODED) {
+        size_t n = mirror_chunk(data, sizeof(data));
+        if (n == 0) {
+            return;
+        }
+        send_frame(FRAME_MIRROR, data, n);
+    }
+}
+
+/**
+ * @brief USB task: run the device stack, take requests and feed the export.
+ *
+ * USB interrupts wake the scheduler, so the stack is serviced whenever the
+ * host has something for it. Requests are read only while the outbox has
+ * room for a reply; otherwise they wait in the receive FIFO and the host is
+ * held off by USB flow control, so pipelined commands are never dropped.
+ * While an export, mirror packets or messages wait the task yields to stay
+ * scheduled, and sends whenever the host has drained the FIFO. The mirror
+ * goes ahead of an export, so the screen stays live during a download.
+ */
+static task_status usb_step(task *t) {
+    (void)t;
+
+    tud_task();
+    if (!tud_cdc_connected()) {
+        job.kind = EXPORT_IDLE;
+        outbox_count = 0;
+        mirror_enable(false);
+        frame_decoder_init(&decoder);
+        return TASK_WAITING;
+    }
+
+    send_outbox();
+    while (outbox_count < USB_LINK_OUTBOX && tud_cdc_available() > 0) {
+        int32_t c = tud_cdc_read_char();
+        if (c >= 0 && frame_decode(&decoder, (uint8_t)c, &request) == FRAME_READY &&
+            !remote_command(&request)) {
+            start_job(&request);
+        }
+    }
+
+    send_outbox();
+    send_mirror();
+    run_job();
+    tud_cdc_write_flush();
+    return (job.kind != EXPORT_IDLE || outbox_count > 0 || mirror_pending()) ? TASK_YIELDED : TASK_WAITING;
+}
+
+/**
+ * @brief Start the USB device and register the task that serves it.
+ */
+void usb_link_init(void) {
+    frame_decoder_init(&decoder);
+    job.kind = EXPORT_IDLE;
+    tusb_init();
+    task_add(&usb_task);
+}
+
+/**
+ * @brief Queue a short message for the host.
+ *
+ * @param type   The frame type.
+ * @param data   The data, or NULL if length is 0.
+ * @param length Bytes of data, at most USB_LINK_MAX_MESSAGE.
+ * @return false if the message was dropped: no host, too long or the outbox is full.
+ */
+bool usb_link_send(uint8_t type, const void *data, size_t length) {
+    if (length > USB_LINK_MAX_MESSAGE || outbox_count == USB_LINK_OUTBOX || !tud_cdc_connected()) {
+        return false;
+    }
+    usb_message *m = &outbox[(outbox_head + outbox_count) % USB_LINK_OUTBOX];
+    m->type = type;
+    m->length = (uint8_t)length;
+    if (length > 0) {
+        memcpy(m->data, data, length);
+    }
+    outbox_count++;
+    return true;
+}
@@ -0,0 +1,55 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file usb_link.h
+ * @brief Bulk export and remote control over USB CDC.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ *
+ * The board enumerates as a CDC serial device that speaks only the framed
+ * protocol of frame.h; text output stays on the UART, so the two never mix.
+ * A host requests the journal, the last sweep or the last occupancy map
+ * and the device streams it back as fast as the host drains the endpoint.
+ * tools/ssm_export receives it. Remote control commands (remote.h) and the
+ * measurement notices they lead to share the link; short messages go out
+ * ahead of export frames.
+ */
+#ifndef USB_LINK_H
+#define USB_LINK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Largest message usb_link_send() takes
+#define USB_LINK_MAX_MESSAGE (48)
+
+// Messages waiting to be sent
+#define USB_LINK_OUTBOX (16)
+
+/**
+ * @brief Start the USB device and register the task that serves it.
+ */
+void usb_link_init(void);
+
+/**
+ * @brief Queue a short message for the host.
+ *
+ * Messages are sent in order, ahead of any export in progress. Nothing is
+ * queued while no host has the port open.
+ *
+ * @param type   The frame type.
+ * @param data   The data, or NULL if length is 0.
+ * @param length Bytes of data, at most USB_LINK_MAX_MESSAGE.
+ * @return false if the message was dropped: no host, too long or the outbox is full.
+ */
+bool usb_link_send(uint8_t type, const void *data, size_t length);
+
+#endif // USB_LINK_H
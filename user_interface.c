@@ -24,94 +24,476 @@
 #include <stdlib.h>
 #include "button.h"
 #include "area.h"
+#include "event.h"
+#include "ui_fsm.h"
+#include "task.h"
+#include "measure.h"
+#include "profile.h"
+#include "trace.h"
+#include "log.h"
+#include "journal.h"
+#include "scan_codec.h"
+#include "remote.h"
+#include "hardware/clocks.h"
+
+// Time between idle and task reports on the serial port (10 s)
+#define UI_STATS_PERIOD_US (10000000)
+
+// Longest acceptable stretch of UI work; a full redraw of the OLED fits
+#define UI_TASK_BUDGET_US (50000)
+
+// Stored measurements per history page, one Font8 row each, and the rows
+// the pages occupy above the footer
+#define HISTORY_ROWS (10)
+#define HISTORY_ROW_Y (14)
+#define HISTORY_FOOTER_Y (120)
+
+// Longest acceptable report; the serial port blocks while it drains
+#define STATS_TASK_BUDGET_US (20000)
+
+static UBYTE *BlackImage;       // Image cache
+static ui_fsm fsm;
+static double_array area;       // Result of the last measurement
+static char *shape;             // Shape under the cursor
+static measure_session session; // Capture sequence of the running measurement
+static bool session_active;     // The running measurement is a capture sequence
+static uint32_t history_page;   // History page on screen, 0 for the newest
+
+_Static_assert(MEASURE_MAX_STEPS <= JOURNAL_MAX_VALUES, "journal records hold every captured distance");
+_Static_assert(SCAN_ENCODED_MAX(SWEEP_MAX_POINTS) <= JOURNAL_SCAN_MAX, "the journal holds a full sweep");
+
+/**
+ * @brief Record the result of a measurement in the journal
+ * 
+ * @param m The capture sequence that produced it, or NULL for a sweep
+ */
+static void journal_result(const measure_session *m) {
+    journal_record record = {0};
+    sensor_frame frame = {0};
+
+    // Nothing was measured, e.g. a sweep that was aborted
+    if (area.result[0] == 0 && area.result[1] == 0) {
+        return;
+    }
+
+    record.time_ms = to_ms_since_boot(get_absolute_time());
+    strncpy(record.shape, shape, JOURNAL_SHAPE_LEN - 1);
+    record.result[0] = (int32_t)(area.result[0] * 100 + 0.5);
+    record.result[1] = (int32_t)(area.result[1] * 100 + 0.5);
+    if (m != NULL) {
+        record.steps = m->plan->steps;
+        memcpy(record.values, m->values, m->plan->steps * sizeof(m->values[0]));
+        frame = m->frame;
+    } else {
+        sensor_latest(&frame);
+    }
+    record.tilt[0] = frame.tilt[0];
+    record.tilt[1] = frame.tilt[1];
+
+    // Keep the sweep the result came from, encoded, next to the record
+    if (m == NULL) {
+        static uint8_t scan_data[SCAN_ENCODED_MAX(SWEEP_MAX_POINTS)];
+        size_t length = area_encode_scan(scan_data, sizeof(scan_data));
+        if (length > 0) {
+            journal_attach_scan(&record, scan_data, length);
+        }
+    }
+    journal_append(&record);
+}
+
+/**
+ * @brief Display the final value of a measurement
+ * 
+ * @param BlackImage Pointer to the image cache
+ * @param shape The measured shape
+ * @param area The measurement result
+ */
+static void show_result(UBYTE *BlackImage, const char *shape, const double_array *area) {
+    OLED_Clear();
+    // Use memset to set all values to 0x00
+    memset(BlackImage, 0x00, OLED_IMAGE_SIZE);
+    LOG_INFO("Shape : %s and area %f\n\r", shape, area->result[1]);
+    Paint_DrawString_EN(0, 12, "Final value :", &Font12, WHITE, BLACK);
+    Paint_DrawString_EN(93, 24, "     ", &Font12, WHITE, BLACK);
+    Paint_DrawString_EN(79, 36, "        ", &Font12, WHITE, BLACK);
+
+    if (strcmp(shape, "Distance") == 0) {
+        Paint_DrawNum(0, 24, area->result[0], &Font12, 2, WHITE, BLACK);
+        Paint_DrawString_EN(114, 24, "cm", &Font12, WHITE, BLACK);
+        Paint_DrawNum(0, 36, area->result[1], &Font12, 2, WHITE, BLACK);
+        Paint_DrawString_EN(100, 36, "foot", &Font12, WHITE, BLACK);
+    } else {
+        Paint_DrawNum(0, 24, area->result[0], &Font12, 2, WHITE, BLACK);
+        Paint_DrawString_EN(93, 24, "sq.cm", &Font12, WHITE, BLACK);
+        Paint_DrawNum(0, 36, area->result[1], &Font12, 2, WHITE, BLACK);
+        Paint_DrawString_EN(79, 36, "sq.foot", &Font12, WHITE, BLACK);
+    }
+
+    Paint_DrawString_EN(0, 120, "*Press Red to exit", &Font8, WHITE, BLACK);
+    OLED_Display(BlackImage);
+}
+
+/**
+ * @brief Display the profiling probes on the hidden stats page
+ * 
+ * Each row shows how often a probe ran and its average and longest run in
+ * microseconds. Drawing the page runs the probes it shows, so the figures
+ * are read before anything is drawn.
+ * 
+ * @param BlackImage Pointer to the image cache
+ */
+static void show_stats(UBYTE *BlackImage) {
+    profile_stats stats[PROFILE_COUNT];
+    uint32_t cycles_per_us = clock_get_hz(clk_sys) / 1000000;
+    char line[32];
+
+    for (uint8_t i = 0; i < PROFILE_COUNT; i++) {
+        profile_get(i, &stats[i]);
+    }
+
+    OLED_Clear();
+    memset(BlackImage, 0x00, OLED_IMAGE_SIZE);
+    Paint_DrawString_EN(0, 0, "Profile", &Font8, WHITE, BLACK);
+    Paint_DrawString_EN(0, 12, "probe count  avg   max", &Font8, WHITE, BLACK);
+    for (uint8_t i = 0; i < PROFILE_COUNT; i++) {
+        uint32_t avg_us = stats[i].count ? (uint32_t)(stats[i].total / stats[i].count / cycles_per_us) : 0;
+        snprintf(line, sizeof(line), "%-6s%5lu%6lu%6lu", profile_name(i),
+                 (unsigned long)stats[i].count, (unsigned long)avg_us,
+                 (unsigned long)(stats[i].max / cycles_per_us));
+        Paint_DrawString_EN(0, 24 + i * 10, line, &Font8, WHITE, BLACK);
+    }
+    Paint_DrawString_EN(0, 110, "Times in us", &Font8, WHITE, BLACK);
+    Paint_DrawString_EN(0, 120, "*Red:Exit  Yellow:Refresh", &Font8, WHITE, BLACK);
+    OLED_Display(BlackImage);
+}
+
+/**
+ * @brief Display a page of stored measurements, newest first
+ * 
+ * Each row shows the record number, the shape and the first result. The
+ * records are read by position through the journal index, so a page costs
+ * the same however many records there are. Turning a page redraws and
+ * sends only the rows above the footer.
+ * 
+ * @param BlackImage Pointer to the image cache
+ * @param full Draw the whole screen, as when the page is opened
+ */
+static void show_history(UBYTE *BlackImage, bool full) {
+    uint32_t count = journal_count();
+    uint32_t pages = count ? (count + HISTORY_ROWS - 1) / HISTORY_ROWS : 1;
+    journal_record record;
+    uint32_t id;
+    char line[32];
+
+    if (history_page >= pages) {
+        history_page = 0;
+    }
+
+    memset(BlackImage, 0x00, full ? OLED_IMAGE_SIZE : OLED_IMAGE_SIZE / OLED_HEIGHT * HISTORY_FOOTER_Y);
+    snprintf(line, sizeof(line), "History %lu/%lu", (unsigned long)(history_page + 1),
+             (unsigned long)pages);
+    Paint_DrawString_EN(0, 0, line, &Font12, WHITE, BLACK);
+    if (count == 0) {
+        Paint_DrawString_EN(0, HISTORY_ROW_Y, "No measurements yet", &Font8, WHITE, BLACK);
+    }
+
+    for (uint8_t i = 0; i < HISTORY_ROWS; i++) {
+        uint32_t position = history_page * HISTORY_ROWS + i;
+        if (position >= count) {
+            break;
+        }
+        if (journal_read(position, &record, &id)) {
+            snprintf(line, sizeof(line), "%5lu %-9.9s %6ld.%02ld", (unsigned long)id, record.shape,
+                     (long)(record.result[0] / 100), (long)(record.result[0] % 100));
+        } else {
+            snprintf(line, sizeof(line), "%5lu (damaged)", (unsigned long)id);
+        }
+        Paint_DrawString_EN(0, HISTORY_ROW_Y + i * 10, line, &Font8, WHITE, BLACK);
+    }
+
+    if (full) {
+        Paint_DrawString_EN(0, HISTORY_FOOTER_Y, "*Yellow:Older  Red:Exit", &Font8, WHITE, BLACK);
+        OLED_Display(BlackImage);
+    } else {
+        OLED_Display_Rows(BlackImage, 0, HISTORY_FOOTER_Y);
+    }
+}
+
+/**
+ * @brief Print the probes in cycles and the XIP cache hit rate
+ * 
+ * Cycles, unlike the microseconds of the stats page, compare directly
+ * between builds that place the hot paths differently (see ram_code.h).
+ * The probes accumulate until reset from the stats page; the cache figures
+ * cover the last report period.
+ */
+static void report_profile() {
+    profile_stats stats;
+    uint32_t hits;
+    uint32_t accesses;
+
+    for (uint8_t i = 0; i < PROFILE_COUNT; i++) {
+        profile_get(i, &stats);
+        if (stats.count == 0) {
+            continue;
+        }
+        LOG_INFO("Probe %-6s %lu runs, cycles min %lu avg %lu max %lu\n\r", profile_name(i),
+                 (unsigned long)stats.count, (unsigned long)stats.min,
+                 (unsigned long)(stats.total / stats.count), (unsigned long)stats.max);
+    }
+    profile_xip(&hits, &accesses);
+    uint32_t hit_permille = accesses ? (uint32_t)((uint64_t)hits * 1000 / accesses) : 1000;
+    LOG_INFO("XIP cache %lu.%lu%% hits of %lu reads\n\r", (unsigned long)(hit_permille / 10),
+             (unsigned long)(hit_permille % 10), (unsigned long)accesses);
+}
 
 /**
- * @brief Main user interface function
+ * @brief Print the share of time core0 spent asleep and restart the window
+ */
+static void report_idle() {
+    event_stats stats;
+    event_get_stats(&stats);
+    if (stats.elapsed_us == 0) {
+        return;
+    }
+    uint32_t idle_permille = (uint32_t)(stats.idle_us * 1000 / stats.elapsed_us);
+    LOG_INFO("Idle %lu.%lu%%, %lu events, max depth %u, dropped %lu\n\r",
+             (unsigned long)(idle_permille / 10), (unsigned long)(idle_permille % 10),
+             (unsigned long)stats.posted, stats.max_depth, (unsigned long)stats.dropped);
+    task_report(stats.elapsed_us);
+    event_reset_stats();
+}
+
+/**
+ * @brief Stats task: report idle time and task budgets periodically
+ * 
+ * @param t The task
+ * @return The task status
+ */
+static task_status stats_step(task *t) {
+    static uint64_t next_report_us;
+
+    TASK_BEGIN(t);
+    next_report_us = time_us_64() + UI_STATS_PERIOD_US;
+    while (true) {
+        // The event tick wakes the core often enough to notice the deadline
+        TASK_WAIT_UNTIL(t, time_us_64() >= next_report_us);
+        report_idle();
+        report_profile();
+        next_report_us += UI_STATS_PERIOD_US;
+    }
+    TASK_END(t);
+}
+
+/**
+ * @brief UI task: take one event and perform the action it leads to
+ * 
+ * The state machine picks the action and this function performs it on the
+ * OLED screen. Point-to-point measurements advance one capture step per
+ * event; sweeps run to completion inside their action, and while they wait
+ * for input the other tasks keep running. Both report back with
+ * EVENT_MEASURE_DONE, or EVENT_MEASURE_CANCEL when abandoned.
+ * 
+ * @param t The task
+ * @return The task status
+ */
+static task_status ui_step(task *t) {
+    event e;
+    if (!event_poll(&e)) {
+        return TASK_WAITING;
+    }
+
+    ui_action action = ui_fsm_step(&fsm, &e);
+    switch (action) {
+    case UI_ACTION_NEXT:
+        // Move cursor to select a shape
+        shape = move_cursor(BlackImage);
+        LOG_INFO("GPIO10 is pressed! and shape %s, redrawn %lu us after the press\n\r",
+                 shape, (unsigned long)(time_us_32() - e.time_us));
+        break;
+
+    case UI_ACTION_SHOW_IRR_MENU:
+        irr_menu(BlackImage);
+        shape = irr_shapes[fsm.irr_selected];
+        break;
+
+    case UI_ACTION_NEXT_IRR:
+        shape = move_cursor_irr_menu(BlackImage);
+        LOG_INFO("GPIO10 is pressed! and shape %s\n\r", shape);
+        break;
+
+    case UI_ACTION_MEASURE:
+    case UI_ACTION_MEASURE_IRR:
+        // A measurement the host started skipped the menus; follow it there
+        put_cursor_pos(fsm.selected);
+        shape = (action == UI_ACTION_MEASURE_IRR) ? irr_shapes[fsm.irr_selected] : shapes[fsm.selected];
+        OLED_Clear();
+        // Use memset to set all values to 0x00
+        memset(BlackImage, 0x00, OLED_IMAGE_SIZE);
+        OLED_Display(BlackImage);
+
+        // Point-to-point shapes run one capture step per event from here on
+        const measure_plan *plan = area_find_plan(shape);
+        if (plan != NULL) {
+            measure_start(&session, plan, BlackImage);
+            session_active = true;
+            break;
+        }
+
+        // Calculate area based on the selected shape
+        bool aborted;
+        if (action == UI_ACTION_MEASURE_IRR) {
+            area = calculate_area_irr_shape(shape, BlackImage, &aborted);
+        } else {
+            area = calculate_area(shape, BlackImage, &aborted);
+        }
+
+        // Presses made while the measurement was busy are stale
+        event_flush();
+        if (aborted) {
+            remote_cancelled();
+            event_post(EVENT_MEASURE_CANCEL, 0);
+            break;
+        }
+        journal_result(NULL);
+        event_post(EVENT_MEASURE_DONE, 0);
+        break;
+
+    case UI_ACTION_MEASURE_STEP:
+        if (!session_active) {
+            break;
+        }
+        uint8_t captured = session.step;
+        measure_status status = measure_handle(&session, &e, BlackImage);
+        if (session.step > captured) {
+            remote_captured(session.step, session.plan->steps, session.values[session.step - 1]);
+        }
+        switch (status) {
+        case MEASURE_DONE:
+            area = measure_result(&session);
+            session_active = false;
+            journal_result(&session);
+            event_post(EVENT_MEASURE_DONE, 0);
+            break;
+        case MEASURE_CANCELLED:
+            session_active = false;
+            remote_cancelled();
+            event_post(EVENT_MEASURE_CANCEL, 0);
+            break;
+        case MEASURE_RUNNING:
+            break;
+        }
+        break;
+
+    case UI_ACTION_SHOW_RESULT:
+        remote_result(shape, area.result);
+        show_result(BlackImage, shape, &area);
+        break;
+
+    case UI_ACTION_SHOW_MENU:
+        LOG_INFO("Exiting after area is displayed\n\r");
+        // Display the main menu
+        menu(BlackImage);
+        shape = shapes[fsm.selected];
+        break;
+
+    case UI_ACTION_RESET_STATS:
+        profile_reset();
+        show_stats(BlackImage);
+        break;
+
+    case UI_ACTION_SHOW_STATS:
+        show_stats(BlackImage);
+        break;
+
+    case UI_ACTION_SHOW_HISTORY:
+        history_page = 0;
+        show_history(BlackImage, true);
+        break;
+
+    case UI_ACTION_HISTORY_OLDER:
+        history_page++;
+        show_history(BlackImage, false);
+        break;
+
+    case UI_ACTION_NONE:
+        break;
+    }
+    return TASK_YIELDED;
+}
+
+static task ui_task = { .name = "ui", .fn = ui_step, .budget_us = UI_TASK_BUDGET_US,
+                        .trace_id = TRACE_TASK_UI };
+static task stats_task = { .name = "stats", .fn = stats_step, .budget_us = STATS_TASK_BUDGET_US,
+                           .trace_id = TRACE_TASK_STATS };
+
+/**
+ * @brief Set up the user interface and register its tasks
  * 
- * This function handles user interactions and displays information on the OLED screen.
- * It continuously checks the states of GPIO10 and GPIO11 buttons to perform corresponding actions.
+ * The menu and measurement flow run as a state machine in the UI task; the
+ * stats task reports on the serial port. Both run once task_run() starts.
  */
-void user_interface() {
+void user_interface_start() {
     // Create a new image cache
-    UBYTE *BlackImage;
     BlackImage = (UBYTE *)malloc(OLED_IMAGE_SIZE);
     if (BlackImage == NULL) { 
         // No enough memory
-        printf(" No enough memory\n");
+        LOG_ERROR(" No enough memory\n");
+    }
+
+    // The main menu entries that open the irregular menu and the history
+    uint8_t irr_entry = 0;
+    uint8_t history_entry = 0;
+    for (uint8_t i = 0; i < shapes_count; i++) {
+        if (strcmp(shapes[i], "Irregular menu") == 0) {
+            irr_entry = i;
+        }
+        if (strcmp(shapes[i], "History") == 0) {
+            history_entry = i;
+        }
     }
-    
+
+    ui_fsm_init(&fsm, shapes_count, irr_entry, irr_shapes_count, history_entry);
+    shape = shapes[0];
+
     // Display the main menu
     menu(BlackImage);
 
-    // Initial shape selection
-    char *shape = shapes[0];
+    task_add(&ui_task);
+    task_add(&stats_task);
+}
 
-    bool gpio10_state;
-    bool gpio11_state;
+/**
+ * @brief Read what the user interface is doing
+ * 
+ * @param status Output status
+ */
+void user_interface_status(ui_status *status) {
+    status->state = fsm.state;
+    status->step = session_active ? session.step : 0;
+    status->steps = session_active ? session.plan->steps : 0;
+    status->shape = shape;
+}
 
-    while (true) {
-        // Read the state of GPIO10
-        gpio10_state = !!((1ul << GPIO10) & sio_hw->gpio_in);
-        // Read the state of GPIO11
-        gpio11_state = !!((1ul << GPIO11) & sio_hw->gpio_in);
-
-        // Perform actions based on the GPIO10 state
-        if (!gpio10_state) {
-            sleep_ms(200);
-            // Move cursor to select a shape
-            shape = move_cursor(BlackImage);
-            printf("GPIO10 is high (pressed)! and shape %s\n\r", shape);
+/**
+ * @brief Find the menu entry that measures a shape
+ * 
+ * Irregular shapes follow the main menu entries, as ui_fsm_step() numbers
+ * them; the entries that only open another screen measure nothing.
+ * 
+ * @param name The shape, as the menus show it
+ * @return The entry, or -1 if no entry measures that shape
+ */
+int user_interface_entry(const char *name) {
+    for (uint8_t i = 0; i < shapes_count; i++) {
+        if (i != fsm.irr_entry && i != fsm.history_entry && strcmp(shapes[i], name) == 0) {
+            return i;
         }
-        
-        // Perform actions based on the GPIO11 state
-        if (!gpio11_state) {
-            sleep_ms(200);
-            OLED_Clear();
-            // Use memset to set all values to 0x00
-            memset(BlackImage, 0x00, OLED_IMAGE_SIZE);
-            OLED_Display(BlackImage);
-            
-            // Calculate area based on the selected shape
-            double_array area = calculate_area(shape, BlackImage);
-            
-            // Display the calculated area
-            OLED_Clear();
-            // Use memset to set all values to 0x00
-            memset(BlackImage, 0x00, OLED_IMAGE_SIZE);
-            printf("GPIO11 is high (pressed)! , shape : %s and area %f\n\r", shape, area.result[1]);
-            Paint_DrawString_EN(0, 12, "Final value :", &Font12, WHITE, BLACK);
-            Paint_DrawString_EN(93, 24, "     ", &Font12, WHITE, BLACK);
-            Paint_DrawString_EN(79, 36, "        ", &Font12, WHITE, BLACK);
-
-            if (strcmp(shape, "Distance") == 0) {
-                Paint_DrawNum(0, 24, area.result[0], &Font12, 2, WHITE, BLACK);
-                Paint_DrawString_EN(114, 24, "cm", &Font12, WHITE, BLACK);
-                Paint_DrawNum(0, 36, area.result[1], &Font12, 2, WHITE, BLACK);
-                Paint_DrawString_EN(100, 36, "foot", &Font12, WHITE, BLACK);
-            } else {
-                Paint_DrawNum(0, 24, area.result[0], &Font12, 2, WHITE, BLACK);
-                Paint_DrawString_EN(93, 24, "sq.cm", &Font12, WHITE, BLACK);
-                Paint_DrawNum(0, 36, area.result[1], &Font12, 2, WHITE, BLACK);
-                Paint_DrawString_EN(79, 36, "sq.foot", &Font12, WHITE, BLACK);
-            }
-
-            Paint_DrawString_EN(0, 120, "*Press Red to exit", &Font8, WHITE, BLACK);
-            OLED_Display(BlackImage);
-
-            // Wait for GPIO11 to be released before going back to the menu
-            while (true) {
-                // Read the state of GPIO11
-                bool gpio11_state = !!((1ul << GPIO11) & sio_hw->gpio_in);
-                // Perform actions based on the GPIO11 state
-                if (!gpio11_state) {
-                    printf("Exiting after area is displayed\n\r");
-                    sleep_ms(500);
-                    break;
-                }
-            }
-            
-            // Display the main menu
-            menu(BlackImage);
+    }
+    for (uint8_t i = 0; i < irr_shapes_count; i++) {
+        if (strcmp(irr_shapes[i], name) == 0) {
+            return shapes_count + i;
         }
     }
+    return -1;
 }
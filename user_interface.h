@@ -16,10 +16,44 @@
  *
  * @date December 15, 2023
 */
+#ifndef USER_INTERFACE_H
+#define USER_INTERFACE_H
+
+#include <stdint.h>
+
 /**
- * @brief Main user interface function
+ * @brief What the user interface is doing, as the remote control reports it
+ */
+typedef struct {
+    uint8_t state;          // ui_state of the state machine
+    uint8_t step;           // Distances captured by the running measurement
+    uint8_t steps;          // Distances it captures; 0 for a sweep or when idle
+    const char *shape;      // Shape under the cursor or being measured
+} ui_status;
+
+/**
+ * @brief Set up the user interface and register its tasks
+ * 
+ * This function draws the main menu and registers the UI task, which handles
+ * button events and displays information on the OLED screen, and the stats
+ * task. They run once task_run() starts.
+ */
+void user_interface_start();
+
+/**
+ * @brief Read what the user interface is doing
+ * 
+ * @param status Output status
+ */
+void user_interface_status(ui_status *status);
+
+/**
+ * @brief Find the menu entry that measures a shape
  * 
- * This function handles user interactions and displays information on the OLED screen.
- * It continuously checks the states of GPIO10 and GPIO11 buttons to perform corresponding actions.
+ * @param name The shape, as the menus show it
+ * @return The entry as EVENT_REMOTE_MEASURE takes it, or -1 if no entry
+ *         measures that shape
  */
-void user_interface();
+int user_interface_entry(const char *name);
+
+#endif // USER_INTERFACE_H
@@ -0,0 +1,385 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file walls.c
+ * @brief RANSAC wall extraction from sweep points into room corners.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#include "walls.h"
+#include <string.h>
+
+// |cross| of two unit directions below sin(20 deg): treated as parallel
+#define WALLS_PARALLEL_LIMIT ((int64_t)WALLS_DIR_ONE * WALLS_DIR_ONE * 342 / 1000)
+
+// |dot| of two unit directions below sin(10 deg): treated as perpendicular
+#define WALLS_SQUARE_LIMIT ((int64_t)WALLS_DIR_ONE * WALLS_DIR_ONE * 174 / 1000)
+
+// Corners farther than this from the device are rejected as bad intersections
+#define WALLS_MAX_CORNER_CM (2 * SWEEP_MAX_RANGE_CM)
+
+// One quadrant of the pseudo-angle used to order walls around the device
+#define PSEUDO_QUADRANT (65536u)
+
+// Working copies of the sweep points in centimeters, and their wall assignment
+static int32_t point_x[SWEEP_MAX_POINTS];
+static int32_t point_y[SWEEP_MAX_POINTS];
+static bool point_used[SWEEP_MAX_POINTS];
+
+// Indices of the points not yet assigned to a wall, in sweep order
+static uint16_t free_index[SWEEP_MAX_POINTS];
+
+// Deterministic generator so a given sweep always gives the same walls
+static uint32_t rng_state;
+
+/**
+ * @brief Next value of a 32-bit linear congruential generator.
+ */
+static uint32_t next_random(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+/**
+ * @brief Monotonic stand-in for atan2 used only to order walls.
+ *
+ * @return 0 .. 4 * PSEUDO_QUADRANT counterclockwise from the +X axis.
+ */
+static uint32_t pseudo_angle(int32_t x, int32_t y) {
+    if (x == 0 && y == 0) {
+        return 0;
+    }
+    if (y >= 0) {
+        return (x >= 0) ? (uint32_t)((int64_t)y * PSEUDO_QUADRANT / (x + y))
+                        : PSEUDO_QUADRANT + (uint32_t)((int64_t)-x * PSEUDO_QUADRANT / (y - x));
+    }
+    return (x < 0) ? 2 * PSEUDO_QUADRANT + (uint32_t)((int64_t)-y * PSEUDO_QUADRANT / (-x - y))
+                   : 3 * PSEUDO_QUADRANT + (uint32_t)((int64_t)x * PSEUDO_QUADRANT / (x - y));
+}
+
+/**
+ * @brief Check a point against the line a * x + b * y + c = 0.
+ *
+ * Compares squared distances so no division or square root is needed.
+ */
+static bool near_line(int64_t a, int64_t b, int64_t c, int32_t x, int32_t y) {
+    int64_t residual = a * x + b * y + c;
+    int64_t tolerance = (int64_t)WALLS_INLIER_TOLERANCE_CM * WALLS_INLIER_TOLERANCE_CM;
+    return residual * residual <= tolerance * (a * a + b * b);
+}
+
+/**
+ * @brief Line coefficients through a point along a direction.
+ */
+static void line_from_direction(int64_t x, int64_t y, int64_t dx, int64_t dy,
+                                int64_t *a, int64_t *b, int64_t *c) {
+    *a = dy;
+    *b = -dx;
+    *c = -(*a * x + *b * y);
+}
+
+/**
+ * @brief Count unused points within tolerance of a line.
+ */
+static uint16_t count_inliers(uint16_t count, int64_t a, int64_t b, int64_t c) {
+    uint16_t inliers = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        if (!point_used[i] && near_line(a, b, c, point_x[i], point_y[i])) {
+            inliers++;
+        }
+    }
+    return inliers;
+}
+
+/**
+ * @brief Least-squares refit of a wall through the inliers of a line.
+ *
+ * The direction is the principal eigenvector of the inlier covariance,
+ * computed in closed form with an integer square root.
+ *
+ * @return false if the inliers do not define a direction.
+ */
+static bool fit_wall(uint16_t count, int64_t a, int64_t b, int64_t c, wall_line *wall) {
+    int64_t sum_x = 0, sum_y = 0;
+    uint16_t n = 0;
+
+    for (uint16_t i = 0; i < count; i++) {
+        if (!point_used[i] && near_line(a, b, c, point_x[i], point_y[i])) {
+            sum_x += point_x[i];
+            sum_y += point_y[i];
+            n++;
+        }
+    }
+    if (n < 2) {
+        return false;
+    }
+    int32_t cx = (int32_t)(sum_x / n);
+    int32_t cy = (int32_t)(sum_y / n);
+
+    int64_t sxx = 0, syy = 0, sxy = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        if (!point_used[i] && near_line(a, b, c, point_x[i], point_y[i])) {
+            int64_t ex = point_x[i] - cx;
+            int64_t ey = point_y[i] - cy;
+            sxx += ex * ex;
+            syy += ey * ey;
+            sxy += ex * ey;
+        }
+    }
+    // Covariance rather than scatter keeps the squares below 2^63
+    sxx /= n;
+    syy /= n;
+    sxy /= n;
+
+    int64_t diff = sxx - syy;
+    int64_t root = fx_isqrt64((uint64_t)(diff * diff + 4 * sxy * sxy));
+    int64_t lambda2 = sxx + syy + root;     // Twice the largest eigenvalue
+
+    // Two equivalent forms of the eigenvector; take the better conditioned one
+    int64_t vx1 = lambda2 - 2 * syy, vy1 = 2 * sxy;
+    int64_t vx2 = 2 * sxy, vy2 = lambda2 - 2 * sxx;
+    int64_t m1 = (vx1 < 0 ? -vx1 : vx1) + (vy1 < 0 ? -vy1 : vy1);
+    int64_t m2 = (vx2 < 0 ? -vx2 : vx2) + (vy2 < 0 ? -vy2 : vy2);
+    int64_t vx = (m1 >= m2) ? vx1 : vx2;
+    int64_t vy = (m1 >= m2) ? vy1 : vy2;
+    int64_t norm = fx_isqrt64((uint64_t)(vx * vx + vy * vy));
+    if (norm == 0) {
+        return false;
+    }
+
+    wall->cx = cx;
+    wall->cy = cy;
+    wall->dx = (int32_t)(vx * WALLS_DIR_ONE / norm);
+    wall->dy = (int32_t)(vy * WALLS_DIR_ONE / norm);
+    wall->order = pseudo_angle(cx, cy);
+    wall->inliers = n;
+    return true;
+}
+
+/**
+ * @brief Find the next dominant wall among the unused points.
+ *
+ * Hypotheses are drawn from unused point pairs that are close in sweep
+ * order, which are far more likely to lie on the same wall than uniform
+ * pairs, and which keeps short walls findable once the long ones are gone.
+ *
+ * @return true if a wall with enough support was found and claimed.
+ */
+static bool ransac_wall(uint16_t count, wall_line *wall) {
+    uint16_t best_inliers = 0;
+    int64_t best_a = 0, best_b = 0, best_c = 0;
+    uint16_t free_count = 0;
+
+    for (uint16_t i = 0; i < count; i++) {
+        if (!point_used[i]) {
+            free_index[free_count++] = i;
+        }
+    }
+    if (free_count < WALLS_MIN_INLIERS) {
+        return false;
+    }
+
+    for (int iteration = 0; iteration < WALLS_RANSAC_ITERATIONS; iteration++) {
+        uint16_t k = next_random() % free_count;
+        uint16_t i = free_index[k];
+        uint16_t j = free_index[(k + 2 + next_random() % WALLS_SAMPLE_SPAN) % free_count];
+        if (i == j) {
+            continue;
+        }
+
+        int64_t a, b, c;
+        line_from_direction(point_x[i], point_y[i], point_x[j] - point_x[i], point_y[j] - point_y[i], &a, &b, &c);
+        if (a == 0 && b == 0) {
+            continue;
+        }
+
+        uint16_t inliers = count_inliers(count, a, b, c);
+        if (inliers > best_inliers) {
+            best_inliers = inliers;
+            best_a = a;
+            best_b = b;
+            best_c = c;
+        }
+    }
+
+    if (best_inliers < WALLS_MIN_INLIERS || !fit_wall(count, best_a, best_b, best_c, wall)) {
+        return false;
+    }
+
+    // Claim the points of the refitted wall so later walls use the rest
+    int64_t a, b, c;
+    line_from_direction(wall->cx, wall->cy, wall->dx, wall->dy, &a, &b, &c);
+    for (uint16_t i = 0; i < count; i++) {
+        if (!point_used[i] && near_line(a, b, c, point_x[i], point_y[i])) {
+            point_used[i] = true;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Cross product of two wall directions.
+ */
+static int64_t direction_cross(const wall_line *w1, const wall_line *w2) {
+    return (int64_t)w1->dx * w2->dy - (int64_t)w1->dy * w2->dx;
+}
+
+/**
+ * @brief Intersect two walls.
+ *
+ * Solves c1 + t * d1 = c2 + s * d2 for t with cross products.
+ *
+ * @return false if the walls are near parallel or meet implausibly far away.
+ */
+static bool intersect_walls(const wall_line *w1, const wall_line *w2, int32_t *x, int32_t *y) {
+    int64_t denom = direction_cross(w1, w2);
+    if (denom < WALLS_PARALLEL_LIMIT && denom > -WALLS_PARALLEL_LIMIT) {
+        return false;
+    }
+
+    int64_t ex = w2->cx - w1->cx;
+    int64_t ey = w2->cy - w1->cy;
+    int64_t num = ex * w2->dy - ey * w2->dx;
+    int64_t px = w1->cx + num * w1->dx / denom;
+    int64_t py = w1->cy + num * w1->dy / denom;
+
+    if (px > WALLS_MAX_CORNER_CM || px < -WALLS_MAX_CORNER_CM ||
+        py > WALLS_MAX_CORNER_CM || py < -WALLS_MAX_CORNER_CM) {
+        return false;
+    }
+    *x = (int32_t)px;
+    *y = (int32_t)py;
+    return true;
+}
+
+/**
+ * @brief Sort walls around the device.
+ */
+static void order_walls(wall_room *room) {
+    // Insertion sort by pseudo-angle; at most WALLS_MAX entries
+    for (uint8_t i = 1; i < room->wall_count; i++) {
+        wall_line key = room->walls[i];
+        int j = i;
+        while (j > 0 && room->walls[j - 1].order > key.order) {
+            room->walls[j] = room->walls[j - 1];
+            j--;
+        }
+        room->walls[j] = key;
+    }
+}
+
+/**
+ * @brief Intersect consecutive walls into corners.
+ *
+ * Neighbours that do not meet in a plausible corner are merged by keeping
+ * the better supported one: a wall split by furniture shows up as two
+ * collinear lines, and a spurious short line meets its neighbours far
+ * outside the room. Either way both remaining neighbours then meet in a
+ * real corner. On success corner i is where walls[i] meets walls[i + 1],
+ * so there are exactly as many corners as walls.
+ *
+ * @return true if at least three walls are left.
+ */
+static bool corner_walls(wall_room *room) {
+    uint8_t i = 0;
+    while (room->wall_count >= 3 && i < room->wall_count) {
+        uint8_t next = (i + 1) % room->wall_count;
+        if (intersect_walls(&room->walls[i], &room->walls[next], &room->corner_x[i], &room->corner_y[i])) {
+            i++;
+            continue;
+        }
+        // Start over, since every corner past the dropped wall moves down
+        uint8_t drop = (room->walls[i].inliers >= room->walls[next].inliers) ? next : i;
+        memmove(&room->walls[drop], &room->walls[drop + 1],
+                (room->wall_count - drop - 1) * sizeof(wall_line));
+        room->wall_count--;
+        i = 0;
+    }
+    room->corner_count = (room->wall_count >= 3) ? room->wall_count : 0;
+    return room->corner_count >= 3;
+}
+
+/**
+ * @brief Check whether the polygon is a rectangle and record its sides.
+ *
+ * The angle at corner i is the one between walls[i] and walls[i + 1], the
+ * pair that produced it; side i runs from corner i to corner i + 1.
+ */
+static void classify_rectangle(wall_room *room, const uint32_t *side) {
+    room->is_rectangle = false;
+    if (room->wall_count != 4 || room->corner_count != 4) {
+        return;
+    }
+    for (uint8_t i = 0; i < 4; i++) {
+        const wall_line *w1 = &room->walls[i];
+        const wall_line *w2 = &room->walls[(i + 1) % 4];
+        int64_t dot = (int64_t)w1->dx * w2->dx + (int64_t)w1->dy * w2->dy;
+        if (dot > WALLS_SQUARE_LIMIT || dot < -WALLS_SQUARE_LIMIT) {
+            return;
+        }
+    }
+    room->is_rectangle = true;
+    room->width = (fx_length_t)((side[0] + side[2]) / 2);
+    room->length = (fx_length_t)((side[1] + side[3]) / 2);
+}
+
+/**
+ * @brief Extract walls from a sweep and intersect them into corners.
+ *
+ * @param scan The completed sweep.
+ * @param room Output room polygon.
+ * @return true if at least three corners were found.
+ */
+bool walls_extract(const sweep_scan *scan, wall_room *room) {
+    uint16_t count = scan->count;
+
+    memset(room, 0, sizeof(*room));
+    if (count < WALLS_MIN_INLIERS) {
+        return false;
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        int32_t x, y;
+        sweep_point_xy(sweep_point_at(scan, i), &x, &y);
+        point_x[i] = (x + (x >= 0 ? FX_SCALE / 2 : -FX_SCALE / 2)) / FX_SCALE;
+        point_y[i] = (y + (y >= 0 ? FX_SCALE / 2 : -FX_SCALE / 2)) / FX_SCALE;
+        point_used[i] = false;
+    }
+    rng_state = 0x5eed5eedu;
+
+    // Peel off the dominant walls one at a time
+    while (room->wall_count < WALLS_MAX && ransac_wall(count, &room->walls[room->wall_count])) {
+        room->wall_count++;
+    }
+    order_walls(room);
+    if (!corner_walls(room)) {
+        return false;
+    }
+
+    // Shoelace area and perimeter of the corner polygon
+    int64_t twice_area = 0;
+    int64_t perimeter = 0;
+    uint32_t side[WALLS_MAX];
+    for (uint8_t i = 0; i < room->corner_count; i++) {
+        uint8_t next = (i + 1) % room->corner_count;
+        int64_t x1 = room->corner_x[i], y1 = room->corner_y[i];
+        int64_t x2 = room->corner_x[next], y2 = room->corner_y[next];
+        twice_area += x1 * y2 - x2 * y1;
+        side[i] = fx_isqrt64((uint64_t)(((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1)) * FX_SCALE * FX_SCALE));
+        perimeter += side[i];
+    }
+    if (twice_area < 0) {
+        twice_area = -twice_area;
+    }
+    room->area = twice_area * (FX_SCALE / 2);
+    room->perimeter = (fx_length_t)perimeter;
+    classify_rectangle(room, side);
+    return true;
+}
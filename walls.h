@@ -0,0 +1,91 @@
+/*******************************************************************************
+ * Copyright (C) 2023 by Jithendra H S
+ *
+ * Redistribution, modification, or use of this software in source or binary
+ * forms is permitted as long as the files maintain this copyright. Users are
+ * permitted to modify this and use it to learn about the field of embedded
+ * software. Jithendra H S and the University of Colorado are not liable for
+ * any misuse of this material.
+ * ****************************************************************************/
+/**
+ * @file walls.h
+ * @brief RANSAC wall extraction from sweep points into room corners.
+ * @author Jithendra H S
+ * @date 2026-10-18
+ */
+#ifndef WALLS_H
+#define WALLS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fixed_point.h"
+#include "sweep.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Maximum number of walls (and therefore corners) extracted from one sweep
+#define WALLS_MAX (8)
+
+// RANSAC hypotheses tried per wall; bounds the run time
+#define WALLS_RANSAC_ITERATIONS (64)
+
+// Maximum point-to-line distance for an inlier
+#define WALLS_INLIER_TOLERANCE_CM (4)
+
+// Minimum number of inliers for a line to be accepted as a wall
+#define WALLS_MIN_INLIERS (10)
+
+// Maximum index distance between the two points of a RANSAC hypothesis
+#define WALLS_SAMPLE_SPAN (24)
+
+// Fixed-point one for wall direction vectors
+#define WALLS_DIR_ONE (4096)
+
+/**
+ * @brief A wall: its centroid and unit direction.
+ */
+typedef struct {
+    int32_t cx;         // Centroid X in centimeters
+    int32_t cy;         // Centroid Y in centimeters
+    int32_t dx;         // Direction X, WALLS_DIR_ONE is 1.0
+    int32_t dy;         // Direction Y, WALLS_DIR_ONE is 1.0
+    uint32_t order;     // Pseudo-angle of the centroid around the device
+    uint16_t inliers;   // Number of points supporting the wall
+} wall_line;
+
+/**
+ * @brief Room polygon built from the extracted walls.
+ */
+typedef struct {
+    wall_line walls[WALLS_MAX];
+    uint8_t wall_count;
+    int32_t corner_x[WALLS_MAX];    // Corner X in centimeters; corner i is on walls i and i + 1
+    int32_t corner_y[WALLS_MAX];    // Corner Y in centimeters
+    uint8_t corner_count;           // Equal to wall_count once extracted
+    fx_area_t area;                 // Area in hundredths of a square centimeter
+    fx_length_t perimeter;          // Perimeter in hundredths of a centimeter
+    bool is_rectangle;              // Four corners, all within 10 degrees of square
+    fx_length_t width;              // Mean of the first pair of opposite sides
+    fx_length_t length;             // Mean of the second pair of opposite sides
+} wall_room;
+
+/**
+ * @brief Extract walls from a sweep and intersect them into corners.
+ *
+ * Runs at most WALLS_MAX * WALLS_RANSAC_ITERATIONS hypotheses over the
+ * points in the sweep ring and uses only static storage, so both time and
+ * memory are bounded by the ring size.
+ *
+ * @param scan The completed sweep.
+ * @param room Output room polygon.
+ * @return true if at least three corners were found.
+ */
+bool walls_extract(const sweep_scan *scan, wall_room *room);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WALLS_H